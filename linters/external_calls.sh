@@ -33,6 +33,18 @@ ALLOWED_EXTERNAL_FUNCTIONS=(
 
 	# time for timestamp - not critical for webserv core functionality
 	time gmtime strftime
+
+	# zero-copy static file bodies: performance only, the same bytes could go through read + send
+	sendfile fstat
+
+	# uploads go to a temporary file and replace their target only once complete
+	rename
+
+	# CGI launch without copying the server's memory: performance only, fork + dup2 + execve did the same
+	posix_spawn sigemptyset sigaddset
+
+	# batch accept with the flags set in the same call: performance only, accept + fcntl did the same
+	accept4
 )
 
 allowed_regex="$(printf "%s\n" "${ALLOWED_EXTERNAL_FUNCTIONS[@]}" | paste -sd'|' -)"
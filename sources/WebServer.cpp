@@ -1,16 +1,27 @@
 #include "WebServer.hpp"
 
+#include <poll.h>
 #include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
+#include <cerrno>
 #include <csignal>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <set>
 #include <string>
 
 #include "configuration/AppConfig.hpp"
+#include "configuration/Endpoint.hpp"
 #include "configuration/parser/ConfigParser.hpp"
+#include "http_status/HttpStatus.hpp"
 #include "listener/MasterListener.hpp"
 #include "logger/Logger.hpp"
 #include "signals/ServerSignal.hpp"
 
+using std::strerror;
 using std::string;
 
 namespace webserver {
@@ -42,10 +53,22 @@ extern "C" void handleSigstp(int signum) {  // NOTE: Ctrl+Z
     WebServer::serverSignals |= SIG_SHUTDOWN;
 }
 
+extern "C" void handleSighup(int signum) {  // NOTE: kill -HUP, files have changed
+    (void)signum;
+    WebServer::serverSignals |= SIG_RELOAD;
+}
+
+extern "C" void handleSigchld(int signum) {  // NOTE: a worker is gone
+    (void)signum;  // NOTE: only here to cut the supervisor's sleep short
+}
+
 void WebServer::handleSignals() {
     signal(SIGINT, handleSigint);
     signal(SIGTERM, handleSigterm);
     signal(SIGTSTP, handleSigstp);
+    signal(SIGHUP, handleSighup);
+    // NOTE: a client gone mid-response must be an EPIPE we handle, sendfile() has no MSG_NOSIGNAL
+    signal(SIGPIPE, SIG_IGN);
 }
 
 AppConfig WebServer::getAppConfig() const {
@@ -55,7 +78,16 @@ AppConfig WebServer::getAppConfig() const {
 WebServer::WebServer(const std::string& configFilePath)
     : _appConfig(ConfigParser().parse(configFilePath))
     , _isRunning(0)
-    , _masterListener(_appConfig) {
+    , _masterListener(NULL) {
+    // NOTE: before any fork, so that the workers share the pages
+    const std::set<Endpoint*>& endpoints = _appConfig.getEndpoints();
+    for (std::set<Endpoint*>::const_iterator itr = endpoints.begin(); itr != endpoints.end();
+         itr++) {
+        (*itr)->renderStatusPages();
+    }
+    if (_appConfig.getWorkerProcesses() == 1) {
+        _masterListener = new MasterListener(_appConfig);
+    }
     handleSignals();
 }
 
@@ -65,12 +97,136 @@ WebServer& WebServer::getInstance(const string& configFilePath) {
 }
 
 WebServer::~WebServer() {
+    delete _masterListener;
 }
 
-void WebServer::start() {
+int WebServer::start() {
     _isRunning = 1;
     _log.stream(LOG_INFO) << "Webserver starting\n";
-    _masterListener.listenAndHandle(_isRunning, serverSignals);
+    if (_masterListener != NULL) {
+        serve();
+        return (0);
+    }
+    return (superviseWorkers());
+}
+
+void WebServer::serve() {
+    _masterListener->listenAndHandle(_isRunning, serverSignals);
+    _log.stream(LOG_INFO) << "Webserver stopped\n";
+}
+
+pid_t WebServer::startWorker(size_t slot) {
+    // NOTE: whatever is still buffered would be printed twice, once by each process
+    std::cout.flush();
+    std::clog.flush();
+    const pid_t pid = fork();
+    if (pid == -1) {
+        // NOTE: the slot stays vacant and is tried again on the next round
+        _log.stream(LOG_ERROR) << "fork() failed for worker " << slot << ": " << strerror(errno)
+                               << "\n";
+    } else if (pid > 0) {
+        _workers[slot] = pid;
+        _log.stream(LOG_INFO) << "Worker " << slot << " started with pid " << pid << "\n";
+    }
+    return (pid);
+}
+
+int WebServer::runWorker() {
+    // NOTE: the supervisor's bookkeeping means nothing here, a worker never forks workers
+    _workers.clear();
+    signal(SIGCHLD, SIG_DFL);
+    try {
+        _masterListener = new MasterListener(_appConfig);
+    } catch (const std::exception& e) {
+        _log.stream(LOG_FATAL) << "Worker failed to start: " << e.what() << "\n";
+        return (WORKER_STARTUP_FAILED);
+    }
+    serve();
+    return (0);
+}
+
+/* NOTE: a worker that exits with 0 has been stopped by a SHUTDOWN request,
+* which is meant for the whole server, so the others are asked to stop too.
+* one that crashed or was killed gets replaced, unless the server is stopping anyway.
+* returns true if the server has to stop.
+*/
+bool WebServer::reapWorkers(bool& isStartupFailed) {
+    bool isStopRequested = false;
+    int status = 0;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        size_t slot = 0;
+        while (slot < _workers.size() && _workers[slot] != pid) {
+            slot++;
+        }
+        if (slot == _workers.size()) {
+            continue;
+        }
+        _workers[slot] = -1;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            _log.stream(LOG_INFO) << "Worker " << slot << " stopped\n";
+            isStopRequested = true;
+        } else if (WIFEXITED(status) && WEXITSTATUS(status) == WORKER_STARTUP_FAILED) {
+            _log.stream(LOG_FATAL) << "Worker " << slot << " could not start\n";
+            isStartupFailed = true;
+            isStopRequested = true;
+        } else if (WIFEXITED(status)) {
+            _log.stream(LOG_ERROR)
+                << "Worker " << slot << " exited with code " << WEXITSTATUS(status) << "\n";
+        } else if (WIFSIGNALED(status)) {
+            _log.stream(LOG_ERROR)
+                << "Worker " << slot << " killed by signal " << WTERMSIG(status) << "\n";
+        }
+    }
+    return (isStopRequested);
+}
+
+void WebServer::signalWorkers(int signum) {
+    for (size_t slot = 0; slot < _workers.size(); slot++) {
+        if (_workers[slot] > 0) {
+            kill(_workers[slot], signum);
+        }
+    }
+}
+
+size_t WebServer::countLiveWorkers() const {
+    size_t res = 0;
+    for (size_t slot = 0; slot < _workers.size(); slot++) {
+        if (_workers[slot] > 0) {
+            res++;
+        }
+    }
+    return (res);
+}
+
+int WebServer::superviseWorkers() {
+    bool isStopping = false;
+    bool isStartupFailed = false;
+    _workers.assign(_appConfig.getWorkerProcesses(), -1);
+    signal(SIGCHLD, handleSigchld);
+    while (!isStopping || countLiveWorkers() > 0) {
+        for (size_t slot = 0; slot < _workers.size() && !isStopping; slot++) {
+            if (_workers[slot] == -1 && startWorker(slot) == 0) {
+                return (runWorker());
+            }
+        }
+        // NOTE: poll() with no descriptors is a sleep that a signal cuts short
+        poll(NULL, 0, WORKER_SUPERVISION_INTERVAL_MS);
+        if ((serverSignals & SIG_RELOAD) != 0) {
+            serverSignals &= ~SIG_RELOAD;
+            // NOTE: workers forked later start from the fresh pages
+            HttpStatus::reloadRenderedPages();
+            signalWorkers(SIGHUP);
+        }
+        const bool isStopRequested = reapWorkers(isStartupFailed);
+        if (!isStopping && (isStopRequested || (serverSignals & SIG_SHUTDOWN) != 0)) {
+            _log.stream(LOG_INFO) << "Stopping " << countLiveWorkers() << " workers\n";
+            // NOTE: SIGTERM makes a worker finish the connections it has, like SIGINT does here
+            signalWorkers(SIGTERM);
+            isStopping = true;
+        }
+    }
     _log.stream(LOG_INFO) << "Webserver stopped\n";
+    return (isStartupFailed ? 1 : 0);
 }
 }  // namespace webserver
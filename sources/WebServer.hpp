@@ -1,7 +1,10 @@
 #ifndef WEBSERVER_HPP
 #define WEBSERVER_HPP
 
+#include <sys/types.h>
+
 #include <string>
+#include <vector>
 
 #include "configuration/AppConfig.hpp"
 #include "listener/MasterListener.hpp"
@@ -10,12 +13,24 @@
 namespace webserver {
 class WebServer {
 private:
+    // NOTE: a worker that could not even open its sockets, restarting it will not help
+    static const int WORKER_STARTUP_FAILED = 2;
+    // NOTE: upper bound on how late the master notices a dead worker
+    static const int WORKER_SUPERVISION_INTERVAL_MS = 1000;
+
     AppConfig _appConfig;
     // NOTE: DL: __sig_atomic_t is a special int type guaranteed to be writable in one atomic CPU operation & safe to modify inside a signal handler
     // NOTE: DL: volatile tells the compiler: “Don’t optimize access to this variable. Always read/write it directly from memory.”
     volatile __sig_atomic_t _isRunning;
 
-    MasterListener _masterListener;
+    /* NOTE: with worker_processes 1 the only process serves connections itself,
+    * and the sockets are opened at startup, so that bind() errors are reported right away.
+    * otherwise this process only supervises the workers: they are forked from it,
+    * and each of them opens its own listening sockets with SO_REUSEPORT,
+    * so accepts are spread among them by the kernel, with no lock and no thundering herd.
+    */
+    MasterListener* _masterListener;
+    std::vector<pid_t> _workers;  // NOTE: worker slot: pid, -1 while the slot is vacant
     static Logger _log;
 
     WebServer();
@@ -26,6 +41,14 @@ private:
 
     static void handleSignals();
 
+    void serve();
+    pid_t startWorker(size_t slot);
+    int runWorker();
+    bool reapWorkers(bool& isStartupFailed);
+    void signalWorkers(int signum);
+    size_t countLiveWorkers() const;
+    int superviseWorkers();
+
 public:
     /* NOTE: Flag used for communication with signal handlers.
     * sig_atomic_t guarantees that reads/writes are not interrupted,
@@ -45,7 +68,8 @@ public:
 
     AppConfig getAppConfig() const;
 
-    void start();
+    // NOTE: returns the process exit status, a worker process returns from here too
+    int start();
     void stop();
 };
 }  // namespace webserver
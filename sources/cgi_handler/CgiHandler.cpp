@@ -63,9 +63,8 @@ void CgiHandler::setupEnvironment() {
         }
         const string transferEncoding = _request.getHeader("Transfer-Encoding");
         if (transferEncoding == "chunked") {
-            const string body = getRequestBody();
             std::ostringstream lengthStream;
-            lengthStream << body.length();
+            lengthStream << getRequestBody().length();
             addEnvVar("CONTENT_LENGTH", lengthStream.str());
         } else {
             const string contentLength = _request.getHeader("Content-Length");
@@ -96,33 +95,9 @@ void CgiHandler::addEnvVar(const string& key, const string& value) {
     _env[key] = value;
 }
 
-char** CgiHandler::getEnvArray() const {
-    char** env = new char*[_env.size() + 1];
-    size_t index = 0;
-
-    for (std::map<string, string>::const_iterator it = _env.begin(); it != _env.end(); ++it) {
-        string envStr = it->first + "=" + it->second;
-        env[index] = new char[envStr.length() + 1];
-        for (size_t j = 0; j < envStr.length(); ++j) {
-            env[index][j] = envStr[j];
-        }
-        env[index][envStr.length()] = '\0';
-        ++index;
-    }
-    env[index] = NULL;
-    return (env);
-}
-
-void CgiHandler::freeEnvArray(char** env) {
-    for (size_t i = 0; env[i] != NULL; ++i) {
-        delete[] env[i];
-    }
-    delete[] env;
-}
-
-char** CgiHandler::prepareEnvironment() {
+std::map<string, string> CgiHandler::prepareParameters() {
     setupEnvironment();
-    return (getEnvArray());
+    return (_env);
 }
 
 std::string CgiHandler::getExecutablePath() const {
@@ -133,7 +108,7 @@ std::string CgiHandler::getScriptPath() const {
     return (_scriptPath);
 }
 
-std::string CgiHandler::getRequestBody() {
+const std::string& CgiHandler::getRequestBody() {
     return (const_cast<Request&>(_request).getBody());
 }
 }  // namespace webserver
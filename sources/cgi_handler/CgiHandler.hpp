@@ -1,6 +1,9 @@
 #ifndef CGIHANDLER_HPP
 #define CGIHANDLER_HPP
 
+#include <map>
+#include <string>
+
 #include "configuration/CgiHandlerConfig.hpp"
 #include "configuration/RouteConfig.hpp"
 #include "request/Request.hpp"
@@ -23,8 +26,6 @@ private:
 
     void setupEnvironment();
     void addEnvVar(const std::string& key, const std::string& value);
-    char** getEnvArray() const;
-    static void freeEnvArray(char** env);
 
     std::string getMethod();
 
@@ -38,10 +39,11 @@ public:
     );
     ~CgiHandler();
 
-    char** prepareEnvironment();
+    // NOTE: the script environment as name: value pairs, for a spawned script or a FastCGI app
+    std::map<std::string, std::string> prepareParameters();
     std::string getExecutablePath() const;
     std::string getScriptPath() const;
-    std::string getRequestBody();
+    const std::string& getRequestBody();
     std::string resolveIndexPath();
 };
 }  // namespace webserver
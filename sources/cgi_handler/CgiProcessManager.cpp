@@ -2,20 +2,20 @@
 
 #include <fcntl.h>
 #include <signal.h>
+#include <spawn.h>
 #include <string.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <cstddef>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 
 #include "configuration/Endpoint.hpp"
-#include "connection/Connection.hpp"
 #include "http_status/HttpStatus.hpp"
-#include "listener/Listener.hpp"
 #include "logger/Logger.hpp"
 #include "response/Response.hpp"
 
@@ -25,56 +25,6 @@ using std::runtime_error;
 using std::string;
 using std::vector;
 
-namespace {
-void resetSignalsForChild() {
-    signal(SIGINT, SIG_DFL);
-    signal(SIGTERM, SIG_DFL);
-    signal(SIGQUIT, SIG_DFL);
-}
-
-void closeFdOrLog(int fileDescriptor, webserver::Logger& log, const char* msg) {
-    if (close(fileDescriptor) == -1) {
-        log.stream(LOG_ERROR) << msg << '\n';
-    }
-}
-
-void execFalseAndLoop() {
-    char* argv[] = {const_cast<char*>("/usr/bin/false"), NULL};
-    char* envp[] = {NULL};
-
-    execve("/usr/bin/false", argv, envp);
-    while (true) {
-    }
-}
-
-void dupOrFail(
-    int fromFd,
-    int toFd,
-    int controlPipeWriteFd,
-    int cgiOutputFd,
-    webserver::Logger& log,
-    const char* logMsg
-) {
-    if (dup2(fromFd, toFd) == -1) {
-        log.stream(LOG_ERROR) << logMsg << '\n';
-
-        webserver::Connection::State errorState = webserver::Connection::WRITING_COMPLETE;
-        write(controlPipeWriteFd, &errorState, sizeof(errorState));
-
-        if (cgiOutputFd != -1) {
-            const char* errorMsg =
-                "Status: 500\r\n"
-                "Content-Type: text/html\r\n"
-                "\r\n"
-                "Failed to redirect IO for CGI\r\n";
-            write(cgiOutputFd, errorMsg, strlen(errorMsg));
-        }
-
-        execFalseAndLoop();
-    }
-}
-}  // namespace
-
 namespace webserver {
 
 Logger CgiProcessManager::_log;
@@ -83,14 +33,29 @@ CgiProcessManager::CgiProcessManager() {
 }
 
 CgiProcessManager::~CgiProcessManager() {
+    for (map<int, Input>::iterator itr = _inputs.begin(); itr != _inputs.end(); ++itr) {
+        close(itr->first);
+    }
 }
 
-CgiProcessManager::CgiPipes CgiProcessManager::createPipes() {
-    CgiPipes pipes;
-    if (pipe(pipes.toProcess) == -1 || pipe(pipes.fromProcess) == -1 || pipe(pipes.control) == -1) {
-        throw runtime_error("pipe() failed for CGI");
+// NOTE: false when out of descriptors, with whatever was opened closed again
+bool CgiProcessManager::createPipes(CgiPipes& pipes) {
+    if (pipe(pipes.toProcess) == -1) {
+        return (false);
+    }
+    if (pipe(pipes.fromProcess) == -1) {
+        close(pipes.toProcess[0]);
+        close(pipes.toProcess[1]);
+        return (false);
     }
-    return (pipes);
+    if (pipe(pipes.control) == -1) {
+        close(pipes.toProcess[0]);
+        close(pipes.toProcess[1]);
+        close(pipes.fromProcess[0]);
+        close(pipes.fromProcess[1]);
+        return (false);
+    }
+    return (true);
 }
 
 void CgiProcessManager::closePipes(const CgiPipes& pipes) {
@@ -105,8 +70,16 @@ void CgiProcessManager::closePipes(const CgiPipes& pipes) {
 void CgiProcessManager::setNonBlocking(int fileDescriptor) {
     const int flags = fcntl(fileDescriptor, F_GETFL, 0);
     fcntl(fileDescriptor, F_SETFL, flags | O_NONBLOCK);
+    /* NOTE: our ends outlive this spawn: a stdin pipe stays open while the body is written.
+    * a CGI started meanwhile must not inherit it, or the first script never sees EOF
+    */
+    fcntl(fileDescriptor, F_SETFD, FD_CLOEXEC);
 }
 
+/* NOTE: before the spawn: every end the script isn't meant to keep is closed on its exec.
+* its stdin and stdout ends too, dup2() onto 0 and 1 drops the flag on the copies.
+* the control pipe's writing end stays open in the script, its exit closes it
+*/
 void CgiProcessManager::setupParentPipes(const CgiPipes& pipes) {
     const int READING_PIPE_END = 0;
     const int WRITING_PIPE_END = 1;
@@ -114,6 +87,13 @@ void CgiProcessManager::setupParentPipes(const CgiPipes& pipes) {
     setNonBlocking(pipes.toProcess[WRITING_PIPE_END]);
     setNonBlocking(pipes.fromProcess[READING_PIPE_END]);
     setNonBlocking(pipes.control[READING_PIPE_END]);
+    fcntl(pipes.toProcess[READING_PIPE_END], F_SETFD, FD_CLOEXEC);
+    fcntl(pipes.fromProcess[WRITING_PIPE_END], F_SETFD, FD_CLOEXEC);
+}
+
+void CgiProcessManager::closeChildPipeEnds(const CgiPipes& pipes) {
+    const int READING_PIPE_END = 0;
+    const int WRITING_PIPE_END = 1;
 
     if (close(pipes.toProcess[READING_PIPE_END]) == -1 ||
         close(pipes.fromProcess[WRITING_PIPE_END]) == -1 ||
@@ -122,127 +102,92 @@ void CgiProcessManager::setupParentPipes(const CgiPipes& pipes) {
     }
 }
 
-void CgiProcessManager::writeRequestBodyToPipe(int pipeFd, const string& requestBody) {
-    if (requestBody.empty()) {
-        return;
-    }
-
-    size_t totalWritten = 0;
-    while (totalWritten < requestBody.size()) {
-        const ssize_t written =
-            write(pipeFd, requestBody.data() + totalWritten, requestBody.size() - totalWritten);
-        if (written == -1) {
-            break;
-        }
-        totalWritten += written;
-    }
-}
-
-void CgiProcessManager::runCgiChild(
-    Listener* listener,
-    int clientFd,
-    int pipeToProcess[2],
-    int pipeFromProcess[2],
-    int controlPipe[2]
+/* NOTE: argv and the environment are built here, in the server, and posix_spawn() starts
+* the interpreter without copying the server's memory first: the cost of a spawn doesn't grow
+* with the number of connections and cached files. the pipes are put in place by file actions,
+* the server's signal handlers are gone with the exec anyway, SIGPIPE is set back from ignored.
+*/
+pid_t CgiProcessManager::spawnScript(
+    const string& interpreterPath,
+    const map<string, string>& params,
+    const CgiPipes& pipes
 ) {
-    resetSignalsForChild();
-
     const int READING_PIPE_END = 0;
     const int WRITING_PIPE_END = 1;
 
-    closeFdOrLog(
-        pipeToProcess[WRITING_PIPE_END],
-        _log,
-        "close() failed on child's writing pipeToProcess end"
-    );
-    closeFdOrLog(
-        pipeFromProcess[READING_PIPE_END],
-        _log,
-        "close() failed on child's reading pipeFromProcess end"
-    );
-    closeFdOrLog(
-        controlPipe[READING_PIPE_END],
-        _log,
-        "close() failed on child's reading control pipe end"
-    );
-
-    dupOrFail(
-        pipeToProcess[READING_PIPE_END],
-        STDIN_FILENO,
-        controlPipe[WRITING_PIPE_END],
-        pipeFromProcess[WRITING_PIPE_END],
-        _log,
-        "dup2() failed for stdin in CGI child"
-    );
-
-    closeFdOrLog(
-        pipeToProcess[READING_PIPE_END],
-        _log,
-        "close() failed on child's pipeToProcess reading end"
-    );
-
-    dupOrFail(
-        pipeFromProcess[WRITING_PIPE_END],
-        STDOUT_FILENO,
-        controlPipe[WRITING_PIPE_END],
-        -1,
-        _log,
-        "dup2() failed for stdout in CGI child"
-    );
-
-    closeFdOrLog(
-        pipeFromProcess[WRITING_PIPE_END],
-        _log,
-        "close() failed on child's pipeFromProcess writing end"
-    );
-
-    Connection::State connState = listener->executeCgi(clientFd);
-
-    if (write(controlPipe[WRITING_PIPE_END], &connState, sizeof(connState)) == -1) {
-        _log.stream(LOG_ERROR) << "Failed to write to control pipe in CGI child\n";
+    string scriptPath;
+    const map<string, string>::const_iterator found = params.find("SCRIPT_FILENAME");
+    if (found != params.end()) {
+        scriptPath = found->second;
     }
-    if (close(controlPipe[WRITING_PIPE_END]) == -1) {
-        _log.stream(LOG_ERROR) << "close() failed on child's control pipe writing end\n";
+    vector<string> entries;
+    for (map<string, string>::const_iterator itr = params.begin(); itr != params.end(); ++itr) {
+        entries.push_back(itr->first + "=" + itr->second);
     }
-
-    close(STDOUT_FILENO);
-    close(STDIN_FILENO);
-
-    execFalseAndLoop();
+    vector<char*> envp;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        envp.push_back(const_cast<char*>(entries[i].c_str()));
+    }
+    envp.push_back(NULL);
+    char* argv[] = {
+        const_cast<char*>(interpreterPath.c_str()),
+        const_cast<char*>(scriptPath.c_str()),
+        // clang-format off
+        NULL};
+    // clang-format on
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipes.toProcess[READING_PIPE_END], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipes.fromProcess[WRITING_PIPE_END], STDOUT_FILENO);
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+    posix_spawnattr_setflags(&attributes, static_cast<short>(POSIX_SPAWN_SETSIGDEF));
+
+    pid_t pid = -1;
+    const int res =
+        posix_spawn(&pid, interpreterPath.c_str(), &actions, &attributes, argv, &envp[0]);
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+    if (res != 0) {
+        _log.stream(LOG_ERROR) << "posix_spawn() failed for CGI script " << scriptPath << ": "
+                               << strerror(res) << "\n";
+        return (-1);
+    }
+    return (pid);
 }
 
 pid_t CgiProcessManager::startCgiProcess(
-    Listener* listener,
-    int clientFd,
-    const string& requestBody,
+    const string& interpreterPath,
+    const map<string, string>& params,
     int& controlPipeReadEnd,
-    int& responsePipeReadEnd
+    int& responsePipeReadEnd,
+    int& requestPipeWriteEnd
 ) {
     const int READING_PIPE_END = 0;
     const int WRITING_PIPE_END = 1;
 
-    CgiPipes pipes = createPipes();
-
-    const pid_t pid = fork();
-    if (pid == -1) {
-        closePipes(pipes);
-        throw runtime_error("fork() failed for CGI");
-    }
-
-    if (pid == 0) {
-        runCgiChild(listener, clientFd, pipes.toProcess, pipes.fromProcess, pipes.control);
-        return (pid);
+    CgiPipes pipes;
+    if (!createPipes(pipes)) {
+        _log.stream(LOG_ERROR) << "pipe() failed for CGI\n";
+        return (-1);
     }
-
     setupParentPipes(pipes);
-    writeRequestBodyToPipe(pipes.toProcess[WRITING_PIPE_END], requestBody);
 
-    if (close(pipes.toProcess[WRITING_PIPE_END]) == -1) {
-        _log.stream(LOG_ERROR) << "close() failed on parent's pipeToProcess writing end\n";
+    const pid_t pid = spawnScript(interpreterPath, params, pipes);
+    if (pid == -1) {
+        closePipes(pipes);
+        return (-1);
     }
+    closeChildPipeEnds(pipes);
 
     controlPipeReadEnd = pipes.control[READING_PIPE_END];
     responsePipeReadEnd = pipes.fromProcess[READING_PIPE_END];
+    requestPipeWriteEnd = pipes.toProcess[WRITING_PIPE_END];
 
     return (pid);
 }
@@ -282,43 +227,29 @@ void CgiProcessManager::parseCgiResponseLoop(
             statusStream >> statusCode;
         } else if (key == "Content-Type" || key == "Content-type") {
             contentType = value;
+        } else if (key == "Content-Length" || key == "Content-length") {
+            customHeaders["Content-Length"] = value;
         } else {
             customHeaders[key] = value;
         }
     }
 }
 
-string CgiProcessManager::parseCgiResponse(const string& cgiOutput, const Endpoint& configuration) {
-    if (cgiOutput.empty()) {
-        _log.stream(LOG_ERROR) << "CGI script produced no output\n";
-        return (configuration.getStatusCatalogue()
-                    .serveStatusPage(HttpStatus::INTERNAL_SERVER_ERROR)
-                    .serialize());
-    }
-
-    const string::size_type headerEnd = cgiOutput.find("\r\n\r\n");
-    if (headerEnd == string::npos) {
-        _log.stream(LOG_ERROR) << "CGI script produced invalid output (no proper headers)\n";
-        return (configuration.getStatusCatalogue()
-                    .serveStatusPage(HttpStatus::INTERNAL_SERVER_ERROR)
-                    .serialize());
-    }
-
-    const string headers = cgiOutput.substr(0, headerEnd);
-    const string body = cgiOutput.substr(headerEnd + 4);
-
+Response CgiProcessManager::parseCgiHead(const string& head, const Endpoint& configuration) {
     int statusCode = HttpStatus::OK;
     string contentType = "text/html";
     map<string, string> customHeaders;
 
-    parseCgiResponseLoop(headers, statusCode, contentType, customHeaders);
+    parseCgiResponseLoop(head, statusCode, contentType, customHeaders);
 
     Response response(
         statusCode,
         configuration.getStatusCatalogue().getReasonPhrase(statusCode),
-        body,
+        "",
         contentType
     );
+    // NOTE: the body is yet to come, its length is known only if the script declared it
+    response.removeHeader("Content-Length");
 
     for (map<string, string>::const_iterator iter = customHeaders.begin();
          iter != customHeaders.end();
@@ -326,7 +257,14 @@ string CgiProcessManager::parseCgiResponse(const string& cgiOutput, const Endpoi
         response.setHeader(iter->first, iter->second);
     }
 
-    return (response.serialize());
+    return (response);
+}
+
+void CgiProcessManager::touchWorker(int clientFd) {
+    const map<int, time_t>::iterator iter = _cgiStartTimes.find(clientFd);
+    if (iter != _cgiStartTimes.end()) {
+        iter->second = time(NULL);
+    }
 }
 
 void CgiProcessManager::registerWorker(int clientFd, pid_t pid) {
@@ -359,6 +297,61 @@ pid_t CgiProcessManager::getProcessId(int clientFd) const {
     return (iter->second);
 }
 
+void CgiProcessManager::registerInput(int pipeFd, int clientFd, const string& body) {
+    Input input;
+    input.clientFd = clientFd;
+    input.body = &body;
+    input.written = 0;
+    _inputs[pipeFd] = input;
+}
+
+bool CgiProcessManager::isInput(int pipeFd) const {
+    return (_inputs.find(pipeFd) != _inputs.end());
+}
+
+bool CgiProcessManager::writeInput(int pipeFd) {
+    const map<int, Input>::iterator found = _inputs.find(pipeFd);
+    if (found == _inputs.end()) {
+        return (true);
+    }
+    Input& input = found->second;
+    const string& body = *input.body;
+    while (input.written < body.size()) {
+        const ssize_t written =
+            write(pipeFd, body.data() + input.written, body.size() - input.written);
+        if (written == -1) {
+            // NOTE: EAGAIN: the pipe is full, the script reads slower than the body arrives
+            // NOTE: anything else, EPIPE mostly: the script exited without reading it all
+            return (errno != EAGAIN);
+        }
+        input.written += written;
+    }
+    return (true);
+}
+
+void CgiProcessManager::dropInput(int pipeFd) {
+    const map<int, Input>::iterator found = _inputs.find(pipeFd);
+    if (found == _inputs.end()) {
+        return;
+    }
+    if (found->second.written < found->second.body->size()) {
+        _log.stream(LOG_DEBUG) << "CGI for client " << found->second.clientFd << " got "
+                               << found->second.written << " of " << found->second.body->size()
+                               << " request body bytes\n";
+    }
+    close(pipeFd);
+    _inputs.erase(found);
+}
+
+int CgiProcessManager::findInput(int clientFd) const {
+    for (map<int, Input>::const_iterator itr = _inputs.begin(); itr != _inputs.end(); ++itr) {
+        if (itr->second.clientFd == clientFd) {
+            return (itr->first);
+        }
+    }
+    return (-1);
+}
+
 vector<int> CgiProcessManager::checkTimeouts() {
     const time_t now = time(NULL);
     vector<int> timedOutFds;
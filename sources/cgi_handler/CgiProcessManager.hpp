@@ -10,8 +10,8 @@
 #include <vector>
 
 #include "configuration/Endpoint.hpp"
-#include "listener/Listener.hpp"
 #include "logger/Logger.hpp"
+#include "response/Response.hpp"
 
 namespace webserver {
 class CgiProcessManager {
@@ -27,43 +27,64 @@ public:
     CgiProcessManager();
     ~CgiProcessManager();
 
+    /* NOTE: the request body is not written here, see registerInput().
+    * -1 if the script couldn't be started, the pipes are closed then
+    */
     static pid_t startCgiProcess(
-        Listener* listener,
-        int clientFd,
-        const std::string& requestBody,
+        const std::string& interpreterPath,
+        const std::map<std::string, std::string>& params,
         int& controlPipeReadEnd,
-        int& responsePipeReadEnd
+        int& responsePipeReadEnd,
+        int& requestPipeWriteEnd
     );
     static std::string emptyOutput();
     static std::string noHeaders();
-    static std::string
-    parseCgiResponse(const std::string& cgiOutput, const Endpoint& configuration);
+    // NOTE: status line and headers from the script's header block, the body is streamed after
+    static Response parseCgiHead(const std::string& head, const Endpoint& configuration);
     std::vector<int> checkTimeouts();
     void registerWorker(int clientFd, pid_t pid);
+    void touchWorker(int clientFd);  // NOTE: the timeout counts from the script's last output
     bool isWorker(int clientFd) const;
     void unregisterWorker(int clientFd);
     void cleanupProcess(int clientFd);
     pid_t getProcessId(int clientFd) const;
 
+    /* NOTE: the request body goes to the script's stdin as the pipe accepts it,
+    * a write per POLLOUT, so a body bigger than the pipe buffer never blocks the server.
+    * writeInput() returns true once the pipe is done with: all written, or the script is gone.
+    * the caller then closes it with dropInput(), which is what gives the script its EOF.
+    * the body is not copied: it has to stay in place until the input is dropped,
+    * at the latest together with the script's worker.
+    */
+    void registerInput(int pipeFd, int clientFd, const std::string& body);
+    bool isInput(int pipeFd) const;
+    bool writeInput(int pipeFd);
+    void dropInput(int pipeFd);
+    int findInput(int clientFd) const;  // NOTE: -1 if that client's body is all written
+
 private:
+    struct Input {
+        int clientFd;
+        const std::string* body;  // NOTE: the client's request body, not owned
+        size_t written;           // NOTE: cursor into body
+    };
+
     static Logger _log;
+    std::map<int, Input> _inputs;  // NOTE: stdin pipe writing end: body still being written
     std::set<int> _cgiWorkers;
     std::map<int, pid_t> _cgiProcesses;
     std::map<int, time_t> _cgiStartTimes;
     std::map<int, int> _cgiTimeouts;
 
-    static CgiPipes createPipes();
+    static bool createPipes(CgiPipes& pipes);
     static void closePipes(const CgiPipes& pipes);
     static void setNonBlocking(int fileDescriptor);
     static void setupParentPipes(const CgiPipes& pipes);
-    static void writeRequestBodyToPipe(int pipeFd, const std::string& requestBody);
-
-    static void runCgiChild(
-        Listener* listener,
-        int clientFd,
-        int pipeToProcess[2],
-        int pipeFromProcess[2],
-        int controlPipe[2]
+    static void closeChildPipeEnds(const CgiPipes& pipes);
+    static pid_t spawnScript(
+        const std::string& interpreterPath,
+        const std::map<std::string, std::string>& params,
+        const CgiPipes& pipes
     );
 
     static void parseCgiResponseLoop(
@@ -0,0 +1,344 @@
+#include "CgiWorker.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cgi_handler/FastCgiRecord.hpp"
+#include "logger/Logger.hpp"
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+const int READING_PIPE_END = 0;
+const int WRITING_PIPE_END = 1;
+
+void execFalseAndLoop() {
+    char* argv[] = {const_cast<char*>("/usr/bin/false"), NULL};
+    char* envp[] = {NULL};
+
+    execve("/usr/bin/false", argv, envp);
+    while (true) {
+    }
+}
+
+// NOTE: in the forked child, never returns
+void execScript(
+    const string& interpreterPath,
+    const map<string, string>& params,
+    int toScript[2],
+    int fromScript[2]
+) {
+    if (dup2(toScript[READING_PIPE_END], STDIN_FILENO) == -1 ||
+        dup2(fromScript[WRITING_PIPE_END], STDOUT_FILENO) == -1) {
+        execFalseAndLoop();
+    }
+    close(toScript[READING_PIPE_END]);
+    close(toScript[WRITING_PIPE_END]);
+    close(fromScript[READING_PIPE_END]);
+    close(fromScript[WRITING_PIPE_END]);
+
+    string scriptPath;
+    const map<string, string>::const_iterator found = params.find("SCRIPT_FILENAME");
+    if (found != params.end()) {
+        scriptPath = found->second;
+    }
+    vector<string> entries;
+    for (map<string, string>::const_iterator itr = params.begin(); itr != params.end(); ++itr) {
+        entries.push_back(itr->first + "=" + itr->second);
+    }
+    vector<char*> envp;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        envp.push_back(const_cast<char*>(entries[i].c_str()));
+    }
+    envp.push_back(NULL);
+    char* argv[] = {
+        const_cast<char*>(interpreterPath.c_str()),
+        const_cast<char*>(scriptPath.c_str()),
+        // clang-format off
+        NULL};
+    // clang-format on
+
+    execve(interpreterPath.c_str(), argv, &envp[0]);
+
+    const char* errorMsg =
+        "Status: 500\r\nContent-Type: text/html\r\n\r\nFailed to execute CGI script\r\n";
+    write(STDOUT_FILENO, errorMsg, strlen(errorMsg));
+    execFalseAndLoop();
+}
+}  // namespace
+
+namespace webserver {
+const char* const CgiWorker::FLAG = "--cgi-worker";
+
+Logger CgiWorker::_log;
+
+CgiWorker::CgiWorker(const string& interpreterPath)
+    : _interpreterPath(interpreterPath)
+    , _requestId(0)
+    , _isParamsComplete(false)
+    , _isStdinComplete(false)
+    , _isAborted(false) {
+}
+
+CgiWorker::~CgiWorker() {
+}
+
+int CgiWorker::run() {
+    // NOTE: a server gone mid-write is an EPIPE to notice, not a signal to die of
+    signal(SIGPIPE, SIG_IGN);
+    while (readRequest()) {
+        int scriptIn = -1;
+        int scriptOut = -1;
+        const pid_t pid = startScript(scriptIn, scriptOut);
+        if (pid == -1) {
+            const string failure =
+                FastCgiRecord::encodeStream(
+                    FastCgiRecord::STDOUT,
+                    _requestId,
+                    "Status: 500\r\nContent-Type: text/html\r\n\r\nFailed to start CGI script\r\n"
+                ) +
+                FastCgiRecord::encodeEndRequest(_requestId, 1);
+            if (!send(failure)) {
+                return (0);
+            }
+            continue;
+        }
+        int status = 0;
+        if (!relay(pid, scriptIn, scriptOut) || !waitScript(pid, status)) {
+            return (0);
+        }
+        const int appStatus = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+        if (!send(
+                FastCgiRecord::encodeStream(FastCgiRecord::STDOUT, _requestId, "") +
+                FastCgiRecord::encodeEndRequest(_requestId, appStatus)
+            )) {
+            return (0);
+        }
+    }
+    return (0);
+}
+
+bool CgiWorker::receive() {
+    char buffer[READ_BUFFER_SIZE];
+    const ssize_t bytesRead = read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (bytesRead <= 0) {
+        return (false);
+    }
+    _received.append(buffer, bytesRead);
+    return (true);
+}
+
+void CgiWorker::takeRecords() {
+    size_t pos = 0;
+    FastCgiRecord record;
+    while (FastCgiRecord::decode(_received, pos, record)) {
+        if (record.getType() == FastCgiRecord::BEGIN_REQUEST) {
+            _requestId = record.getRequestId();
+            _params.clear();
+            _isParamsComplete = false;
+            _stdin.clear();
+            _isStdinComplete = false;
+            _isAborted = false;
+            continue;
+        }
+        if (record.getRequestId() != _requestId) {
+            continue;
+        }
+        if (record.getType() == FastCgiRecord::PARAMS) {
+            _params += record.getContent();
+            _isParamsComplete = record.getContent().empty();
+        } else if (record.getType() == FastCgiRecord::STDIN) {
+            _stdin += record.getContent();
+            _isStdinComplete = record.getContent().empty();
+        } else if (record.getType() == FastCgiRecord::ABORT_REQUEST) {
+            _isAborted = true;
+        }
+    }
+    _received.erase(0, pos);
+}
+
+bool CgiWorker::readRequest() {
+    _isParamsComplete = false;
+    takeRecords();
+    while (!_isParamsComplete) {
+        if (!receive()) {
+            return (false);
+        }
+        takeRecords();
+    }
+    return (true);
+}
+
+pid_t CgiWorker::startScript(int& scriptIn, int& scriptOut) {
+    map<string, string> params;
+    if (!FastCgiRecord::decodeParams(_params, params)) {
+        _log.stream(LOG_ERROR) << "CGI worker got malformed parameters\n";
+        return (-1);
+    }
+    int toScript[2];
+    int fromScript[2];
+    if (pipe(toScript) == -1) {
+        return (-1);
+    }
+    if (pipe(fromScript) == -1) {
+        close(toScript[READING_PIPE_END]);
+        close(toScript[WRITING_PIPE_END]);
+        return (-1);
+    }
+    const pid_t pid = fork();
+    if (pid == -1) {
+        _log.stream(LOG_ERROR) << "fork() failed in CGI worker: " << strerror(errno) << "\n";
+        close(toScript[READING_PIPE_END]);
+        close(toScript[WRITING_PIPE_END]);
+        close(fromScript[READING_PIPE_END]);
+        close(fromScript[WRITING_PIPE_END]);
+        return (-1);
+    }
+    if (pid == 0) {
+        execScript(_interpreterPath, params, toScript, fromScript);
+    }
+    close(toScript[READING_PIPE_END]);
+    close(fromScript[WRITING_PIPE_END]);
+    // NOTE: a script busy writing output must not hold up reading it, so the body never blocks
+    fcntl(toScript[WRITING_PIPE_END], F_SETFL, O_NONBLOCK);
+    scriptIn = toScript[WRITING_PIPE_END];
+    scriptOut = fromScript[READING_PIPE_END];
+    return (pid);
+}
+
+/* NOTE: runs one script: the request body goes to its stdin as the pipe takes it,
+* its stdout goes back as STDOUT records. false if the server hung up meanwhile,
+* the script is killed and reaped then.
+*/
+bool CgiWorker::relay(pid_t pid, int scriptIn, int scriptOut) {
+    const int channelSlot = 0;
+    const int outputSlot = 1;
+    const int inputSlot = 2;
+    const int slots = 3;
+    struct pollfd fds[slots];
+    char buffer[READ_BUFFER_SIZE];
+
+    while (scriptOut != -1) {
+        if (scriptIn != -1 && _stdin.empty() && _isStdinComplete) {
+            close(scriptIn);  // NOTE: the script's EOF
+            scriptIn = -1;
+        }
+        fds[channelSlot].fd = STDIN_FILENO;
+        fds[channelSlot].events = POLLIN;
+        fds[outputSlot].fd = scriptOut;
+        fds[outputSlot].events = POLLIN;
+        fds[inputSlot].fd = (scriptIn != -1 && !_stdin.empty()) ? scriptIn : -1;
+        fds[inputSlot].events = POLLOUT;
+        for (int i = 0; i < slots; ++i) {
+            fds[i].revents = 0;
+        }
+        if (poll(fds, slots, -1) == -1) {
+            continue;  // NOTE: EINTR, nothing else is expected with three valid descriptors
+        }
+        if (fds[channelSlot].revents != 0) {
+            if (!receive()) {
+                kill(pid, SIGKILL);
+                waitpid(pid, NULL, 0);
+                close(scriptOut);
+                if (scriptIn != -1) {
+                    close(scriptIn);
+                }
+                return (false);
+            }
+            takeRecords();
+            if (_isAborted) {
+                kill(pid, SIGKILL);  // NOTE: its output ends right after, which ends the request
+            }
+        }
+        if (fds[inputSlot].revents != 0) {
+            const ssize_t written = write(scriptIn, _stdin.data(), _stdin.size());
+            if (written > 0) {
+                _stdin.erase(0, written);
+            } else if (written == -1 && errno != EAGAIN) {
+                // NOTE: EPIPE mostly: the script exited without reading it all
+                _stdin.clear();
+                close(scriptIn);
+                scriptIn = -1;
+            }
+        }
+        if (fds[outputSlot].revents != 0) {
+            const ssize_t bytesRead = read(scriptOut, buffer, sizeof(buffer));
+            if (bytesRead > 0) {
+                if (!send(FastCgiRecord::encodeStreamPart(
+                        FastCgiRecord::STDOUT,
+                        _requestId,
+                        string(buffer, bytesRead)
+                    ))) {
+                    kill(pid, SIGKILL);
+                    waitpid(pid, NULL, 0);
+                    close(scriptOut);
+                    if (scriptIn != -1) {
+                        close(scriptIn);
+                    }
+                    return (false);
+                }
+            } else {
+                close(scriptOut);
+                scriptOut = -1;
+            }
+        }
+    }
+    if (scriptIn != -1) {
+        close(scriptIn);
+    }
+    return (true);
+}
+
+// NOTE: a script may linger after closing its stdout; the server hanging up still gets noticed
+bool CgiWorker::waitScript(pid_t pid, int& status) {
+    while (true) {
+        const pid_t res = waitpid(pid, &status, WNOHANG);
+        if (res == pid || (res == -1 && errno != EINTR)) {
+            return (true);
+        }
+        struct pollfd channel;
+        channel.fd = STDIN_FILENO;
+        channel.events = POLLIN;
+        channel.revents = 0;
+        if (poll(&channel, 1, WAIT_POLL_MS) <= 0) {
+            continue;
+        }
+        if (!receive()) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return (false);
+        }
+        takeRecords();
+        if (_isAborted) {
+            kill(pid, SIGKILL);
+        }
+    }
+}
+
+bool CgiWorker::send(const string& records) {
+    size_t sent = 0;
+    while (sent < records.size()) {
+        const ssize_t written = write(STDIN_FILENO, records.data() + sent, records.size() - sent);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (false);
+        }
+        sent += written;
+    }
+    return (true);
+}
+}  // namespace webserver
@@ -0,0 +1,55 @@
+#ifndef CGIWORKER_HPP
+#define CGIWORKER_HPP
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+
+#include "logger/Logger.hpp"
+
+namespace webserver {
+/* NOTE: the process behind one connection of a CgiWorkerPool:
+* webserv started again as `webserv --cgi-worker <interpreter>`, with the connection as its stdin.
+* it speaks FastCGI there: each request's interpreter is forked from this small image
+* instead of from the server with all its connections, fed the request body,
+* and its output is passed back as it comes. the worker exits when the server hangs up.
+*/
+class CgiWorker {
+public:
+    static const char* const FLAG;
+
+    explicit CgiWorker(const std::string& interpreterPath);
+    ~CgiWorker();
+
+    int run();
+
+private:
+    static Logger _log;
+    static const int READ_BUFFER_SIZE = 16384;
+    static const int WAIT_POLL_MS = 100;
+
+    std::string _interpreterPath;
+    std::string _received;  // NOTE: bytes from the server not parsed into records yet
+    int _requestId;
+    std::string _params;
+    bool _isParamsComplete;
+    std::string _stdin;  // NOTE: request body not written to the script yet
+    bool _isStdinComplete;
+    bool _isAborted;
+
+    CgiWorker();
+    CgiWorker(const CgiWorker& other);
+    CgiWorker& operator=(const CgiWorker& other);
+
+    bool receive();  // NOTE: false once the server has hung up
+    void takeRecords();
+    bool readRequest();
+    pid_t startScript(int& scriptIn, int& scriptOut);
+    bool relay(pid_t pid, int scriptIn, int scriptOut);
+    bool waitScript(pid_t pid, int& status);
+    bool send(const std::string& records);
+};
+}  // namespace webserver
+
+#endif
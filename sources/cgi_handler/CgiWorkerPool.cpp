@@ -0,0 +1,113 @@
+#include "CgiWorkerPool.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "cgi_handler/CgiWorker.hpp"
+#include "cgi_handler/FastCgiPool.hpp"
+#include "event_backend/EventBackend.hpp"
+#include "logger/Logger.hpp"
+
+using std::string;
+using std::vector;
+
+namespace {
+const int DECIMAL_BASE = 10;
+
+/* NOTE: a safety net: the worker is forked from the whole server, and a descriptor it inherits
+* without close-on-exec, now or added later, would keep a connection or a port open
+* long after the server is done with it
+*/
+void closeInheritedDescriptors() {
+    vector<int> inherited;
+    DIR* dir = opendir("/proc/self/fd");
+    if (dir == NULL) {
+        return;
+    }
+    for (struct dirent* entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+        int fd = 0;
+        for (const char* digit = entry->d_name; *digit >= '0' && *digit <= '9'; ++digit) {
+            fd = fd * DECIMAL_BASE + (*digit - '0');
+        }
+        if (fd > STDERR_FILENO) {
+            inherited.push_back(fd);
+        }
+    }
+    closedir(dir);
+    for (size_t i = 0; i < inherited.size(); ++i) {
+        close(inherited[i]);
+    }
+}
+
+// NOTE: in the forked child, never returns
+void execWorker(int channel, const string& interpreterPath) {
+    char* envp[] = {NULL};
+    if (dup2(channel, STDIN_FILENO) != -1) {
+        closeInheritedDescriptors();
+        char* argv[] = {
+            const_cast<char*>("webserv"),
+            const_cast<char*>(webserver::CgiWorker::FLAG),
+            const_cast<char*>(interpreterPath.c_str()),
+            // clang-format off
+            NULL};
+        // clang-format on
+        execve("/proc/self/exe", argv, envp);
+    }
+    char* falseArgv[] = {const_cast<char*>("/usr/bin/false"), NULL};
+    execve("/usr/bin/false", falseArgv, envp);
+    while (true) {
+    }
+}
+}  // namespace
+
+namespace webserver {
+Logger CgiWorkerPool::_log;
+
+CgiWorkerPool::CgiWorkerPool(
+    const string& interpreterPath,
+    EventBackend& events,
+    size_t minWorkers,
+    size_t maxWorkers
+)
+    : FastCgiPool(interpreterPath, events, minWorkers, maxWorkers) {
+}
+
+CgiWorkerPool::~CgiWorkerPool() {
+}
+
+int CgiWorkerPool::connectBackend() {
+    int channel[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, channel) == -1) {
+        _log.stream(LOG_ERROR) << "socketpair() failed for CGI worker: " << strerror(errno) << "\n";
+        return (-1);
+    }
+    const pid_t pid = fork();
+    if (pid == -1) {
+        _log.stream(LOG_ERROR) << "fork() failed for CGI worker: " << strerror(errno) << "\n";
+        close(channel[0]);
+        close(channel[1]);
+        return (-1);
+    }
+    if (pid == 0) {
+        execWorker(channel[1], getName());
+    }
+    close(channel[1]);
+    if (fcntl(channel[0], F_SETFL, O_NONBLOCK) == -1 ||
+        fcntl(channel[0], F_SETFD, FD_CLOEXEC) == -1) {
+        _log.stream(LOG_ERROR) << "fcntl() failed for CGI worker: " << strerror(errno) << "\n";
+        close(channel[0]);  // NOTE: the worker sees EOF and exits, reapChildren() collects it
+        return (-1);
+    }
+    _log.stream(LOG_DEBUG) << "Started CGI worker " << pid << " for " << getName() << "\n";
+    return (channel[0]);
+}
+}  // namespace webserver
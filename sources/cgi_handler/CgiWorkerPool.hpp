@@ -0,0 +1,40 @@
+#ifndef CGIWORKERPOOL_HPP
+#define CGIWORKERPOOL_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "cgi_handler/FastCgiPool.hpp"
+#include "event_backend/EventBackend.hpp"
+#include "logger/Logger.hpp"
+
+namespace webserver {
+/* NOTE: pre-forked CGI workers for one interpreter, see CgiWorker.
+* a FastCgiPool whose connections are socketpairs to worker processes it starts itself,
+* so queueing, output streaming and timeouts work as for a FastCGI responder.
+* the minimum is started up front and kept, workers above it go after being idle a while.
+* a worker is started by fork() and exec of webserv, from the server's big image,
+* but once per worker, not once per request.
+*/
+class CgiWorkerPool : public FastCgiPool {
+private:
+    static Logger _log;
+
+    CgiWorkerPool();
+    CgiWorkerPool(const CgiWorkerPool& other);
+    CgiWorkerPool& operator=(const CgiWorkerPool& other);
+
+    virtual int connectBackend();
+
+public:
+    CgiWorkerPool(
+        const std::string& interpreterPath,
+        EventBackend& events,
+        size_t minWorkers,
+        size_t maxWorkers
+    );
+    virtual ~CgiWorkerPool();
+};
+}  // namespace webserver
+
+#endif
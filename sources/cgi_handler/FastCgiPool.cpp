@@ -0,0 +1,404 @@
+#include "FastCgiPool.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cgi_handler/FastCgiRecord.hpp"
+#include "event_backend/EventBackend.hpp"
+#include "logger/Logger.hpp"
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace webserver {
+Logger FastCgiPool::_log;
+
+FastCgiPool::FastCgiPool(const string& socketPath, EventBackend& events)
+    : _name(socketPath)
+    , _events(events)
+    , _minConnections(0)
+    , _maxConnections(MAX_CONNECTIONS)
+    , _nextRequestId(1) {
+}
+
+FastCgiPool::FastCgiPool(
+    const string& name,
+    EventBackend& events,
+    size_t minConnections,
+    size_t maxConnections
+)
+    : _name(name)
+    , _events(events)
+    , _minConnections(minConnections)
+    , _maxConnections(maxConnections)
+    , _nextRequestId(1) {
+}
+
+FastCgiPool::~FastCgiPool() {
+    for (map<int, Backend>::iterator itr = _backends.begin(); itr != _backends.end(); ++itr) {
+        _events.remove(itr->first);
+        close(itr->first);
+    }
+}
+
+const string& FastCgiPool::getName() const {
+    return (_name);
+}
+
+int FastCgiPool::connectBackend() {
+    struct ::sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (_name.size() >= sizeof(address.sun_path)) {
+        _log.stream(LOG_ERROR) << "FastCGI socket path too long: " << _name << "\n";
+        return (-1);
+    }
+    _name.copy(address.sun_path, _name.size());
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        _log.stream(LOG_ERROR) << "socket() failed for FastCGI: " << std::strerror(errno) << "\n";
+        return (-1);
+    }
+    if (fcntl(fd, F_SETFL, O_NONBLOCK) == -1 || fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+        _log.stream(LOG_ERROR) << "fcntl() failed for FastCGI: " << std::strerror(errno) << "\n";
+        close(fd);
+        return (-1);
+    }
+    // NOTE: a unix socket connects at once; EAGAIN means the responder's backlog is full
+    if (connect(fd, reinterpret_cast<struct ::sockaddr*>(&address), sizeof(address)) == -1) {
+        _log.stream(LOG_ERROR) << "connect() to FastCGI responder " << _name
+                               << " failed: " << std::strerror(errno) << "\n";
+        close(fd);
+        return (-1);
+    }
+    return (fd);
+}
+
+int FastCgiPool::openBackend() {
+    const int fd = connectBackend();
+    if (fd == -1) {
+        return (-1);
+    }
+    Backend backend;
+    backend.clientFd = -1;
+    backend.requestId = 0;
+    backend.recordsSent = 0;
+    backend.isReused = false;
+    backend.isResponding = false;
+    backend.isPaused = false;
+    backend.lastActivity = time(NULL);
+    _backends[fd] = backend;
+    _events.add(fd, POLLIN, EventBackend::LEVEL_TRIGGERED);
+    _log.stream(LOG_DEBUG) << "Opened FastCGI connection " << fd << " to " << _name << " ("
+                           << _backends.size() << " in pool)\n";
+    return (fd);
+}
+
+int FastCgiPool::findBackend(int clientFd) const {
+    for (map<int, Backend>::const_iterator itr = _backends.begin(); itr != _backends.end();
+         ++itr) {
+        if (itr->second.clientFd == clientFd) {
+            return (itr->first);
+        }
+    }
+    return (-1);
+}
+
+void FastCgiPool::assign(int fd, int clientFd, int requestId, const string& records) {
+    Backend& backend = _backends[fd];
+    backend.clientFd = clientFd;
+    backend.requestId = requestId;
+    backend.records = records;
+    backend.recordsSent = 0;
+    backend.received.clear();
+    backend.isResponding = false;
+    backend.isPaused = false;
+    backend.lastActivity = time(NULL);
+    updateEvents(fd);
+}
+
+void FastCgiPool::updateEvents(int fd) {
+    const Backend& backend = _backends[fd];
+    short events = 0;
+    if (!backend.isPaused) {
+        events |= POLLIN;
+    }
+    if (backend.recordsSent < backend.records.size()) {
+        events |= POLLOUT;
+    }
+    _events.modify(fd, events);
+}
+
+bool FastCgiPool::flush(int fd) {
+    Backend& backend = _backends[fd];
+    while (backend.recordsSent < backend.records.size()) {
+        const ssize_t written = write(
+            fd,
+            backend.records.data() + backend.recordsSent,
+            backend.records.size() - backend.recordsSent
+        );
+        if (written == -1) {
+            return (errno == EAGAIN);
+        }
+        backend.recordsSent += written;
+        backend.lastActivity = time(NULL);
+    }
+    return (true);
+}
+
+bool FastCgiPool::receive(int fd, vector<Output>& outputs) {
+    char buffer[READ_BUFFER_SIZE];
+    const ssize_t bytesRead = read(fd, buffer, sizeof(buffer));
+    if (bytesRead == -1 && errno == EAGAIN) {
+        return (true);
+    }
+    if (bytesRead <= 0) {
+        return (false);
+    }
+    Backend& backend = _backends[fd];
+    if (backend.clientFd == -1) {
+        _log.stream(LOG_WARN) << "Unexpected data on idle FastCGI connection " << fd << "\n";
+        return (false);
+    }
+    backend.lastActivity = time(NULL);
+    backend.received.append(buffer, bytesRead);
+
+    Output output;
+    output.clientFd = backend.clientFd;
+    output.state = PARTIAL;
+    size_t pos = 0;
+    FastCgiRecord record;
+    while (output.state == PARTIAL && FastCgiRecord::decode(backend.received, pos, record)) {
+        if (record.getRequestId() != backend.requestId) {
+            continue;  // NOTE: management records, or leftovers of an aborted request
+        }
+        if (record.getType() == FastCgiRecord::STDOUT) {
+            output.data += record.getContent();
+            backend.isResponding = true;
+        } else if (record.getType() == FastCgiRecord::STDERR) {
+            _log.stream(LOG_WARN) << "FastCGI responder " << _name << ": "
+                                  << record.getContent() << "\n";
+        } else if (record.getType() == FastCgiRecord::END_REQUEST) {
+            _log.stream(LOG_DEBUG) << "FastCGI request " << backend.requestId
+                                   << " ended with status " << record.getAppStatus() << "\n";
+            output.state = COMPLETE;
+        }
+    }
+    backend.received.erase(0, pos);
+    if (backend.isResponding && backend.recordsSent == backend.records.size()) {
+        backend.records.clear();  // NOTE: past the point of a retry
+        backend.recordsSent = 0;
+    }
+    if (!output.data.empty() || output.state == COMPLETE) {
+        outputs.push_back(output);
+    }
+    if (output.state == COMPLETE && backend.recordsSent < backend.records.size()) {
+        // NOTE: answered before taking the whole body: the rest would pass for the next request
+        closeBackend(fd);
+        serveQueue();
+    } else if (output.state == COMPLETE) {
+        release(fd);
+    }
+    return (true);
+}
+
+void FastCgiPool::release(int fd) {
+    Backend& backend = _backends[fd];
+    backend.clientFd = -1;
+    backend.records.clear();
+    backend.recordsSent = 0;
+    backend.received.clear();
+    backend.isReused = true;
+    backend.isResponding = false;
+    backend.isPaused = false;
+    backend.lastActivity = time(NULL);
+    if (!_queue.empty()) {
+        const Pending next = _queue.front();
+        _queue.pop_front();
+        assign(fd, next.clientFd, next.requestId, next.records);
+        return;
+    }
+    updateEvents(fd);  // NOTE: idle, watched only to notice the responder closing it
+}
+
+void FastCgiPool::retryOrFail(int fd, vector<Output>& outputs) {
+    const Backend backend = _backends[fd];
+    closeBackend(fd);
+    if (backend.clientFd == -1) {
+        serveQueue();
+        return;
+    }
+    if (backend.isReused && !backend.isResponding) {
+        // NOTE: the responder dropped this idle connection before our request reached it
+        const int newFd = openBackend();
+        if (newFd != -1) {
+            assign(newFd, backend.clientFd, backend.requestId, backend.records);
+            return;
+        }
+    }
+    _log.stream(LOG_ERROR) << "FastCGI responder " << _name
+                           << " closed the connection mid-request\n";
+    Output output;
+    output.clientFd = backend.clientFd;
+    output.state = FAILED;
+    outputs.push_back(output);
+    serveQueue();
+}
+
+void FastCgiPool::closeBackend(int fd) {
+    _events.remove(fd);
+    close(fd);
+    _backends.erase(fd);
+}
+
+void FastCgiPool::serveQueue() {
+    while (!_queue.empty() && _backends.size() < _maxConnections) {
+        const int fd = openBackend();
+        if (fd == -1) {
+            return;  // NOTE: the queued requests time out unless a connection frees up
+        }
+        const Pending next = _queue.front();
+        _queue.pop_front();
+        assign(fd, next.clientFd, next.requestId, next.records);
+    }
+}
+
+bool FastCgiPool::startRequest(
+    int clientFd,
+    const map<string, string>& params,
+    const string& body
+) {
+    const int requestId = _nextRequestId;
+    _nextRequestId = _nextRequestId % MAX_REQUEST_ID + 1;
+    const string records = FastCgiRecord::encodeBeginRequest(requestId, true) +
+                           FastCgiRecord::encodeParams(requestId, params) +
+                           FastCgiRecord::encodeStream(FastCgiRecord::STDIN, requestId, body);
+
+    const int idleFd = findBackend(-1);
+    if (idleFd != -1) {
+        assign(idleFd, clientFd, requestId, records);
+        return (true);
+    }
+    if (_backends.size() < _maxConnections) {
+        const int fd = openBackend();
+        if (fd != -1) {
+            assign(fd, clientFd, requestId, records);
+            return (true);
+        }
+        if (_backends.empty()) {
+            return (false);
+        }
+    }
+    Pending pending;
+    pending.clientFd = clientFd;
+    pending.requestId = requestId;
+    pending.records = records;
+    pending.since = time(NULL);
+    _queue.push_back(pending);
+    return (true);
+}
+
+bool FastCgiPool::owns(int fd) const {
+    return (_backends.find(fd) != _backends.end());
+}
+
+void FastCgiPool::handleEvent(int fd, short revents, vector<Output>& outputs) {
+    if (!owns(fd)) {
+        return;
+    }
+    if ((revents & POLLOUT) > 0 && !flush(fd)) {
+        retryOrFail(fd, outputs);
+        return;
+    }
+    if ((revents & (POLLIN | POLLHUP | POLLERR)) > 0 && !receive(fd, outputs)) {
+        retryOrFail(fd, outputs);
+        return;
+    }
+    if (owns(fd)) {
+        updateEvents(fd);
+    }
+}
+
+void FastCgiPool::cancelRequest(int clientFd) {
+    for (std::deque<Pending>::iterator itr = _queue.begin(); itr != _queue.end();) {
+        if (itr->clientFd == clientFd) {
+            itr = _queue.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+    const int fd = findBackend(clientFd);
+    if (fd == -1) {
+        return;
+    }
+    // NOTE: the rest of its response would have to be read and dropped, a new connection is cheaper
+    closeBackend(fd);
+    serveQueue();
+}
+
+void FastCgiPool::pauseOutput(int clientFd) {
+    const int fd = findBackend(clientFd);
+    if (fd != -1) {
+        _backends[fd].isPaused = true;
+        updateEvents(fd);
+    }
+}
+
+void FastCgiPool::resumeOutput(int clientFd) {
+    const int fd = findBackend(clientFd);
+    if (fd != -1 && _backends[fd].isPaused) {
+        _backends[fd].isPaused = false;
+        updateEvents(fd);
+    }
+}
+
+void FastCgiPool::collectTimedOut(time_t now, int timeoutSeconds, vector<int>& clientFds) const {
+    for (map<int, Backend>::const_iterator itr = _backends.begin(); itr != _backends.end();
+         ++itr) {
+        if (itr->second.clientFd != -1 && now - itr->second.lastActivity > timeoutSeconds) {
+            clientFds.push_back(itr->second.clientFd);
+        }
+    }
+    for (std::deque<Pending>::const_iterator itr = _queue.begin(); itr != _queue.end(); ++itr) {
+        if (now - itr->since > timeoutSeconds) {
+            clientFds.push_back(itr->clientFd);
+        }
+    }
+}
+
+void FastCgiPool::maintain(time_t now) {
+    for (map<int, Backend>::iterator itr = _backends.begin(); itr != _backends.end();) {
+        const int fd = itr->first;
+        const Backend& backend = itr->second;
+        ++itr;  // NOTE: closing below invalidates the current position
+        if (backend.clientFd != -1) {
+            continue;
+        }
+        if (_backends.size() > _minConnections &&
+            now - backend.lastActivity > IDLE_CONNECTION_SECONDS) {
+            _log.stream(LOG_DEBUG) << "Closing idle FastCGI connection " << fd << " to " << _name
+                                   << "\n";
+            closeBackend(fd);
+        }
+    }
+    while (_backends.size() < _minConnections) {
+        if (openBackend() == -1) {
+            return;
+        }
+    }
+}
+}  // namespace webserver
@@ -0,0 +1,119 @@
+#ifndef FASTCGIPOOL_HPP
+#define FASTCGIPOOL_HPP
+
+#include <time.h>
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "event_backend/EventBackend.hpp"
+#include "logger/Logger.hpp"
+
+namespace webserver {
+/* NOTE: persistent connections to one FastCGI responder (php-fpm and the like) on a unix socket.
+* requests are spread over up to MAX_CONNECTIONS connections opened with FCGI_KEEP_CONN,
+* which stay open between requests, so a script costs no fork() and no interpreter startup.
+* a connection carries one request at a time: most responders do not multiplex,
+* and the record reader still checks request ids. when all connections are busy, requests queue.
+* the pool registers its sockets with the event backend itself, level-triggered,
+* and turns what the responder sends into Output pieces for the caller to pass to the client.
+* connections idle for IDLE_CONNECTION_SECONDS are closed, down to the pool's minimum.
+*/
+class FastCgiPool {
+public:
+    static const size_t MAX_CONNECTIONS = 8;
+    static const int IDLE_CONNECTION_SECONDS = 60;
+
+    enum OutputState { PARTIAL, COMPLETE, FAILED };
+
+    struct Output {
+        int clientFd;
+        std::string data;  // NOTE: the script's stdout, CGI headers first
+        OutputState state;
+    };
+
+private:
+    struct Backend {
+        int clientFd;  // NOTE: -1 while idle
+        int requestId;
+        std::string records;  // NOTE: the whole request, kept until the response starts
+        size_t recordsSent;
+        std::string received;  // NOTE: responder bytes not parsed into records yet
+        bool isReused;         // NOTE: served before, the responder may have closed it since
+        bool isResponding;
+        bool isPaused;
+        time_t lastActivity;
+    };
+
+    struct Pending {
+        int clientFd;
+        int requestId;
+        std::string records;
+        time_t since;
+    };
+
+    static Logger _log;
+    static const int READ_BUFFER_SIZE = 16384;
+    static const int MAX_REQUEST_ID = 65535;
+
+    std::string _name;  // NOTE: the socket path, or what a subclass connects to instead
+    EventBackend& _events;
+    size_t _minConnections;
+    size_t _maxConnections;
+    std::map<int, Backend> _backends;  // NOTE: socket fd: the request it is serving
+    std::deque<Pending> _queue;        // NOTE: requests waiting for a connection
+    int _nextRequestId;
+
+    FastCgiPool();
+    FastCgiPool(const FastCgiPool& other);
+    FastCgiPool& operator=(const FastCgiPool& other);
+
+    int openBackend();  // NOTE: -1 if the responder cannot be reached
+    int findBackend(int clientFd) const;
+    void assign(int fd, int clientFd, int requestId, const std::string& records);
+    void updateEvents(int fd);
+    bool flush(int fd);
+    bool receive(int fd, std::vector<Output>& outputs);
+    void release(int fd);
+    void retryOrFail(int fd, std::vector<Output>& outputs);
+    void closeBackend(int fd);
+    void serveQueue();
+
+protected:
+    FastCgiPool(
+        const std::string& name,
+        EventBackend& events,
+        size_t minConnections,
+        size_t maxConnections
+    );
+
+    const std::string& getName() const;
+    // NOTE: a connected socket, non-blocking and close-on-exec, or -1
+    virtual int connectBackend();
+
+public:
+    FastCgiPool(const std::string& socketPath, EventBackend& events);
+    virtual ~FastCgiPool();
+
+    // NOTE: false if the responder cannot be reached at all
+    bool startRequest(
+        int clientFd,
+        const std::map<std::string, std::string>& params,
+        const std::string& body
+    );
+    bool owns(int fd) const;
+    void handleEvent(int fd, short revents, std::vector<Output>& outputs);
+    void cancelRequest(int clientFd);
+    // NOTE: the client reads slower than the script writes, stop reading the responder meanwhile
+    void pauseOutput(int clientFd);
+    void resumeOutput(int clientFd);
+    void collectTimedOut(time_t now, int timeoutSeconds, std::vector<int>& clientFds) const;
+    // NOTE: once in a while: closes long idle connections, opens idle ones up to the minimum
+    void maintain(time_t now);
+};
+}  // namespace webserver
+
+#endif
@@ -0,0 +1,213 @@
+#include "FastCgiRecord.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+using std::map;
+using std::string;
+
+namespace {
+const int VERSION = 1;
+const int RESPONDER_ROLE = 1;
+const int KEEP_CONNECTION_FLAG = 1;
+const int BYTE_BITS = 8;
+const int BYTE_MASK = 0xFF;
+const size_t ALIGNMENT = 8;
+const size_t SHORT_LENGTH_LIMIT = 127;  // NOTE: longer name or value lengths take 4 bytes
+const size_t LONG_LENGTH_BIT = 0x80;
+
+unsigned char byteAt(const string& buffer, size_t pos) {
+    return (static_cast<unsigned char>(buffer[pos]));
+}
+
+size_t readTwoBytes(const string& buffer, size_t pos) {
+    return ((byteAt(buffer, pos) << BYTE_BITS) | byteAt(buffer, pos + 1));
+}
+}  // namespace
+
+namespace webserver {
+FastCgiRecord::FastCgiRecord()
+    : _type(0)
+    , _requestId(0) {
+}
+
+FastCgiRecord::FastCgiRecord(const FastCgiRecord& other)
+    : _type(other._type)
+    , _requestId(other._requestId)
+    , _content(other._content) {
+}
+
+FastCgiRecord& FastCgiRecord::operator=(const FastCgiRecord& other) {
+    if (this != &other) {
+        _type = other._type;
+        _requestId = other._requestId;
+        _content = other._content;
+    }
+    return (*this);
+}
+
+FastCgiRecord::~FastCgiRecord() {
+}
+
+int FastCgiRecord::getType() const {
+    return (_type);
+}
+
+int FastCgiRecord::getRequestId() const {
+    return (_requestId);
+}
+
+const string& FastCgiRecord::getContent() const {
+    return (_content);
+}
+
+int FastCgiRecord::getAppStatus() const {
+    const size_t appStatusBytes = 4;
+    if (_type != END_REQUEST || _content.size() < appStatusBytes) {
+        return (0);
+    }
+    int res = 0;
+    for (size_t i = 0; i < appStatusBytes; i++) {
+        res = (res << BYTE_BITS) | byteAt(_content, i);
+    }
+    return (res);
+}
+
+string FastCgiRecord::encodeRecord(int type, int requestId, const char* content, size_t size) {
+    const size_t padding = (ALIGNMENT - size % ALIGNMENT) % ALIGNMENT;
+    string res;
+    res.reserve(HEADER_BYTES + size + padding);
+    res += static_cast<char>(VERSION);
+    res += static_cast<char>(type);
+    res += static_cast<char>((requestId >> BYTE_BITS) & BYTE_MASK);
+    res += static_cast<char>(requestId & BYTE_MASK);
+    res += static_cast<char>((size >> BYTE_BITS) & BYTE_MASK);
+    res += static_cast<char>(size & BYTE_MASK);
+    res += static_cast<char>(padding);
+    res += '\0';
+    res.append(content, size);
+    res.append(padding, '\0');
+    return (res);
+}
+
+void FastCgiRecord::encodeLength(string& out, size_t length) {
+    if (length <= SHORT_LENGTH_LIMIT) {
+        out += static_cast<char>(length);
+        return;
+    }
+    const int shift24 = 24;
+    const int shift16 = 16;
+    out += static_cast<char>(((length >> shift24) & BYTE_MASK) | LONG_LENGTH_BIT);
+    out += static_cast<char>((length >> shift16) & BYTE_MASK);
+    out += static_cast<char>((length >> BYTE_BITS) & BYTE_MASK);
+    out += static_cast<char>(length & BYTE_MASK);
+}
+
+string FastCgiRecord::encodeBeginRequest(int requestId, bool keepConnection) {
+    const size_t bodyBytes = 8;
+    char body[bodyBytes] = {0};
+    body[1] = static_cast<char>(RESPONDER_ROLE);
+    body[2] = static_cast<char>(keepConnection ? KEEP_CONNECTION_FLAG : 0);
+    return (encodeRecord(BEGIN_REQUEST, requestId, body, bodyBytes));
+}
+
+string FastCgiRecord::encodeParams(int requestId, const map<string, string>& params) {
+    string pairs;
+    for (map<string, string>::const_iterator itr = params.begin(); itr != params.end(); ++itr) {
+        encodeLength(pairs, itr->first.size());
+        encodeLength(pairs, itr->second.size());
+        pairs += itr->first;
+        pairs += itr->second;
+    }
+    return (encodeStream(PARAMS, requestId, pairs));
+}
+
+string FastCgiRecord::encodeStream(Type type, int requestId, const string& data) {
+    return (encodeStreamPart(type, requestId, data) + encodeRecord(type, requestId, "", 0));
+}
+
+string FastCgiRecord::encodeStreamPart(Type type, int requestId, const string& data) {
+    string res;
+    for (size_t pos = 0; pos < data.size(); pos += MAX_CONTENT_BYTES) {
+        size_t size = data.size() - pos;
+        if (size > MAX_CONTENT_BYTES) {
+            size = MAX_CONTENT_BYTES;
+        }
+        res += encodeRecord(type, requestId, data.data() + pos, size);
+    }
+    return (res);
+}
+
+string FastCgiRecord::encodeAbortRequest(int requestId) {
+    return (encodeRecord(ABORT_REQUEST, requestId, "", 0));
+}
+
+string FastCgiRecord::encodeEndRequest(int requestId, int appStatus) {
+    const size_t bodyBytes = 8;
+    const int shift24 = 24;
+    const int shift16 = 16;
+    char body[bodyBytes] = {0};  // NOTE: protocol status 0 is FCGI_REQUEST_COMPLETE
+    body[0] = static_cast<char>((appStatus >> shift24) & BYTE_MASK);
+    body[1] = static_cast<char>((appStatus >> shift16) & BYTE_MASK);
+    body[2] = static_cast<char>((appStatus >> BYTE_BITS) & BYTE_MASK);
+    body[3] = static_cast<char>(appStatus & BYTE_MASK);
+    return (encodeRecord(END_REQUEST, requestId, body, bodyBytes));
+}
+
+bool FastCgiRecord::decode(const string& buffer, size_t& pos, FastCgiRecord& record) {
+    const size_t typeAt = 1;
+    const size_t requestIdAt = 2;
+    const size_t contentLengthAt = 4;
+    const size_t paddingAt = 6;
+    if (buffer.size() - pos < HEADER_BYTES) {
+        return (false);
+    }
+    const size_t contentLength = readTwoBytes(buffer, pos + contentLengthAt);
+    const size_t recordBytes = HEADER_BYTES + contentLength + byteAt(buffer, pos + paddingAt);
+    if (buffer.size() - pos < recordBytes) {
+        return (false);
+    }
+    record._type = byteAt(buffer, pos + typeAt);
+    record._requestId = static_cast<int>(readTwoBytes(buffer, pos + requestIdAt));
+    record._content.assign(buffer, pos + HEADER_BYTES, contentLength);
+    pos += recordBytes;
+    return (true);
+}
+
+bool FastCgiRecord::decodeLength(const string& pairs, size_t& pos, size_t& length) {
+    const size_t longLengthBytes = 4;
+    if (pos >= pairs.size()) {
+        return (false);
+    }
+    if ((byteAt(pairs, pos) & LONG_LENGTH_BIT) == 0) {
+        length = byteAt(pairs, pos);
+        pos++;
+        return (true);
+    }
+    if (pairs.size() - pos < longLengthBytes) {
+        return (false);
+    }
+    length = byteAt(pairs, pos) & ~LONG_LENGTH_BIT;
+    for (size_t i = 1; i < longLengthBytes; i++) {
+        length = (length << BYTE_BITS) | byteAt(pairs, pos + i);
+    }
+    pos += longLengthBytes;
+    return (true);
+}
+
+bool FastCgiRecord::decodeParams(const string& pairs, map<string, string>& params) {
+    size_t pos = 0;
+    while (pos < pairs.size()) {
+        size_t nameLength;
+        size_t valueLength;
+        if (!decodeLength(pairs, pos, nameLength) || !decodeLength(pairs, pos, valueLength) ||
+            pairs.size() - pos < nameLength || pairs.size() - pos - nameLength < valueLength) {
+            return (false);
+        }
+        params[pairs.substr(pos, nameLength)] = pairs.substr(pos + nameLength, valueLength);
+        pos += nameLength + valueLength;
+    }
+    return (true);
+}
+}  // namespace webserver
@@ -0,0 +1,68 @@
+#ifndef FASTCGIRECORD_HPP
+#define FASTCGIRECORD_HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace webserver {
+/* NOTE: a FastCGI 1.0 record: 8 header bytes, then the content and up to 7 bytes of padding.
+* the encoders return ready-to-send bytes, streams already split into records of at most 64 KiB
+* and closed with the empty record the protocol requires.
+*/
+class FastCgiRecord {
+public:
+    enum Type {
+        BEGIN_REQUEST = 1,
+        ABORT_REQUEST = 2,
+        END_REQUEST = 3,
+        PARAMS = 4,
+        STDIN = 5,
+        STDOUT = 6,
+        STDERR = 7
+    };
+
+    static const size_t HEADER_BYTES = 8;
+    static const size_t MAX_CONTENT_BYTES = 65535;
+
+private:
+    int _type;
+    int _requestId;
+    std::string _content;
+
+    static std::string encodeRecord(int type, int requestId, const char* content, size_t size);
+    static void encodeLength(std::string& out, size_t length);
+    static bool decodeLength(const std::string& pairs, size_t& pos, size_t& length);
+
+public:
+    FastCgiRecord();
+    FastCgiRecord(const FastCgiRecord& other);
+    FastCgiRecord& operator=(const FastCgiRecord& other);
+    ~FastCgiRecord();
+
+    int getType() const;
+    int getRequestId() const;
+    const std::string& getContent() const;
+    // NOTE: END_REQUEST only: the application's exit status
+    int getAppStatus() const;
+
+    static std::string encodeBeginRequest(int requestId, bool keepConnection);
+    static std::string encodeParams(int requestId, const std::map<std::string, std::string>& params);
+    static std::string encodeStream(Type type, int requestId, const std::string& data);
+    // NOTE: the same records without the closing empty one, for a stream sent piece by piece
+    static std::string encodeStreamPart(Type type, int requestId, const std::string& data);
+    static std::string encodeAbortRequest(int requestId);
+    static std::string encodeEndRequest(int requestId, int appStatus);
+    /* NOTE: reads the record starting at pos and moves pos past it.
+    * false if it has not fully arrived yet, pos is left alone then.
+    */
+    static bool decode(const std::string& buffer, size_t& pos, FastCgiRecord& record);
+    // NOTE: the name-value pairs of a whole PARAMS stream; false if it is malformed
+    static bool decodeParams(
+        const std::string& pairs,
+        std::map<std::string, std::string>& params
+    );
+};
+}  // namespace webserver
+
+#endif
@@ -6,16 +6,23 @@
 #include <string>
 
 #include "configuration/Endpoint.hpp"
+#include "event_backend/EventBackend.hpp"
 
 using std::ostream;
 using std::set;
 using std::string;
 
 namespace webserver {
-AppConfig::AppConfig() {
+AppConfig::AppConfig()
+    : _eventBackend(EventBackend::POLL)
+    , _workerProcesses(1)
+    , _acceptBatch(DEFAULT_ACCEPT_BATCH) {
 }
 
-AppConfig::AppConfig(const AppConfig& other) {
+AppConfig::AppConfig(const AppConfig& other)
+    : _eventBackend(other._eventBackend)
+    , _workerProcesses(other._workerProcesses)
+    , _acceptBatch(other._acceptBatch) {
     for (set<Endpoint*>::const_iterator itr = other._endpoints.begin();
          itr != other._endpoints.end();
          itr++) {
@@ -30,6 +37,10 @@ AppConfig& AppConfig::operator=(const AppConfig& other) {
     for (set<Endpoint*>::iterator itr = _endpoints.begin(); itr != _endpoints.end(); itr++) {
         delete *itr;
     }
+    _endpoints.clear();
+    _eventBackend = other._eventBackend;
+    _workerProcesses = other._workerProcesses;
+    _acceptBatch = other._acceptBatch;
     for (set<Endpoint*>::const_iterator itr = other._endpoints.begin();
          itr != other._endpoints.end();
          itr++) {
@@ -43,14 +54,50 @@ AppConfig& AppConfig::addEndpoint(const Endpoint& tgt) {
     return (*this);
 }
 
+AppConfig& AppConfig::setEventBackend(EventBackend::Type type) {
+    _eventBackend = type;
+    return (*this);
+}
+
+EventBackend::Type AppConfig::getEventBackend() const {
+    return (_eventBackend);
+}
+
+AppConfig& AppConfig::setWorkerProcesses(int count) {
+    _workerProcesses = count;
+    return (*this);
+}
+
+int AppConfig::getWorkerProcesses() const {
+    return (_workerProcesses);
+}
+
+AppConfig& AppConfig::setAcceptBatch(int count) {
+    _acceptBatch = count;
+    return (*this);
+}
+
+int AppConfig::getAcceptBatch() const {
+    return (_acceptBatch);
+}
+
 bool AppConfig::operator==(const AppConfig& other) const {
+    if (_eventBackend != other._eventBackend || _workerProcesses != other._workerProcesses ||
+        _acceptBatch != other._acceptBatch) {
+        return (false);
+    }
     if (_endpoints.size() != other._endpoints.size()) {
         return (false);
     }
-    set<Endpoint*>::const_iterator itr = _endpoints.begin();
-    set<Endpoint*>::const_iterator itro = other._endpoints.begin();
-    for (; itr != _endpoints.end(); itr++, itro++) {
-        if (!((**itr) == (**itro))) {
+    // NOTE: the set is ordered by pointer, that is by allocation, so positions mean nothing
+    for (set<Endpoint*>::const_iterator itr = _endpoints.begin(); itr != _endpoints.end(); itr++) {
+        bool found = false;
+        for (set<Endpoint*>::const_iterator itro = other._endpoints.begin();
+             itro != other._endpoints.end() && !found;
+             itro++) {
+            found = (**itr) == (**itro);
+        }
+        if (!found) {
             return (false);
         }
     }
@@ -77,6 +124,9 @@ AppConfig::~AppConfig() {
 }
 
 ostream& operator<<(ostream& oss, const AppConfig& config) {
+    oss << "event_backend: " << eventBackendTypeToString(config._eventBackend) << "\n";
+    oss << "worker_processes: " << config._workerProcesses << "\n";
+    oss << "accept_batch: " << config._acceptBatch << "\n";
     for (set<Endpoint*>::const_iterator itr = config._endpoints.begin();
          itr != config._endpoints.end();
          itr++) {
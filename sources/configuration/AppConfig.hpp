@@ -6,6 +6,7 @@
 
 #include "configuration/Endpoint.hpp"
 #include "configuration/RouteConfig.hpp"
+#include "event_backend/EventBackend.hpp"
 
 namespace webserver {
 class AppConfig {
@@ -15,8 +16,14 @@ private:
     * so storing as set of pointers to Endpoints
     */
     std::set<Endpoint*> _endpoints;
+    EventBackend::Type _eventBackend;
+    int _workerProcesses;
+    int _acceptBatch;
 
 public:
+    static const int MAX_WORKER_PROCESSES = 64;
+    static const int DEFAULT_ACCEPT_BATCH = 64;
+
     AppConfig();
     AppConfig(const AppConfig& other);
     AppConfig& operator=(const AppConfig& other);
@@ -25,6 +32,12 @@ public:
     AppConfig& addEndpoint(const Endpoint& tgt);
     const std::set<Endpoint*>& getEndpoints() const;
     const Endpoint* getEndpoint(std::string interface, int port) const;
+    AppConfig& setEventBackend(EventBackend::Type type);
+    EventBackend::Type getEventBackend() const;
+    AppConfig& setWorkerProcesses(int count);
+    int getWorkerProcesses() const;
+    AppConfig& setAcceptBatch(int count);
+    int getAcceptBatch() const;
 
     bool operator==(const AppConfig& other) const;
     friend std::ostream& operator<<(std::ostream& oss, const AppConfig& config);
@@ -10,13 +10,19 @@ namespace webserver {
 CgiHandlerConfig::CgiHandlerConfig()
     : _timeoutSeconds(0)
     , _executablePath("")
-    , _storageRootPath("") {
+    , _storageRootPath("")
+    , _fastCgiSocketPath("")
+    , _poolMinWorkers(0)
+    , _poolMaxWorkers(0) {
 }
 
 CgiHandlerConfig::CgiHandlerConfig(const CgiHandlerConfig& other)
     : _timeoutSeconds(other._timeoutSeconds)
     , _executablePath(other._executablePath)
-    , _storageRootPath(other._storageRootPath) {
+    , _storageRootPath(other._storageRootPath)
+    , _fastCgiSocketPath(other._fastCgiSocketPath)
+    , _poolMinWorkers(other._poolMinWorkers)
+    , _poolMaxWorkers(other._poolMaxWorkers) {
 }
 
 CgiHandlerConfig& CgiHandlerConfig::operator=(const CgiHandlerConfig& other) {
@@ -26,23 +32,62 @@ CgiHandlerConfig& CgiHandlerConfig::operator=(const CgiHandlerConfig& other) {
     _executablePath = other._executablePath;
     _storageRootPath = other._storageRootPath;
     _timeoutSeconds = other._timeoutSeconds;
+    _fastCgiSocketPath = other._fastCgiSocketPath;
+    _poolMinWorkers = other._poolMinWorkers;
+    _poolMaxWorkers = other._poolMaxWorkers;
     return (*this);
 }
 
 CgiHandlerConfig::CgiHandlerConfig(int timeoutSeconds, const string& executablePath)
     : _timeoutSeconds(timeoutSeconds)
     , _executablePath(executablePath)
-    , _storageRootPath("") {
+    , _storageRootPath("")
+    , _fastCgiSocketPath("")
+    , _poolMinWorkers(0)
+    , _poolMaxWorkers(0) {
 }
 
 std::string CgiHandlerConfig::getExecutablePath() const {
     return (_executablePath);
 }
 
+bool CgiHandlerConfig::isFastCgi() const {
+    return (!_fastCgiSocketPath.empty());
+}
+
+std::string CgiHandlerConfig::getFastCgiSocketPath() const {
+    return (_fastCgiSocketPath);
+}
+
+CgiHandlerConfig& CgiHandlerConfig::setFastCgiSocketPath(const string& socketPath) {
+    _fastCgiSocketPath = socketPath;
+    return (*this);
+}
+
+bool CgiHandlerConfig::hasWorkerPool() const {
+    return (_poolMaxWorkers > 0);
+}
+
+int CgiHandlerConfig::getPoolMinWorkers() const {
+    return (_poolMinWorkers);
+}
+
+int CgiHandlerConfig::getPoolMaxWorkers() const {
+    return (_poolMaxWorkers);
+}
+
+CgiHandlerConfig& CgiHandlerConfig::setWorkerPool(int minWorkers, int maxWorkers) {
+    _poolMinWorkers = minWorkers;
+    _poolMaxWorkers = maxWorkers;
+    return (*this);
+}
+
 bool CgiHandlerConfig::operator==(const CgiHandlerConfig& other) const {
     return (
         _executablePath == other._executablePath && _storageRootPath == other._storageRootPath &&
-        _timeoutSeconds == other._timeoutSeconds
+        _timeoutSeconds == other._timeoutSeconds &&
+        _fastCgiSocketPath == other._fastCgiSocketPath &&
+        _poolMinWorkers == other._poolMinWorkers && _poolMaxWorkers == other._poolMaxWorkers
     );
 }
 
@@ -57,6 +102,12 @@ ostream& operator<<(ostream& oss, const CgiHandlerConfig& cgi) {
     oss << cgi._timeoutSeconds;
     oss << " " << cgi._executablePath;
     oss << " " << cgi._storageRootPath;
+    if (cgi.isFastCgi()) {
+        oss << " fastcgi unix:" << cgi._fastCgiSocketPath;
+    }
+    if (cgi.hasWorkerPool()) {
+        oss << " pool " << cgi._poolMinWorkers << " " << cgi._poolMaxWorkers;
+    }
     oss << "\n";
     return (oss);
 }
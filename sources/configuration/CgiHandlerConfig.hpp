@@ -10,10 +10,15 @@ private:
     int _timeoutSeconds;
     std::string _executablePath;
     std::string _storageRootPath;
+    std::string _fastCgiSocketPath;  // NOTE: set: sent to a FastCGI responder instead of forked
+    int _poolMinWorkers;
+    int _poolMaxWorkers;  // NOTE: 0: a fork of the server per request
 
     // TODO 16: much more here
 
 public:
+    static const int MAX_POOL_WORKERS = 64;
+
     CgiHandlerConfig();
     CgiHandlerConfig(const CgiHandlerConfig& other);
     CgiHandlerConfig& operator=(const CgiHandlerConfig& other);
@@ -22,6 +27,13 @@ public:
     std::string getExtension() const;
     int getTimeoutSeconds() const;
     std::string getExecutablePath() const;
+    bool isFastCgi() const;
+    std::string getFastCgiSocketPath() const;
+    CgiHandlerConfig& setFastCgiSocketPath(const std::string& socketPath);
+    bool hasWorkerPool() const;
+    int getPoolMinWorkers() const;
+    int getPoolMaxWorkers() const;
+    CgiHandlerConfig& setWorkerPool(int minWorkers, int maxWorkers);
     ~CgiHandlerConfig();
 
     bool operator==(const CgiHandlerConfig& other) const;
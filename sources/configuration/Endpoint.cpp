@@ -8,12 +8,15 @@
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "configuration/CgiHandlerConfig.hpp"
 #include "configuration/RouteConfig.hpp"
 #include "configuration/parser/ConfigParsingException.hpp"
 #include "http_status/HttpStatus.hpp"
 #include "logger/Logger.hpp"
+#include "utils/StringView.hpp"
+#include "utils/utils.hpp"
 
 using std::map;
 using std::ostream;
@@ -30,37 +33,57 @@ size_t Endpoint::defaultMaxClientBodySizeBytes() {
     return (std::numeric_limits<std::streamsize>::max());
 }
 
+size_t Endpoint::defaultFileCacheSizeBytes() {
+    return (static_cast<size_t>(8 * utils::MIB));
+}
+
 Endpoint::Endpoint()
     : _interface(DEFAULT_INTERFACE)
     , _port(DEFAULT_PORT)
-    , _serverName("")
+    , _serverNames()
+    , _isDefaultServer(false)
     , _rootDirectory(DEFAULT_ROOT)
     , _maxClientBodySizeBytes(defaultMaxClientBodySizeBytes())
+    , _keepAliveTimeoutSeconds(DEFAULT_KEEPALIVE_TIMEOUT_SECONDS)
+    , _keepAliveMaxRequests(DEFAULT_KEEPALIVE_MAX_REQUESTS)
+    , _fileCacheSizeBytes(defaultFileCacheSizeBytes())
     , _cgiHandlers()
     , _routes()
+    , _routeTrie()
     , _statusCatalogue() {
 }
 
 Endpoint::Endpoint(const std::string& interface, int port)
     : _interface(interface)
     , _port(port)
-    , _serverName("")
+    , _serverNames()
+    , _isDefaultServer(false)
     , _rootDirectory(DEFAULT_ROOT)
     , _maxClientBodySizeBytes(defaultMaxClientBodySizeBytes())
+    , _keepAliveTimeoutSeconds(DEFAULT_KEEPALIVE_TIMEOUT_SECONDS)
+    , _keepAliveMaxRequests(DEFAULT_KEEPALIVE_MAX_REQUESTS)
+    , _fileCacheSizeBytes(defaultFileCacheSizeBytes())
     , _cgiHandlers()
     , _routes()
+    , _routeTrie()
     , _statusCatalogue() {
 }
 
 Endpoint::Endpoint(const Endpoint& other)
     : _interface(other._interface)
     , _port(other._port)
-    , _serverName(other._serverName)
+    , _serverNames(other._serverNames)
+    , _isDefaultServer(other._isDefaultServer)
     , _rootDirectory(other._rootDirectory)
     , _maxClientBodySizeBytes(other._maxClientBodySizeBytes)
+    , _keepAliveTimeoutSeconds(other._keepAliveTimeoutSeconds)
+    , _keepAliveMaxRequests(other._keepAliveMaxRequests)
+    , _fileCacheSizeBytes(other._fileCacheSizeBytes)
     , _cgiHandlers()
     , _routes(other._routes)
+    , _routeTrie()
     , _statusCatalogue(other._statusCatalogue) {
+    rebuildRouteTrie();
     for (map<std::string, CgiHandlerConfig*>::const_iterator it = other._cgiHandlers.begin();
          it != other._cgiHandlers.end();
          ++it) {
@@ -92,10 +115,15 @@ Endpoint& Endpoint::operator=(const Endpoint& other) {
 
     _interface = other._interface;
     _port = other._port;
-    _serverName = other._serverName;
+    _serverNames = other._serverNames;
+    _isDefaultServer = other._isDefaultServer;
     _rootDirectory = other._rootDirectory;
     _maxClientBodySizeBytes = other._maxClientBodySizeBytes;
+    _keepAliveTimeoutSeconds = other._keepAliveTimeoutSeconds;
+    _keepAliveMaxRequests = other._keepAliveMaxRequests;
+    _fileCacheSizeBytes = other._fileCacheSizeBytes;
     _routes = other._routes;
+    rebuildRouteTrie();
     _statusCatalogue = other._statusCatalogue;
 
     return (*this);
@@ -127,7 +155,7 @@ bool Endpoint::operator==(const Endpoint& other) const {
     if (_port != other._port) {
         return (false);
     }
-    if (_serverName != other._serverName) {
+    if (_serverNames != other._serverNames || _isDefaultServer != other._isDefaultServer) {
         return (false);
     }
     if (_rootDirectory != other._rootDirectory) {
@@ -136,6 +164,13 @@ bool Endpoint::operator==(const Endpoint& other) const {
     if (_maxClientBodySizeBytes != other._maxClientBodySizeBytes) {
         return (false);
     }
+    if (_keepAliveTimeoutSeconds != other._keepAliveTimeoutSeconds ||
+        _keepAliveMaxRequests != other._keepAliveMaxRequests) {
+        return (false);
+    }
+    if (_fileCacheSizeBytes != other._fileCacheSizeBytes) {
+        return (false);
+    }
 
     if (_cgiHandlers.size() != other._cgiHandlers.size()) {
         return (false);
@@ -192,10 +227,23 @@ Endpoint& Endpoint::setPort(const int& port) {
 }
 
 Endpoint& Endpoint::addServerName(const string& name) {
-    _serverName = name;
+    _serverNames.push_back(name);
+    return (*this);
+}
+
+const std::vector<string>& Endpoint::getServerNames() const {
+    return (_serverNames);
+}
+
+Endpoint& Endpoint::setDefaultServer(bool isDefault) {
+    _isDefaultServer = isDefault;
     return (*this);
 }
 
+bool Endpoint::isDefaultServer() const {
+    return (_isDefaultServer);
+}
+
 Endpoint& Endpoint::setRoot(const string& path) {
     _rootDirectory = path;
     return (*this);
@@ -210,6 +258,33 @@ Endpoint& Endpoint::setMaxClientBodySizeBytes(size_t size) {
     return (*this);
 }
 
+Endpoint& Endpoint::setKeepAliveTimeoutSeconds(int seconds) {
+    _keepAliveTimeoutSeconds = seconds;
+    return (*this);
+}
+
+int Endpoint::getKeepAliveTimeoutSeconds() const {
+    return (_keepAliveTimeoutSeconds);
+}
+
+Endpoint& Endpoint::setKeepAliveMaxRequests(int requests) {
+    _keepAliveMaxRequests = requests;
+    return (*this);
+}
+
+int Endpoint::getKeepAliveMaxRequests() const {
+    return (_keepAliveMaxRequests);
+}
+
+Endpoint& Endpoint::setFileCacheSizeBytes(size_t size) {
+    _fileCacheSizeBytes = size;
+    return (*this);
+}
+
+size_t Endpoint::getFileCacheSizeBytes() const {
+    return (_fileCacheSizeBytes);
+}
+
 Endpoint& Endpoint::addCgiHandler(const CgiHandlerConfig& config, string extension) {
     _cgiHandlers[extension] = new CgiHandlerConfig(config);
     return (*this);
@@ -223,9 +298,17 @@ Endpoint& Endpoint::addRoute(RouteConfig route) {
             "Duplicate location path '" + route.getPath() + "' in server block"
         );
     }
+    _routeTrie.insert(*result.first);
     return (*this);
 }
 
+void Endpoint::rebuildRouteTrie() {
+    _routeTrie.clear();
+    for (set<RouteConfig>::const_iterator itr = _routes.begin(); itr != _routes.end(); ++itr) {
+        _routeTrie.insert(*itr);
+    }
+}
+
 const set<RouteConfig>& Endpoint::getRoutes() const {
     return (_routes);
 }
@@ -235,7 +318,7 @@ string Endpoint::getRoot() const {
 }
 
 string Endpoint::getServerName() const {
-    return (_serverName);
+    return (_serverNames.empty() ? "" : _serverNames[0]);
 }
 
 const RouteConfig& Endpoint::getRoute(std::string route) const {
@@ -247,31 +330,12 @@ const RouteConfig& Endpoint::getRoute(std::string route) const {
     throw std::out_of_range("Route not found");
 }
 
-const RouteConfig& Endpoint::selectRoute(std::string route) const {
-    set<RouteConfig>::const_iterator bestMatch = _routes.end();
-    size_t bestLength = 0;
-    Logger log;
-    for (set<RouteConfig>::const_iterator itr = _routes.begin(); itr != _routes.end(); ++itr) {
-        const string candidate = itr->getPath();
-        if (candidate == "/" && bestLength == 0) {
-            bestMatch = itr;
-            bestLength = 1;
-            continue;
-        }
-        log.stream(LOG_TRACE) << "matching " << candidate << "\n";
-        if (route == candidate ||
-            (route.substr(0, candidate.length()) == candidate &&
-             route.length() > candidate.length() && route.at(candidate.length()) == '/')) {
-            if (itr->getPath().length() > bestLength) {
-                bestMatch = itr;
-                bestLength = itr->getPath().length();
-            }
-        }
-    }
-    if (bestLength == 0) {
+const RouteConfig& Endpoint::selectRoute(const StringView& path) const {
+    const RouteConfig* route = _routeTrie.match(path);
+    if (route == NULL) {
         throw std::out_of_range("Route not found; is there a root location in the configuration?");
     }
-    return (*bestMatch);
+    return (*route);
 }
 
 const std::map<std::string, CgiHandlerConfig*>& Endpoint::getCgiHandlers() const {
@@ -292,6 +356,14 @@ Endpoint& Endpoint::setStatusPage(int code, const std::string& pageFileLocation)
     return (*this);
 }
 
+void Endpoint::renderStatusPages() const {
+    _statusCatalogue.renderPages();
+    for (std::set<RouteConfig>::const_iterator itr = _routes.begin(); itr != _routes.end();
+         itr++) {
+        itr->getStatusCatalogue().renderPages();
+    }
+}
+
 bool Endpoint::isAValidPort(int port) {
     return (port >= MIN_PORT && port <= MAX_PORT);
 }
@@ -299,9 +371,17 @@ bool Endpoint::isAValidPort(int port) {
 ostream& operator<<(ostream& oss, const Endpoint& endpoint) {
     oss << endpoint._interface;
     oss << " " << endpoint._port;
-    oss << " " << endpoint._serverName;
+    for (size_t i = 0; i < endpoint._serverNames.size(); ++i) {
+        oss << " " << endpoint._serverNames[i];
+    }
+    if (endpoint._isDefaultServer) {
+        oss << " default_server";
+    }
     oss << " " << endpoint._rootDirectory;
     oss << " " << endpoint._maxClientBodySizeBytes;
+    oss << " keepalive " << endpoint._keepAliveTimeoutSeconds << "s/"
+        << endpoint._keepAliveMaxRequests;
+    oss << " file cache " << endpoint._fileCacheSizeBytes;
     oss << "\n";
     for (map<string, CgiHandlerConfig*>::const_iterator itr = endpoint._cgiHandlers.begin();
          itr != endpoint._cgiHandlers.end();
@@ -3,32 +3,45 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "configuration/CgiHandlerConfig.hpp"
 #include "configuration/RouteConfig.hpp"
+#include "configuration/RouteTrie.hpp"
 #include "configuration/UploadConfig.hpp"
 #include "http_status/HttpStatus.hpp"
+#include "utils/StringView.hpp"
 
 namespace webserver {
 class Endpoint {
 private:
     std::string _interface;
     int _port;
-    std::string _serverName;
+    std::vector<std::string> _serverNames;  // NOTE: exact, "*.suffix" or "prefix.*"
+    bool _isDefaultServer;  // NOTE: answers requests to its address that no server_name matches
     std::string _rootDirectory;
     size_t _maxClientBodySizeBytes;
+    int _keepAliveTimeoutSeconds;  // NOTE: 0 disables keep-alive
+    int _keepAliveMaxRequests;
+    size_t _fileCacheSizeBytes;  // NOTE: 0 disables the static file cache
     std::map<std::string, CgiHandlerConfig*> _cgiHandlers;
     std::set<RouteConfig> _routes;
+    RouteTrie _routeTrie;  // NOTE: points into _routes, rebuilt whenever they are copied
     HttpStatus _statusCatalogue;
 
     static const int MIN_PORT = 1;
     static const int MAX_PORT = 65535;
 
+    void rebuildRouteTrie();
+
 public:
     static const std::string DEFAULT_INTERFACE;
     static const int DEFAULT_PORT;
     static size_t defaultMaxClientBodySizeBytes();
+    static size_t defaultFileCacheSizeBytes();
     static const std::string DEFAULT_ROOT;
+    static const int DEFAULT_KEEPALIVE_TIMEOUT_SECONDS = 15;
+    static const int DEFAULT_KEEPALIVE_MAX_REQUESTS = 100;
 
     Endpoint();
     Endpoint(const std::string& interface, int port);
@@ -42,20 +55,30 @@ public:
     const HttpStatus& getStatusCatalogue() const;
     Endpoint& setStatusCatalogue(const HttpStatus& statusCatalogue);
     Endpoint& setStatusPage(int code, const std::string& pageFileLocation);
+    void renderStatusPages() const;  // NOTE: of the server and of each of its locations
     Endpoint& setInterface(std::string interface);
     Endpoint& setPort(const int& port);
     Endpoint& setRoot(const std::string& path);
     Endpoint& setMaxClientBodySizeBytes(size_t size);
     size_t getMaxClientBodySizeBytes() const;
+    Endpoint& setKeepAliveTimeoutSeconds(int seconds);
+    int getKeepAliveTimeoutSeconds() const;
+    Endpoint& setKeepAliveMaxRequests(int requests);
+    int getKeepAliveMaxRequests() const;
+    Endpoint& setFileCacheSizeBytes(size_t size);
+    size_t getFileCacheSizeBytes() const;
     Endpoint& addServerName(const std::string& name);
     Endpoint& addCgiHandler(const CgiHandlerConfig& config, std::string extension);
     Endpoint& addRoute(RouteConfig route);
     std::string getInterface() const;
     std::string getRoot() const;
-    std::string getServerName() const;
+    std::string getServerName() const;  // NOTE: the first one, empty if there is none
+    const std::vector<std::string>& getServerNames() const;
+    Endpoint& setDefaultServer(bool isDefault);
+    bool isDefaultServer() const;
     int getPort() const;
     const RouteConfig& getRoute(std::string route) const;
-    const RouteConfig& selectRoute(std::string route) const;
+    const RouteConfig& selectRoute(const StringView& path) const;
     const std::set<RouteConfig>& getRoutes() const;
     const std::map<std::string, CgiHandlerConfig*>& getCgiHandlers() const;
 
@@ -30,6 +30,7 @@ RouteConfig::RouteConfig()
     , _folderConfigSection()
     , _uploadConfigSection()
     , _cgiHandlers()
+    , _isCompressionEnabled(false)
     , _statusCatalogue() {
 }
 
@@ -40,6 +41,7 @@ RouteConfig::RouteConfig(const RouteConfig& other)
     , _redirectTo(other._redirectTo)
     , _folderConfigSection(other._folderConfigSection)
     , _uploadConfigSection(other._uploadConfigSection)
+    , _isCompressionEnabled(other._isCompressionEnabled)
     , _statusCatalogue(other._statusCatalogue) {
     for (std::map<std::string, CgiHandlerConfig*>::const_iterator it = other._cgiHandlers.begin();
          it != other._cgiHandlers.end();
@@ -58,6 +60,7 @@ RouteConfig& RouteConfig::operator=(const RouteConfig& other) {
     _redirectTo = other._redirectTo;
     _folderConfigSection = other._folderConfigSection;
     _uploadConfigSection = other._uploadConfigSection;
+    _isCompressionEnabled = other._isCompressionEnabled;
     _statusCatalogue = other._statusCatalogue;
 
     for (std::map<std::string, CgiHandlerConfig*>::iterator it = _cgiHandlers.begin();
@@ -133,6 +136,9 @@ bool RouteConfig::operator==(const RouteConfig& other) const {
     if (!compareCgiHandlers(other)) {
         return (false);
     }
+    if (_isCompressionEnabled != other._isCompressionEnabled) {
+        return (false);
+    }
     if (_statusCatalogue != other._statusCatalogue) {
         return (false);
     }
@@ -205,6 +211,15 @@ string RouteConfig::getPath() const {
     return (_path);
 }
 
+RouteConfig& RouteConfig::setCompression(bool isEnabled) {
+    _isCompressionEnabled = isEnabled;
+    return (*this);
+}
+
+bool RouteConfig::isCompressionEnabled() const {
+    return (_isCompressionEnabled);
+}
+
 RouteConfig& RouteConfig::setStatusCatalogue(const HttpStatus& statusCatalogue) {
     Logger log;
     log.stream(LOG_TRACE) << "RouteConfig " << this << " set statusCatalogue = " << &statusCatalogue
@@ -231,6 +246,7 @@ ostream& operator<<(ostream& oss, const RouteConfig& route) {
     }
     oss << "\n";
     oss << route._isRedirection << " " << route._redirectTo << "\n";
+    oss << "compression " << route._isCompressionEnabled << "\n";
     oss << route._folderConfigSection;
     oss << route._uploadConfigSection;
     oss << "\n";
@@ -21,6 +21,7 @@ private:
     FolderConfig _folderConfigSection;
     UploadConfig _uploadConfigSection;
     std::map<std::string, CgiHandlerConfig*> _cgiHandlers;  // NOTE: extension:config
+    bool _isCompressionEnabled;  // NOTE: Content-Encoding for static files, off by default
     bool compareCgiHandlers(const RouteConfig& other) const;
     HttpStatus _statusCatalogue;
     // NOTE: yes, this is a duplicate from Endpoint, I spent too much time trying to optimize this
@@ -47,6 +48,8 @@ public:
     RouteConfig& addCgiHandler(const CgiHandlerConfig& cfg, std::string extension);
     std::string getPath() const;
     const std::map<std::string, CgiHandlerConfig*>& getCgiHandlers() const;
+    RouteConfig& setCompression(bool isEnabled);
+    bool isCompressionEnabled() const;
     const HttpStatus& getStatusCatalogue() const;
     RouteConfig& setStatusCatalogue(const HttpStatus& statusCatalogue);
     const std::string& getStatusPageFileLocation(HttpStatus::CODE code) const;
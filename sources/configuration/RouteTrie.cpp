@@ -0,0 +1,114 @@
+#include "RouteTrie.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "configuration/RouteConfig.hpp"
+#include "utils/StringView.hpp"
+
+using std::string;
+using std::vector;
+
+namespace webserver {
+const size_t RouteTrie::NO_NODE = static_cast<size_t>(-1);
+
+RouteTrie::RouteTrie() {
+    clear();
+}
+
+RouteTrie::~RouteTrie() {
+}
+
+void RouteTrie::clear() {
+    _nodes.clear();
+    Node root;
+    root.route = NULL;
+    _nodes.push_back(root);
+}
+
+size_t RouteTrie::segmentEnd(const StringView& path, size_t begin) {
+    const size_t slash = path.find('/', begin);
+    return (slash == StringView::npos ? path.size() : slash);
+}
+
+void RouteTrie::insert(const RouteConfig& route) {
+    const string& path = route.getPath();
+    if (path == "/") {
+        _nodes[0].route = &route;
+        return;
+    }
+    size_t node = 0;
+    size_t begin = 0;
+    while (true) {
+        const size_t end = segmentEnd(path, begin);
+        size_t child = findChild(node, path, begin, end);
+        if (child == NO_NODE) {
+            child = addChild(node, path.substr(begin, end - begin));
+        }
+        node = child;
+        if (end == path.size()) {
+            break;
+        }
+        begin = end + 1;
+    }
+    _nodes[node].route = &route;
+}
+
+const RouteConfig* RouteTrie::match(const StringView& path) const {
+    const RouteConfig* best = _nodes[0].route;
+    size_t node = 0;
+    size_t begin = 0;
+    while (true) {
+        const size_t end = segmentEnd(path, begin);
+        node = findChild(node, path, begin, end);
+        if (node == NO_NODE) {
+            break;
+        }
+        if (_nodes[node].route != NULL) {
+            best = _nodes[node].route;
+        }
+        if (end == path.size()) {
+            break;
+        }
+        begin = end + 1;
+    }
+    return (best);
+}
+
+size_t RouteTrie::findChild(size_t node, const StringView& path, size_t begin, size_t end) const {
+    const vector<Edge>& children = _nodes[node].children;
+    const StringView segment = path.substr(begin, end - begin);
+    size_t low = 0;
+    size_t high = children.size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const int cmp = StringView(children[mid].segment).compare(segment);
+        if (cmp == 0) {
+            return (children[mid].child);
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return (NO_NODE);
+}
+
+size_t RouteTrie::addChild(size_t node, const string& segment) {
+    Node child;
+    child.route = NULL;
+    _nodes.push_back(child);
+    Edge edge;
+    edge.segment = segment;
+    edge.child = _nodes.size() - 1;
+    vector<Edge>& children = _nodes[node].children;
+    vector<Edge>::iterator pos = children.begin();
+    while (pos != children.end() && pos->segment < segment) {
+        ++pos;
+    }
+    children.insert(pos, edge);
+    return (edge.child);
+}
+}  // namespace webserver
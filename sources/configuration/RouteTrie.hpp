@@ -0,0 +1,51 @@
+#ifndef ROUTETRIE_HPP
+#define ROUTETRIE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "configuration/RouteConfig.hpp"
+#include "utils/StringView.hpp"
+
+namespace webserver {
+/* NOTE: the locations of one server, split into path segments at load time.
+* a location matches a request path equal to it or continuing it after a '/',
+* so the longest match is the last location met walking the request path down the trie,
+* one segment compare per level, no copies of the path.
+* the "/" location sits in the root and catches whatever matches nothing longer.
+*/
+class RouteTrie {
+public:
+    RouteTrie();
+    ~RouteTrie();
+
+    void insert(const RouteConfig& route);  // NOTE: kept by address, must outlive the trie
+    void clear();
+    const RouteConfig* match(const StringView& path) const;  // NOTE: NULL if nothing matches
+
+private:
+    struct Edge {
+        std::string segment;
+        size_t child;
+    };
+
+    struct Node {
+        const RouteConfig* route;
+        std::vector<Edge> children;  // NOTE: sorted by segment
+    };
+
+    static const size_t NO_NODE;
+
+    std::vector<Node> _nodes;  // NOTE: [0] is the root
+
+    size_t findChild(size_t node, const StringView& path, size_t begin, size_t end) const;
+    size_t addChild(size_t node, const std::string& segment);
+    static size_t segmentEnd(const StringView& path, size_t begin);
+
+    RouteTrie(const RouteTrie& other);
+    RouteTrie& operator=(const RouteTrie& other);
+};
+}  // namespace webserver
+
+#endif
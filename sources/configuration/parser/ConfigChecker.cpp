@@ -6,6 +6,7 @@
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "configuration/CgiHandlerConfig.hpp"
 #include "configuration/Endpoint.hpp"
@@ -15,6 +16,7 @@
 #include "configuration/parser/ConfigParsingException.hpp"
 #include "file_system/FileSystem.hpp"
 #include "logger/Logger.hpp"
+#include "utils/utils.hpp"
 
 using std::string;
 
@@ -130,6 +132,9 @@ void ConfigChecker::checkCgiExecutable(const std::map<std::string, CgiHandlerCon
     for (std::map<std::string, CgiHandlerConfig*>::const_iterator it = cgiHandlers.begin();
          it != cgiHandlers.end();
          ++it) {
+        if (it->second->isFastCgi()) {
+            continue;  // NOTE: the responder may well start after us, its socket is not checked
+        }
         const string& execPath = it->second->getExecutablePath();
 
         if (!file_system::isExecutableFile(execPath.c_str())) {
@@ -193,21 +198,34 @@ void ConfigChecker::checkValueTypes(const Endpoint& endpoint) {
     }
 }
 
-void ConfigChecker::checkNoDuplicateEndpoints(const std::set<Endpoint*>& endpoints) {
-    std::set<std::pair<std::string, int> > seenBindings;
+void ConfigChecker::checkNoDuplicateServerNames(const std::set<Endpoint*>& endpoints) {
+    std::set<std::pair<std::string, std::string> > seenNames;
 
     for (std::set<Endpoint*>::const_iterator it = endpoints.begin(); it != endpoints.end(); ++it) {
-        const std::string& interface = (*it)->getInterface();
-        const int port = (*it)->getPort();
-        const std::pair<std::string, int> binding(interface, port);
-
-        if (seenBindings.find(binding) != seenBindings.end()) {
-            std::ostringstream oss;
-            oss << "Duplicate server block with listen directive '" << interface << ":" << port
-                << "'";
-            throw ConfigParsingException(oss.str());
+        std::ostringstream address;
+        address << (*it)->getInterface() << ":" << (*it)->getPort();
+        std::vector<std::string> names = (*it)->getServerNames();
+        if (names.empty()) {
+            names.push_back("");  // NOTE: two nameless servers on one address clash as well
+        }
+        for (size_t i = 0; i < names.size(); ++i) {
+            const std::pair<std::string, std::string> binding(
+                address.str(),
+                utils::toLower(names[i])
+            );
+            if (seenNames.find(binding) != seenNames.end()) {
+                if (names[i].empty()) {
+                    throw ConfigParsingException(
+                        "Duplicate server block with listen directive '" + address.str() +
+                        "' and no server_name"
+                    );
+                }
+                throw ConfigParsingException(
+                    "Duplicate server_name '" + names[i] + "' for listen '" + address.str() + "'"
+                );
+            }
+            seenNames.insert(binding);
         }
-        seenBindings.insert(binding);
     }
 }
 
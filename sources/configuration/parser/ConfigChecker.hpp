@@ -26,7 +26,8 @@ public:
     ~ConfigChecker();
 
     static void checkEndpoint(Endpoint& endpoint);
-    static void checkNoDuplicateEndpoints(const std::set<Endpoint*>& endpoints);
+    // NOTE: servers may share an interface:port, but not a name on it
+    static void checkNoDuplicateServerNames(const std::set<Endpoint*>& endpoints);
 };
 }  // namespace webserver
 
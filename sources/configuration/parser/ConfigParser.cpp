@@ -3,13 +3,16 @@
 #include <cctype>
 #include <cerrno>
 #include <cstring>
+#include <stdexcept>
 #include <string>
 
 #include "configuration/AppConfig.hpp"
 #include "configuration/Endpoint.hpp"
 #include "configuration/parser/ConfigChecker.hpp"
 #include "configuration/parser/ConfigParsingException.hpp"
+#include "event_backend/EventBackend.hpp"
 #include "logger/Logger.hpp"
+#include "utils/utils.hpp"
 
 using std::string;
 
@@ -22,6 +25,7 @@ ConfigParser::~ConfigParser() {
 }
 
 AppConfig ConfigParser::parse(const string& filename) {
+    _explicitDefaultServers.clear();
     tokenize(filename);
     return (buildConfigTree());
 }
@@ -32,6 +36,9 @@ AppConfig ConfigParser::buildConfigTree() {
     }
 
     AppConfig appConfig;
+    bool eventBackendSet = false;
+    bool workerProcessesSet = false;
+    bool acceptBatchSet = false;
 
     while (!isEnd(_tokens, _index)) {
         const string token = _tokens[_index];
@@ -39,20 +46,83 @@ AppConfig ConfigParser::buildConfigTree() {
         if (token == "server") {
             _index++;
             parseServer(appConfig);
+        } else if (token == "event_backend") {
+            if (eventBackendSet) {
+                throw ConfigParsingException(
+                    "Duplicate 'event_backend' directive (only one allowed per file)"
+                );
+            }
+            parseEventBackend(appConfig);
+            eventBackendSet = true;
+        } else if (token == "worker_processes") {
+            if (workerProcessesSet) {
+                throw ConfigParsingException(
+                    "Duplicate 'worker_processes' directive (only one allowed per file)"
+                );
+            }
+            parseWorkerProcesses(appConfig);
+            workerProcessesSet = true;
+        } else if (token == "accept_batch") {
+            if (acceptBatchSet) {
+                throw ConfigParsingException(
+                    "Duplicate 'accept_batch' directive (only one allowed per file)"
+                );
+            }
+            parseAcceptBatch(appConfig);
+            acceptBatchSet = true;
         } else {
             throw ConfigParsingException("Unexpected token: " + token);
         }
     }
 
-    ConfigChecker::checkNoDuplicateEndpoints(appConfig.getEndpoints());
+    ConfigChecker::checkNoDuplicateServerNames(appConfig.getEndpoints());
     return (appConfig);
 }
 
+void ConfigParser::parseEventBackend(AppConfig& appConfig) {
+    _index++;
+    if (isEnd(_tokens, _index) || _tokens[_index] == ";") {
+        throw ConfigParsingException("Expected value after 'event_backend'");
+    }
+
+    const string value = _tokens[_index];
+    _index++;
+
+    if (isEnd(_tokens, _index) || _tokens[_index] != ";") {
+        throw ConfigParsingException("Missing ';' after event_backend directive");
+    }
+    _index++;
+
+    try {
+        appConfig.setEventBackend(stringToEventBackendType(value));
+    } catch (const std::out_of_range& e) {
+        throw ConfigParsingException(e.what());
+    }
+}
+
+void ConfigParser::parseWorkerProcesses(AppConfig& appConfig) {
+    const int count = parseIntegerArgument("worker_processes", 1);
+    if (count > AppConfig::MAX_WORKER_PROCESSES) {
+        throw ConfigParsingException(
+            "Too many worker_processes, the limit is " +
+            utils::toString(AppConfig::MAX_WORKER_PROCESSES)
+        );
+    }
+    appConfig.setWorkerProcesses(count);
+}
+
+void ConfigParser::parseAcceptBatch(AppConfig& appConfig) {
+    appConfig.setAcceptBatch(parseIntegerArgument("accept_batch", 1));
+}
+
 void ConfigParser::parseServer(AppConfig& appConfig) {
     Logger log;
     Endpoint server;
     bool listenSet = false;
     bool bodySizeSet = false;
+    bool keepAliveTimeoutSet = false;
+    bool keepAliveRequestsSet = false;
+    bool fileCacheSizeSet = false;
 
     if (_tokens[_index] != "{") {
         throw ConfigParsingException("Unexpected token: " + _tokens[_index]);
@@ -89,6 +159,30 @@ void ConfigParser::parseServer(AppConfig& appConfig) {
             }
             parseBodySize(server);
             bodySizeSet = true;
+        } else if (token == "keepalive_timeout") {
+            if (keepAliveTimeoutSet) {
+                throw ConfigParsingException(
+                    "Duplicate 'keepalive_timeout' directive (only one allowed per server block)"
+                );
+            }
+            parseKeepAliveTimeout(server);
+            keepAliveTimeoutSet = true;
+        } else if (token == "keepalive_requests") {
+            if (keepAliveRequestsSet) {
+                throw ConfigParsingException(
+                    "Duplicate 'keepalive_requests' directive (only one allowed per server block)"
+                );
+            }
+            parseKeepAliveRequests(server);
+            keepAliveRequestsSet = true;
+        } else if (token == "file_cache_size") {
+            if (fileCacheSizeSet) {
+                throw ConfigParsingException(
+                    "Duplicate 'file_cache_size' directive (only one allowed per server block)"
+                );
+            }
+            parseFileCacheSize(server);
+            fileCacheSizeSet = true;
         } else if (token == "error_page") {
             parseErrorPage(server);
         } else if (token == "cgi") {
@@ -101,6 +195,7 @@ void ConfigParser::parseServer(AppConfig& appConfig) {
             }
             _index++;
             webserver::ConfigChecker::checkEndpoint(server);
+            assignDefaultServer(appConfig, server);
             appConfig.addEndpoint(server);
             return;
         }
@@ -108,4 +203,32 @@ void ConfigParser::parseServer(AppConfig& appConfig) {
     throw ConfigParsingException("Unexpected end of file in server block (missing '}')");
 }
 
+/* NOTE: servers on one interface:port share a socket, one of them answers unknown Host names.
+* that is the first one declared, unless a later one says `listen ... default_server`
+*/
+void ConfigParser::assignDefaultServer(AppConfig& appConfig, Endpoint& server) {
+    const string address = server.getInterface() + ":" + utils::toString(server.getPort());
+    const bool isExplicit = server.isDefaultServer();
+    if (isExplicit && _explicitDefaultServers.find(address) != _explicitDefaultServers.end()) {
+        throw ConfigParsingException("Duplicate default_server for listen '" + address + "'");
+    }
+    const std::set<Endpoint*>& endpoints = appConfig.getEndpoints();
+    Endpoint* current = NULL;
+    for (std::set<Endpoint*>::const_iterator itr = endpoints.begin(); itr != endpoints.end();
+         ++itr) {
+        if ((*itr)->getInterface() == server.getInterface() &&
+            (*itr)->getPort() == server.getPort() && (*itr)->isDefaultServer()) {
+            current = *itr;
+        }
+    }
+    if (current == NULL) {
+        server.setDefaultServer(true);
+    } else if (isExplicit) {
+        current->setDefaultServer(false);
+    }
+    if (isExplicit) {
+        _explicitDefaultServers.insert(address);
+    }
+}
+
 }  // namespace webserver
@@ -1,10 +1,12 @@
 #ifndef CONFIGPARSER_HPP
 #define CONFIGPARSER_HPP
 
+#include <set>
 #include <string>
 #include <vector>
 
 #include "configuration/AppConfig.hpp"
+#include "configuration/CgiHandlerConfig.hpp"
 #include "configuration/Endpoint.hpp"
 #include "configuration/parser/LocationTempData.hpp"
 
@@ -15,17 +17,28 @@ private:
 
     std::vector<std::string> _tokens;
     size_t _index;
+    std::set<std::string> _explicitDefaultServers;  // NOTE: "interface:port" marked default_server
 
     void tokenize(const std::string& filename);
     AppConfig buildConfigTree();
     void parseServer(AppConfig& appConfig);
+    void assignDefaultServer(AppConfig& appConfig, Endpoint& server);
+    void parseEventBackend(AppConfig& appConfig);
+    void parseWorkerProcesses(AppConfig& appConfig);
+    void parseAcceptBatch(AppConfig& appConfig);
 
     void parseListen(Endpoint& server);
     void parseServerName(Endpoint& server);
     void parseRoot(Endpoint& server);
     void parseBodySize(Endpoint& server);
+    void parseKeepAliveTimeout(Endpoint& server);
+    void parseKeepAliveRequests(Endpoint& server);
+    void parseFileCacheSize(Endpoint& server);
     void parseErrorPage(Endpoint& server);
     void parseCgi(Endpoint& server);
+    CgiHandlerConfig parseCgiHandler(const std::string& execPath);
+    int parseCgiPoolSize(int minValue);
+    std::string parseFastCgiAddress();
     void parseLocation(Endpoint& server);
     void checkIfBodySizeSetAndParse(bool& bodySizeSet);
 
@@ -44,9 +57,12 @@ private:
     void parseLocationReturn(RouteConfig& route);
     void parseLocationUpload();
     void parseLocationCgi(RouteConfig& route);
+    void parseLocationCompression(RouteConfig& route, bool& compressionSet);
 
     static bool isEnd(const std::vector<std::string>& tokens, size_t index);
     static size_t parseSizeValue(const std::string& value);
+    static bool isValidServerName(const std::string& name);
+    int parseIntegerArgument(const std::string& directive, int minValue);
 
 public:
     ConfigParser();
@@ -27,6 +27,10 @@ void ConfigParser::parseListen(Endpoint& server) {
     const string value = _tokens[_index];
     _index++;
 
+    if (!isEnd(_tokens, _index) && _tokens[_index] == "default_server") {
+        server.setDefaultServer(true);
+        _index++;
+    }
     if (isEnd(_tokens, _index) || _tokens[_index] != ";") {
         throw ConfigParsingException("Missing ';' after listen directive");
     }
@@ -62,37 +66,46 @@ void ConfigParser::parseListen(Endpoint& server) {
     server.setPort(port);
 }
 
+// NOTE: a '*' is only allowed as a whole first or last label: "*.example.com", "www.example.*"
+bool ConfigParser::isValidServerName(const string& name) {
+    const size_t star = name.find('*');
+    if (star == string::npos) {
+        return (true);
+    }
+    if (name.find('*', star + 1) != string::npos || name.size() < 3) {
+        return (false);
+    }
+    if (star == 0) {
+        return (name[1] == '.');
+    }
+    return (star == name.size() - 1 && name[star - 1] == '.');
+}
+
 void ConfigParser::parseServerName(Endpoint& server) {
     _index++;
 
     if (isEnd(_tokens, _index) || _tokens[_index] == ";") {
         throw ConfigParsingException("Expected a name after 'server_name'");
     }
+    if (!server.getServerNames().empty()) {
+        throw ConfigParsingException(
+            "Duplicate server_name directive (only one allowed per server block)"
+        );
+    }
 
-    std::string name;
-
-    name = _tokens[_index];
-
-    _index++;
+    while (!isEnd(_tokens, _index) && _tokens[_index] != ";") {
+        const string name = _tokens[_index];
+        if (!isValidServerName(name)) {
+            throw ConfigParsingException("Invalid server_name: " + name);
+        }
+        server.addServerName(name);
+        _index++;
+    }
 
     if (isEnd(_tokens, _index)) {
         throw ConfigParsingException("Missing ';' after server_name directive");
     }
-
     _index++;
-
-    if (name.empty()) {
-        throw ConfigParsingException("No server_name value provided");
-    }
-
-    const string existingName = server.getServerName();
-    if (!existingName.empty()) {
-        throw ConfigParsingException(
-            "Duplicate server_name directive (only one allowed per server block)"
-        );
-    }
-
-    server.addServerName(name);
 }
 
 void ConfigParser::parseRoot(Endpoint& server) {
@@ -158,6 +171,57 @@ void ConfigParser::parseBodySize(Endpoint& server) {
     server.setMaxClientBodySizeBytes(size);
 }
 
+void ConfigParser::parseFileCacheSize(Endpoint& server) {
+    _index++;
+    if (isEnd(_tokens, _index) || _tokens[_index] == ";") {
+        throw ConfigParsingException("Expected value after 'file_cache_size'");
+    }
+
+    const string value = _tokens[_index];
+    _index++;
+
+    if (isEnd(_tokens, _index) || _tokens[_index] != ";") {
+        throw ConfigParsingException("Missing ';' after file_cache_size");
+    }
+
+    _index++;
+
+    // NOTE: 0 turns the cache off, any other size goes by the client_max_body_size rules
+    server.setFileCacheSizeBytes(value == "0" ? 0 : parseSizeValue(value));
+}
+
+int ConfigParser::parseIntegerArgument(const string& directive, int minValue) {
+    _index++;
+    if (isEnd(_tokens, _index) || _tokens[_index] == ";") {
+        throw ConfigParsingException("Expected value after '" + directive + "'");
+    }
+
+    const string value = _tokens[_index];
+    _index++;
+
+    if (isEnd(_tokens, _index) || _tokens[_index] != ";") {
+        throw ConfigParsingException("Missing ';' after " + directive + " directive");
+    }
+    _index++;
+
+    int num;
+    istringstream iss(value);
+    iss >> num;
+    if (iss.fail() || !iss.eof() || num < minValue) {
+        throw ConfigParsingException("Invalid value for " + directive + ": " + value);
+    }
+    return (num);
+}
+
+void ConfigParser::parseKeepAliveTimeout(Endpoint& server) {
+    // NOTE: 0 turns keep-alive off, like in nginx
+    server.setKeepAliveTimeoutSeconds(parseIntegerArgument("keepalive_timeout", 0));
+}
+
+void ConfigParser::parseKeepAliveRequests(Endpoint& server) {
+    server.setKeepAliveMaxRequests(parseIntegerArgument("keepalive_requests", 1));
+}
+
 void ConfigParser::parseErrorPage(Endpoint& server) {
     _index++;
 
@@ -233,14 +297,71 @@ void ConfigParser::parseCgi(Endpoint& server) {
 
     _index++;
 
+    const CgiHandlerConfig config = parseCgiHandler(execPath);
+
     if (isEnd(_tokens, _index) || _tokens[_index] != ";") {
         throw ConfigParsingException("Missing ';' after cgi directive");
     }
 
     _index++;
 
-    const CgiHandlerConfig config(30, execPath);
-
     server.addCgiHandler(config, extension);
 }
+
+/* NOTE: what follows the extension in a cgi directive, the first token already consumed:
+* `/usr/bin/python3`, `/usr/bin/python3 pool 2 8` or `fastcgi unix:/path/to/socket`
+*/
+CgiHandlerConfig ConfigParser::parseCgiHandler(const string& execPath) {
+    if (execPath == "fastcgi") {
+        CgiHandlerConfig config(30, "");
+        config.setFastCgiSocketPath(parseFastCgiAddress());
+        return (config);
+    }
+    CgiHandlerConfig config(30, execPath);
+    if (!isEnd(_tokens, _index) && _tokens[_index] == "pool") {
+        _index++;
+        const int minWorkers = parseCgiPoolSize(0);
+        const int maxWorkers = parseCgiPoolSize(1);
+        if (minWorkers > maxWorkers) {
+            throw ConfigParsingException(
+                "CGI pool minimum " + utils::toString(minWorkers) + " exceeds its maximum " +
+                utils::toString(maxWorkers)
+            );
+        }
+        config.setWorkerPool(minWorkers, maxWorkers);
+    }
+    return (config);
+}
+
+int ConfigParser::parseCgiPoolSize(int minValue) {
+    if (isEnd(_tokens, _index) || _tokens[_index] == ";") {
+        throw ConfigParsingException("Expected minimum and maximum worker counts after 'pool'");
+    }
+    const string value = _tokens[_index];
+    _index++;
+    int num;
+    istringstream iss(value);
+    iss >> num;
+    if (iss.fail() || !iss.eof() || num < minValue || num > CgiHandlerConfig::MAX_POOL_WORKERS) {
+        throw ConfigParsingException("Invalid CGI pool size: " + value);
+    }
+    return (num);
+}
+
+// NOTE: `fastcgi unix:/path/to/socket`, the keyword itself already consumed
+string ConfigParser::parseFastCgiAddress() {
+    const string unixPrefix = "unix:";
+    if (isEnd(_tokens, _index) || _tokens[_index] == ";") {
+        throw ConfigParsingException("Expected FastCGI responder address after 'fastcgi'");
+    }
+    const string address = _tokens[_index];
+    if (address.compare(0, unixPrefix.size(), unixPrefix) != 0 ||
+        address.size() == unixPrefix.size()) {
+        throw ConfigParsingException(
+            "Invalid FastCGI responder address (only unix:/path sockets are supported): " + address
+        );
+    }
+    _index++;
+    return (address.substr(unixPrefix.size()));
+}
 }  // namespace webserver
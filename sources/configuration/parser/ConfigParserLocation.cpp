@@ -55,6 +55,7 @@ void ConfigParser::parseLocation(Endpoint& server) {
     Logger log;
     _index++;
     bool bodySizeSet = false;
+    bool compressionSet = false;
 
     if (isEnd(_tokens, _index) || _tokens[_index] == ";" || _tokens[_index] == "{") {
         throw ConfigParsingException("Expected path after 'location'");
@@ -100,6 +101,8 @@ void ConfigParser::parseLocation(Endpoint& server) {
             parseLocationUpload();
         } else if (token == "cgi") {
             parseLocationCgi(route);
+        } else if (token == "compression") {
+            parseLocationCompression(route, compressionSet);
         } else if (token != "}") {
             throw ConfigParsingException("Unexpected token in location block: " + token);
         } else {
@@ -159,6 +162,32 @@ void ConfigParser::parseLocationRoot() {
     _index++;
 }
 
+void ConfigParser::parseLocationCompression(RouteConfig& route, bool& compressionSet) {
+    if (compressionSet) {
+        throw ConfigParsingException("Duplicate 'compression' directive in location block");
+    }
+    _index++;
+
+    if (isEnd(_tokens, _index) || _tokens[_index] == ";") {
+        throw ConfigParsingException("Expected 'on' or 'off' after compression");
+    }
+
+    const std::string val = _tokens[_index++];
+
+    if (val == "on") {
+        route.setCompression(true);
+    } else if (val != "off") {
+        throw ConfigParsingException("compression must be on/off");
+    }
+
+    if (isEnd(_tokens, _index) || _tokens[_index] != ";") {
+        throw ConfigParsingException("Missing ';' after compression");
+    }
+
+    _index++;
+    compressionSet = true;
+}
+
 void ConfigParser::parseLocationAutoindex() {
     _index++;
 
@@ -318,13 +347,14 @@ void ConfigParser::parseLocationCgi(RouteConfig& route) {
 
     _index++;
 
+    const CgiHandlerConfig cfg = parseCgiHandler(execPath);
+
     if (isEnd(_tokens, _index) || _tokens[_index] != ";") {
         throw ConfigParsingException("Missing ';' after cgi directive in location");
     }
 
     _index++;
 
-    const CgiHandlerConfig cfg(30, execPath);
     route.addCgiHandler(cfg, ext);
 }
 }  // namespace webserver
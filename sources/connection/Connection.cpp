@@ -6,37 +6,39 @@
 #include <stdint.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <cstring>
 #include <exception>
 #include <iostream>
 #include <map>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 
 #include "cgi_handler/CgiHandler.hpp"
+#include "cgi_handler/CgiProcessManager.hpp"
 #include "configuration/CgiHandlerConfig.hpp"
 #include "configuration/Endpoint.hpp"
 #include "http_methods/HttpMethodType.hpp"
-#include "http_status/BadRequest.hpp"
 #include "http_status/HttpException.hpp"
 #include "http_status/HttpStatus.hpp"
-#include "http_status/IncompleteRequest.hpp"
-#include "http_status/MethodNotAllowed.hpp"
 #include "logger/Logger.hpp"
+#include "request/BodySink.hpp"
 #include "request/Request.hpp"
+#include "request/RequestParser.hpp"
+#include "request_handler/PostHandler.hpp"
 #include "request_handler/RequestHandler.hpp"
 #include "response/Response.hpp"
+#include "utils/StringView.hpp"
+#include "utils/utils.hpp"
 
 using std::exception;
-using std::ostringstream;
-using std::runtime_error;
 using std::string;
-using std::stringstream;
 
 namespace {
+const string NO_BODY;
+
 void clean(char* buffer, size_t size) {
     for (size_t i = 0; i < size; i++) {
         buffer[i] = 0;
@@ -48,25 +50,32 @@ namespace webserver {
 
 Logger Connection::_log;
 
-Connection::Connection(int listeningSocketFd, const Endpoint& configuration)
+Connection::Connection(const VirtualHosts& virtualHosts)
     : _state(NEWBORN)
+    , _clientSocketFd(-1)
+    , _responseBufferSent(0)
+    , _parser(_request)
     , _isRequestValid(false)
+    , _rejectionStatus(HttpStatus::BAD_REQUEST)
     , _clientIp(0)
     , _clientPort(0)
-    , _configuration(configuration)
-    , _route(NULL) {
+    , _virtualHosts(virtualHosts)
+    , _configuration(virtualHosts.getDefault().configuration)
+    , _fileCache(virtualHosts.getDefault().fileCache)
+    , _route(NULL)
+    , _upload(NULL)
+    , _keepAlive(false)
+    , _requestsServed(0)
+    , _lastActivity(time(NULL)) {
+}
+
+void Connection::attachClient(int clientSocketFd, const struct sockaddr_in& clientAddr) {
     const uint32_t SHIFT24 = 24;
     const uint32_t SHIFT16 = 16;
     const uint32_t SHIFT8 = 8;
     const uint32_t MASK8 = 0xFF;
-    struct sockaddr_in clientAddr;
-    socklen_t clientAddrLen = sizeof(clientAddr);
-    _clientSocketFd =
-        accept(listeningSocketFd, reinterpret_cast<struct sockaddr*>(&clientAddr), &clientAddrLen);
-    if (_clientSocketFd == -1) {
-        throw runtime_error(string("accept() failed"));  // NOTE: errno here forbidden
-        // TODO 48: probably should retry, not throw
-    }
+    _clientSocketFd = clientSocketFd;
+    _lastActivity = time(NULL);
     _clientIp = clientAddr.sin_addr.s_addr;
     _clientPort = ntohs(clientAddr.sin_port);
 
@@ -77,11 +86,110 @@ Connection::Connection(int listeningSocketFd, const Endpoint& configuration)
                            << _clientPort << "\n";
 }
 
+void Connection::release() {
+    resetForNextRequest();
+    _parser.clear();
+    if (_responseBuffer.capacity() > POOLED_BUFFER_BYTES) {
+        string().swap(_responseBuffer);  // NOTE: one big download must not pin its buffer forever
+    }
+    string().swap(_cgiHead);
+    _declaredBodyLength.clear();
+    _clientSocketFd = -1;
+    _clientIp = 0;
+    _clientPort = 0;
+    _configuration = _virtualHosts.getDefault().configuration;
+    _fileCache = _virtualHosts.getDefault().fileCache;
+    _requestsServed = 0;
+}
+
 Connection& Connection::setResponseBuffer(string buffer) {
+    // NOTE: we cannot vouch for the framing of a raw buffer, so the connection ends with it
+    _keepAlive = false;
     _responseBuffer = buffer;
+    _responseFile = FileBody();
+    _responseStream = StreamBody();
+    return (*this);
+}
+
+Connection& Connection::setResponse(Response response) {
+    _responseStream = response.getStreamBody();
+    if (_responseStream.isChunked() && _request.getVersion() != "HTTP/1.1") {
+        // NOTE: no chunks in HTTP/1.0, closing the connection ends the body
+        response.removeHeader("Transfer-Encoding");
+        _responseStream.setChunked(false);
+        _keepAlive = false;
+    }
+    if (_keepAlive) {
+        response.setHeader("Connection", "keep-alive");
+        response.setHeader(
+            "Keep-Alive",
+            "timeout=" + utils::toString(_configuration->getKeepAliveTimeoutSeconds()) +
+                ", max=" +
+                utils::toString(_configuration->getKeepAliveMaxRequests() - _requestsServed)
+        );
+    } else {
+        response.setHeader("Connection", "close");
+    }
+    if (response.getFileBody().isSet() || _responseStream.isSet()) {
+        _responseBuffer = response.serializeHead();
+        _responseFile = response.getFileBody();
+    } else {
+        _responseBuffer = response.serialize();
+        _responseFile = FileBody();
+    }
     return (*this);
 }
 
+bool Connection::isKeepAlive() const {
+    return (_keepAlive);
+}
+
+int Connection::getKeepAliveTimeoutSeconds() const {
+    return (_configuration->getKeepAliveTimeoutSeconds());
+}
+
+bool Connection::isIdleLongerThan(int seconds, time_t now) const {
+    // NOTE: only waiting for the client counts, a slow CGI or a slow download is not idling
+    if (_state != NEWBORN && _state != READING) {
+        return (false);
+    }
+    return (now - _lastActivity >= seconds);
+}
+
+Connection& Connection::resetForNextRequest() {
+    _state = NEWBORN;
+    _responseBuffer.clear();
+    _responseBufferSent = 0;
+    _responseFile = FileBody();
+    _responseStream = StreamBody();
+    _cgiHead.clear();
+    _request.reset();
+    _parser.reset();
+    delete _upload;  // NOTE: removes the temporary file of an upload that did not arrive whole
+    _upload = NULL;
+    _isRequestValid = false;
+    _rejectionStatus = HttpStatus::BAD_REQUEST;
+    _route = NULL;
+    _keepAlive = false;
+    _lastActivity = time(NULL);
+    return (*this);
+}
+
+bool Connection::hasBufferedRequestData() const {
+    return (_parser.hasBufferedData());
+}
+
+bool Connection::clientWantsKeepAlive() const {
+    const StringView connection = _request.getHeaderView("Connection");
+    if (connection.equalsIgnoreCase("close")) {
+        return (false);
+    }
+    if (_request.getVersionView() == "HTTP/1.1") {
+        return (true);  // NOTE: persistent by default since HTTP/1.1
+    }
+    return (connection.equalsIgnoreCase("keep-alive"));
+}
+
 std::string Connection::getResponseBuffer() const {
     return (_responseBuffer);
 }
@@ -90,46 +198,98 @@ int Connection::getClientSocketFd() const {
     return (_clientSocketFd);
 }
 
+void Connection::selectServer() {
+    const VirtualHosts::Server& server = _virtualHosts.select(_request.getHeaderView("Host"));
+    _configuration = server.configuration;
+    _fileCache = server.fileCache;
+}
+
+// NOTE: true once there is something to answer: a complete request or a refused one
 bool Connection::fullRequestReceived() {
-    const string requestBuffer = _requestBuffer.str();
-    _log.stream(LOG_SILENT) << "checking [" << requestBuffer << "]\n";
     try {
-        webserver::Request tmp(requestBuffer);
-        if (!tmp.isRequestTargetReceived()) {
-            return (false);
-        }
-        if (_route == NULL) {
-            /* NOTE: this is the first time we see the first line received.
-            we extract the path and try to match it to a route configuration.
-            we need the body size limit here, so that we can terminate the request parsing early.
+        RequestParser::State parserState = _parser.parse();
+        if (parserState == RequestParser::HEADERS_COMPLETE) {
+            /* NOTE: the header block has just arrived, the parser stopped right after it.
+            the Host header picks the server and the path one of its locations now,
+            so that the body size limit applies while the body is still arriving.
             */
+            selectServer();
             try {
-                _route = &(_configuration.selectRoute(tmp.getPath()));
+                _route = &(_configuration->selectRoute(_request.getPathView()));
                 _log.stream(LOG_TRACE) << *_route << " matched\n";
             } catch (const std::out_of_range& e) {
+                _rejectionStatus = HttpStatus::NOT_FOUND;
                 return (true);
             }
+            _request.setMaxClientBodySizeBytes(
+                _route->getFolderConfig().getMaxClientBodySizeBytes()
+            );
+            // NOTE: a length over the limit is refused here, before any upload file is made
+            _parser.applyBodyLimits();
+            openUpload();
+            parserState = _parser.parse();
+        }
+        if (parserState != RequestParser::COMPLETE) {
+            return (false);
+        }
+        if (_upload != NULL) {
+            _upload->finish();
+            _request.markBodyStored();
         }
-
-        // NOTE: we have the route already, but since we reparse the request for every check, we recast the max size into it again
-        tmp.setMaxClientBodySizeBytes(_route->getFolderConfig().getMaxClientBodySizeBytes());
-        tmp.getBody();  // NOTE: lazy body init
-
-        _request = tmp;
         if (itsACgiRequest()) {
             _request.markAsCgiRequest();
         }
         _isRequestValid = true;
         return (true);
-    } catch (const IncompleteRequest& e) {
-        return (false);
-    } catch (const BadRequest& e) {
+    } catch (const HttpException& e) {
+        _log.stream(LOG_DEBUG) << "Refusing request on socket " << _clientSocketFd << ": "
+                               << e.what() << "\n";
+        _rejectionStatus = e.getCode();
         return (true);
     }
 }
 
+Connection::State Connection::finishReading() {
+    if (_isRequestValid) {
+        _state = READING_COMPLETE;
+    } else if (_rejectionStatus == HttpStatus::METHOD_NOT_ALLOWED) {
+        _state = METHOD_NOT_ALLOWED;
+    } else {
+        _state = BAD_REQUEST_READ;
+    }
+    _requestsServed++;
+    // NOTE: after a refused request we cannot tell where the next one would start
+    _keepAlive = _isRequestValid && _configuration->getKeepAliveTimeoutSeconds() > 0 &&
+                 _requestsServed < _configuration->getKeepAliveMaxRequests() &&
+                 clientWantsKeepAlive();
+    return (_state);
+}
+
+/* NOTE: a POST that PostHandler would write to a file goes there while it arrives,
+* instead of being gathered in memory first, through a temporary file that replaces the target
+* only when the body completes; see FileSink.
+* anything PostHandler would refuse is left to it, the body is kept as usual.
+*/
+void Connection::openUpload() {
+    if (_request.getType() != POST || _route->isRedirection() ||
+        !_route->isMethodAllowed(POST) || itsACgiRequest()) {
+        return;
+    }
+    string path;
+    if (PostHandler::resolveUploadPath(_request.getPath(), *_route, path) != HttpStatus::OK) {
+        return;
+    }
+    _upload = new FileSink(path);
+    if (!_upload->isOpen()) {
+        delete _upload;
+        _upload = NULL;
+        return;
+    }
+    _parser.setBodySink(_upload);
+}
+
 bool Connection::itsACgiRequest() {
-    if (_route == NULL) {
+    if (_route == NULL || _configuration->getCgiHandlers().empty()) {
         return (false);
     }
 
@@ -149,7 +309,7 @@ bool Connection::itsACgiRequest() {
         }
 
         const string extension = path.substr(dotPos);
-        const std::map<string, CgiHandlerConfig*>& handlers = _configuration.getCgiHandlers();
+        const std::map<string, CgiHandlerConfig*>& handlers = _configuration->getCgiHandlers();
 
         const bool res = handlers.find(extension) != handlers.end();
         if (res) {
@@ -161,11 +321,11 @@ bool Connection::itsACgiRequest() {
     }
 }
 
-string Connection::getRequestBody() {
+const string& Connection::getRequestBody() {
     try {
         return (_request.getBody());
     } catch (...) {
-        return ("");
+        return (NO_BODY);
     }
 }
 
@@ -194,6 +354,17 @@ const CgiHandlerConfig* Connection::resolveCgiHandler(const Endpoint& config) {
     return (iter->second);
 }
 
+const CgiHandlerConfig* Connection::getCgiHandler() {
+    return (resolveCgiHandler(*_configuration));
+}
+
+std::map<string, string> Connection::getCgiParameters() {
+    const CgiHandlerConfig* cgiConfig = resolveCgiHandler(*_configuration);
+    const string scriptPath = resolveScriptPath();
+    CgiHandler handler(*cgiConfig, _request, scriptPath, _configuration->getPort(), *_route);
+    return (handler.prepareParameters());
+}
+
 string Connection::resolveScriptPath() {
     std::string requestPath = _request.getPath();
     if (!requestPath.empty() && requestPath[requestPath.length() - 1] == '/') {
@@ -205,91 +376,23 @@ string Connection::resolveScriptPath() {
     return (_route->getFolderConfig().getResolvedPath(requestPath));
 }
 
-void Connection::cgiError(const char* errorMsg) {
-    if (errorMsg != NULL) {
-        write(STDOUT_FILENO, errorMsg, strlen(errorMsg));
-        close(STDOUT_FILENO);
-        close(STDIN_FILENO);
-    }
-
-    char* argv[] = {const_cast<char*>("/usr/bin/false"), NULL};
-    char* envp[] = {NULL};
-    execve("/usr/bin/false", argv, envp);
-    while (true) {
-    }
-}
-
-Connection::State Connection::executeCgi(const Endpoint& config) {
-    try {
-        const CgiHandlerConfig* cgiConfig = resolveCgiHandler(config);
-
-        if (cgiConfig == NULL) {
-            cgiError(
-                "Status: 500\r\nContent-Type: text/html\r\n\r\nCGI handler configuration error\r\n"
-            );
-        }
-
-        if (_route == NULL) {
-            _log.stream(LOG_ERROR) << "No route found for CGI request\n";
-            cgiError(
-                "Status: 500\r\nContent-Type: text/html\r\n\r\nNo route configuration found\r\n"
-            );
-        }
-
-        const string scriptPath = resolveScriptPath();
-        CgiHandler handler(*cgiConfig, _request, scriptPath, _configuration.getPort(), *_route);
-        char** env = handler.prepareEnvironment();
-
-        const string interpreterPath = handler.getExecutablePath();
-        const string scriptPathStr = handler.getScriptPath();
-
-        char* argv[] = {
-            const_cast<char*>(interpreterPath.c_str()),
-            const_cast<char*>(scriptPathStr.c_str()),
-            // clang-format off
-            NULL};
-        // clang-format on
-
-        execve(interpreterPath.c_str(), argv, env);
-
-        _log.stream(LOG_ERROR) << "execve() failed for CGI script: " << scriptPathStr << "\n";
-
-        for (size_t i = 0; env[i] != NULL; ++i) {
-            delete[] env[i];
-        }
-        delete[] env;
-        cgiError("Status: 500\r\nContent-Type: text/html\r\n\r\nFailed to execute CGI script\r\n");
-    } catch (const std::exception& e) {
-        _log.stream(LOG_ERROR) << "Exception in executeCgi: " << e.what() << "\n";
-        cgiError(
-            "Status: 500\r\nContent-Type: text/html\r\n\r\nInternal server error in CGI "
-            "execution\r\n"
-        );
-    }
-
-    return (Connection::IGNORED);  // NOTE: not returned anyway
-}
-
 Connection::State Connection::receiveRequestContent() {
     _state = READING;
     const int READ_BUFFER_SIZE = 4096;
     char readBuffer[READ_BUFFER_SIZE];
     clean(readBuffer, READ_BUFFER_SIZE);
     ssize_t bytesRead;
+    // NOTE: the client may have pipelined this request behind the previous one
+    if (_parser.hasBufferedData() && fullRequestReceived()) {
+        return (finishReading());
+    }
     while (true) {
         bytesRead = recv(_clientSocketFd, readBuffer, sizeof(readBuffer), 0);
         if (bytesRead > 0) {
-            _requestBuffer << string(readBuffer, bytesRead);
+            _lastActivity = time(NULL);
+            _parser.feed(readBuffer, bytesRead);
             if (fullRequestReceived()) {
-                _state = READING_COMPLETE;
-                try {
-                    const Request tmp(_requestBuffer.str());
-                } catch (const MethodNotAllowed&) {
-                    _state = METHOD_NOT_ALLOWED;
-                } catch (const BadRequest&) {
-                    _state = BAD_REQUEST_READ;
-                }
-                return (_state);
+                return (finishReading());
             }
             continue;
         }
@@ -303,25 +406,188 @@ Connection::State Connection::receiveRequestContent() {
             return (_state);
             // NOTE: will have to finish reading later on a separate poll(), no data available currently
         }
-        throw runtime_error(string("recv() failed"));
-        // TODO 48: probably should retry, not throw
+        // NOTE: ECONNRESET and the like, same as an orderly close for us
+        _log.stream(LOG_DEBUG) << "recv() failed on fd " << _clientSocketFd << ": "
+                               << strerror(errno) << "\n";
+        _state = CLOSED_BY_CLIENT;
+        return (_state);
     }
 }
 
-void Connection::sendResponse() {
-    _log.stream(LOG_TRACE) << "Sending response to fd " << _clientSocketFd << "\n";
-    size_t totalSent = 0;
-    const size_t toSend = _responseBuffer.size();
-    while (totalSent < toSend) {
+Connection::State Connection::sendResponse() {
+    if (_state != WRITING) {
+        _log.stream(LOG_TRACE) << "Sending response to fd " << _clientSocketFd << "\n";
+        _state = WRITING;
+        _responseBufferSent = 0;
+    }
+    // NOTE: whatever the kernel takes, up to a budget; the rest waits for the next POLLOUT
+    size_t budget = WRITE_BUDGET_BYTES;
+    while (budget > 0 && _responseBufferSent < _responseBuffer.size()) {
+        size_t count = _responseBuffer.size() - _responseBufferSent;
+        if (count > budget) {
+            count = budget;
+        }
         const ssize_t sent =
-            send(_clientSocketFd, _responseBuffer.data() + totalSent, toSend - totalSent, 0);
+            send(_clientSocketFd, _responseBuffer.data() + _responseBufferSent, count, MSG_NOSIGNAL);
         if (sent == -1) {
-            throw runtime_error(string("send() failed"));
-            // TODO 48: probably should retry, not throw
+            return (writeFailed("send()"));
+        }
+        _responseBufferSent += sent;
+        budget -= sent;
+        _lastActivity = time(NULL);
+    }
+    while (budget > 0 && _responseBufferSent == _responseBuffer.size() &&
+           _responseFile.getLength() > 0) {
+        const ssize_t sent = _responseFile.sendTo(_clientSocketFd, budget);
+        if (sent == -1) {
+            return (writeFailed("sendfile()"));
+        }
+        if (sent == 0) {
+            _log.stream(LOG_ERROR) << "File got shorter than the Content-Length sent to fd "
+                                   << _clientSocketFd << "\n";
+            _keepAlive = false;
+            _state = CLOSED_BY_CLIENT;
+            return (_state);
         }
-        totalSent += sent;
+        budget -= sent;
+        _lastActivity = time(NULL);
+    }
+    while (budget > 0 && _responseBufferSent == _responseBuffer.size() &&
+           !_responseStream.isSent() && !_responseStream.isStarved()) {
+        // NOTE: one new piece per writable event, making it may cost, other clients wait meanwhile
+        const bool isNewPiece = (_responseStream.getPendingBytes() == 0);
+        const ssize_t sent = _responseStream.sendTo(_clientSocketFd, budget);
+        if (sent == -1) {
+            return (writeFailed("send()"));
+        }
+        if (sent == 0) {
+            break;
+        }
+        budget -= sent;
+        _lastActivity = time(NULL);
+        if (isNewPiece) {
+            break;
+        }
+    }
+    if (_responseBufferSent < _responseBuffer.size() || _responseFile.getLength() > 0) {
+        return (_state);
+    }
+    if (_responseStream.isStarved()) {
+        _responseBuffer.clear();
+        _responseBufferSent = 0;
+        return (WRITING_PAUSED);
     }
+    if (!_responseStream.isSent()) {
+        return (_state);
+    }
+    if (_responseStream.isAbandoned()) {
+        _keepAlive = false;  // NOTE: the body was cut short, what follows it would be misread
+    }
+    _responseFile = FileBody();
+    _responseStream = StreamBody();
+    _responseBuffer.clear();
+    _responseBufferSent = 0;
     _state = RESPONSE_SENT;
+    return (_state);
+}
+
+Connection::State Connection::writeFailed(const char* call) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return (_state);  // NOTE: socket buffer is full, not an error
+    }
+    // NOTE: EPIPE, ECONNRESET and the like: the client is gone, nobody to answer
+    _log.stream(LOG_DEBUG) << call << " failed on fd " << _clientSocketFd << ": "
+                           << strerror(errno) << "\n";
+    _keepAlive = false;
+    _state = CLOSED_BY_CLIENT;
+    return (_state);
+}
+
+bool Connection::isWriteStalled(time_t now) const {
+    // NOTE: with nothing left to send we are waiting for the CGI, not for the client
+    if (getUnsentResponseBytes() == 0 && _responseFile.getLength() == 0 &&
+        _responseStream.isSent()) {
+        return (false);
+    }
+    return (_state == WRITING && now - _lastActivity >= SEND_TIMEOUT_SECONDS);
+}
+
+size_t Connection::getUnsentResponseBytes() const {
+    return (_responseBuffer.size() - _responseBufferSent + _responseStream.getPendingBytes());
+}
+
+bool Connection::receiveCgiOutput(const char* data, size_t size) {
+    if (_responseStream.isSet()) {
+        _responseStream.write(data, size);
+        return (true);
+    }
+    const string::size_type searchFrom = _cgiHead.size() < 3 ? 0 : _cgiHead.size() - 3;
+    _cgiHead.append(data, size);
+    const string::size_type headEnd = _cgiHead.find("\r\n\r\n", searchFrom);
+    if (headEnd == string::npos) {
+        if (_cgiHead.size() <= MAX_CGI_HEAD_BYTES) {
+            return (true);
+        }
+        _log.stream(LOG_ERROR) << "CGI script produced invalid output (no proper headers)\n";
+        _cgiHead.clear();
+        setResponse(_configuration->getStatusCatalogue().serveStatusPage(
+            HttpStatus::INTERNAL_SERVER_ERROR
+        ));
+        return (false);
+    }
+    const string body = _cgiHead.substr(headEnd + 4);
+    startStreaming(CgiProcessManager::parseCgiHead(_cgiHead.substr(0, headEnd), *_configuration));
+    _cgiHead.clear();
+    _responseStream.write(body.data(), body.size());
+    return (true);
+}
+
+// NOTE: a body the script declared the length of, or that cannot have one, goes out as it comes
+void Connection::startStreaming(Response head) {
+    const bool mayHaveBody = head.getStatus() != HttpStatus::NO_CONTENT &&
+                             head.getStatus() != HttpStatus::NOT_MODIFIED;
+    _declaredBodyLength = head.getHeader("Content-Length");
+    if (_declaredBodyLength.empty() && mayHaveBody) {
+        setResponse(head.setStreamBody(StreamBody(NULL)));
+        return;
+    }
+    setResponse(head);
+    _responseStream = StreamBody(NULL);
+}
+
+void Connection::finishCgiOutput() {
+    if (!_responseStream.isSet()) {
+        if (_cgiHead.empty()) {
+            _log.stream(LOG_ERROR) << "CGI script produced no output\n";
+        } else {
+            _log.stream(LOG_ERROR) << "CGI script produced invalid output (no proper headers)\n";
+        }
+        _cgiHead.clear();
+        setResponse(_configuration->getStatusCatalogue().serveStatusPage(
+            HttpStatus::INTERNAL_SERVER_ERROR
+        ));
+        return;
+    }
+    _responseStream.close();
+    if (!_declaredBodyLength.empty() &&
+        _declaredBodyLength != utils::toString(_responseStream.getBodyBytes())) {
+        // NOTE: the client cannot tell where this body ends, so nothing may follow it
+        _log.stream(LOG_ERROR) << "CGI script sent " << _responseStream.getBodyBytes()
+                               << " body bytes with Content-Length " << _declaredBodyLength
+                               << "\n";
+        _keepAlive = false;
+    }
+}
+
+void Connection::failCgiOutput(HttpStatus::CODE status) {
+    if (!_responseStream.isSet()) {
+        _cgiHead.clear();
+        setResponse(_configuration->getStatusCatalogue().serveStatusPage(status));
+        return;
+    }
+    // NOTE: the head is out already, a body cut short is all that can tell the client
+    _responseStream.abandon();
+    _keepAlive = false;
 }
 
 Connection::State Connection::generateResponse() {
@@ -331,33 +597,33 @@ Connection::State Connection::generateResponse() {
         return (_state);
     }
     if (_state == METHOD_NOT_ALLOWED) {
-        _responseBuffer = _configuration.getStatusCatalogue()
-                              .serveStatusPage(HttpStatus::METHOD_NOT_ALLOWED)
-                              .serialize();
+        setResponse(_configuration->getStatusCatalogue().serveStatusPage(HttpStatus::METHOD_NOT_ALLOWED
+        ));
         return (WRITING_COMPLETE);
     }
     if (_state == BAD_REQUEST_READ) {
-        _responseBuffer = _configuration.getStatusCatalogue()
-                              .serveStatusPage(HttpStatus::BAD_REQUEST)
-                              .serialize();
+        setResponse(_configuration->getStatusCatalogue().serveStatusPage(_rejectionStatus));
         return (WRITING_COMPLETE);
     }
+    if (_request.getType() == SHUTDOWN) {
+        _keepAlive = false;
+    }
     try {
         _log.stream(LOG_TRACE) << "Received HTTP request on socket " << _clientSocketFd << ":\n"
-                               << _requestBuffer.str();
-        _responseBuffer = RequestHandler::handleRequest(_request, *_route);
-        if (_responseBuffer == "CGI") {
+                               << _request;
+        const Response response = RequestHandler::handleRequest(_request, *_route, _fileCache);
+        if (response.getStatus() == RequestHandler::REROUTE_TO_CGI) {
             return (REROUTING_BACK_TO_CGI);
         }
+        setResponse(response);
     } catch (const HttpException& e) {
         _log.stream(LOG_ERROR) << e.what() << "\n";
-        _responseBuffer =
-            _configuration.getStatusCatalogue().serveStatusPage(e.getCode()).serialize();
+        setResponse(_configuration->getStatusCatalogue().serveStatusPage(e.getCode()));
     } catch (const exception& e) {
         _log.stream(LOG_ERROR) << e.what() << "\n";
-        _responseBuffer = _configuration.getStatusCatalogue()
-                              .serveStatusPage(HttpStatus::INTERNAL_SERVER_ERROR)
-                              .serialize();
+        setResponse(_configuration->getStatusCatalogue().serveStatusPage(
+            HttpStatus::INTERNAL_SERVER_ERROR
+        ));
     }
     if (_request.getType() == SHUTDOWN) {
         _state = SERVER_SHUTTING_DOWN;
@@ -372,6 +638,7 @@ const Request& Connection::getRequest() const {
 }
 
 Connection::~Connection() {
+    delete _upload;
 }
 
 }  // namespace webserver
@@ -1,16 +1,25 @@
 #ifndef CONNECTION_HPP
 #define CONNECTION_HPP
 
+#include <netinet/in.h>
 #include <poll.h>
 #include <stdint.h>
+#include <time.h>
 
 #include <map>
-#include <sstream>
 #include <string>
 
 #include "configuration/AppConfig.hpp"
+#include "file_system/StaticFileCache.hpp"
+#include "http_status/HttpStatus.hpp"
+#include "listener/VirtualHosts.hpp"
 #include "logger/Logger.hpp"
+#include "request/BodySink.hpp"
 #include "request/Request.hpp"
+#include "request/RequestParser.hpp"
+#include "response/FileBody.hpp"
+#include "response/Response.hpp"
+#include "response/StreamBody.hpp"
 
 namespace webserver {
 class Connection {
@@ -22,9 +31,9 @@ public:
         BAD_REQUEST_READ,
         METHOD_NOT_ALLOWED,
         REROUTING_BACK_TO_CGI,
-        RECEIVED_RESPONSE_FROM_WORKER,
         RECEIVED_STATUS_FROM_WORKER,
         WRITING,
+        WRITING_PAUSED,  // NOTE: all produced so far is sent, the rest is still being produced
         WRITING_COMPLETE,
         RESPONSE_SENT,
         CLOSED_BY_CLIENT,
@@ -34,45 +43,91 @@ public:
 
 private:
     static Logger _log;
+    static const size_t WRITE_BUDGET_BYTES = 1048576;  // NOTE: per POLLOUT, others wait meanwhile
+    static const int SEND_TIMEOUT_SECONDS = 60;        // NOTE: a client that stopped reading
+    static const size_t MAX_CGI_HEAD_BYTES = 65536;
+    static const size_t POOLED_BUFFER_BYTES = 65536;  // NOTE: kept by a connection back in the pool
     State _state;
-    int _clientSocketFd;  // NOTE: acquired here, then passed to pollfd up in MasterListener
+    int _clientSocketFd;  // NOTE: passed to pollfd up in MasterListener, -1 while pooled
     std::string _responseBuffer;
     /* NOTE: buffer used for construction in a forked process,
     * then read in MasterListener via getResponseBuffer + responsePipe
     * and reset into the main thread's Connection for dispatching.
     */
-    std::ostringstream _requestBuffer;
+    size_t _responseBufferSent;  // NOTE: output cursor, a full socket buffer leaves us mid-way
+    FileBody _responseFile;      // NOTE: sent after _responseBuffer when the body is a file
+    StreamBody _responseStream;  // NOTE: sent after _responseBuffer when the length is unknown
+    /* NOTE: a CGI response is sent while the script is still writing it.
+    * its output is held in _cgiHead up to the blank line, then the head goes out
+    * and every later piece of body is written to _responseStream as it arrives,
+    * in a chunk of its own when the script did not declare a Content-Length.
+    */
+    std::string _cgiHead;
+    std::string _declaredBodyLength;  // NOTE: the script's Content-Length, empty if it gave none
     Request _request;
+    RequestParser _parser;  // NOTE: fills _request, declared after it
     bool _isRequestValid;
+    HttpStatus::CODE _rejectionStatus;  // NOTE: why the request was refused while reading
     uint32_t _clientIp;
     uint16_t _clientPort;
-    const Endpoint& _configuration;
+    const VirtualHosts& _virtualHosts;  // NOTE: owned by the Listener, shared by its connections
+    const Endpoint* _configuration;     // NOTE: the default server until a Host header picks one
+    StaticFileCache* _fileCache;        // NOTE: the one of _configuration
     const RouteConfig* _route;
+    FileSink* _upload;  // NOTE: owned; where the body of a plain upload goes, NULL for others
+    bool _keepAlive;
+    int _requestsServed;
+    time_t _lastActivity;
 
     Connection();
     Connection(const Connection& other);
     Connection& operator=(const Connection& other);
 
     bool fullRequestReceived();
+    State finishReading();
+    State writeFailed(const char* call);
+    void startStreaming(Response head);
+    bool clientWantsKeepAlive() const;
+    void selectServer();
     bool itsACgiRequest();
+    void openUpload();
     std::string resolveScriptPath();
-    static void cgiError(const char* errorMsg);
 
 public:
-    explicit Connection(int listeningSocketFd, const Endpoint& configuration);
+    /* NOTE: connections are pooled by their Listener: created once without a client,
+    * attachClient() binds one, release() forgets it and the object waits for the next accept.
+    */
+    explicit Connection(const VirtualHosts& virtualHosts);
     ~Connection();
 
+    // NOTE: the socket comes already accepted, non-blocking and close-on-exec
+    void attachClient(int clientSocketFd, const struct sockaddr_in& clientAddr);
+    void release();
+
     int getClientSocketFd() const;
     Connection& setResponseBuffer(std::string buffer);
+    Connection& setResponse(Response response);
     std::string getResponseBuffer() const;
+    bool isKeepAlive() const;
+    bool isIdleLongerThan(int seconds, time_t now) const;
+    int getKeepAliveTimeoutSeconds() const;  // NOTE: of the server that answered the last request
+    bool isWriteStalled(time_t now) const;
+    Connection& resetForNextRequest();
+    bool hasBufferedRequestData() const;
 
     State receiveRequestContent();
     State generateResponse();
-    void sendResponse();
+    State sendResponse();
+    size_t getUnsentResponseBytes() const;
+    // NOTE: false once no more output is wanted: a broken header block got a 500 instead
+    bool receiveCgiOutput(const char* data, size_t size);
+    void finishCgiOutput();                      // NOTE: the script closed its stdout
+    void failCgiOutput(HttpStatus::CODE status);  // NOTE: gave up on the script
 
     const CgiHandlerConfig* resolveCgiHandler(const Endpoint& config);
-    Connection::State executeCgi(const Endpoint& config);
-    std::string getRequestBody();
+    const CgiHandlerConfig* getCgiHandler();
+    std::map<std::string, std::string> getCgiParameters();
+    const std::string& getRequestBody();
     const Request& getRequest() const;
 };
 }  // namespace webserver
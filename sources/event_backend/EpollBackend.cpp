@@ -0,0 +1,141 @@
+#include "EpollBackend.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::runtime_error;
+using std::strerror;
+using std::string;
+using std::vector;
+
+namespace {
+uint32_t pollToEpoll(short events) {
+    uint32_t res = 0;
+    if ((events & POLLIN) != 0) {
+        res |= EPOLLIN;
+    }
+    if ((events & POLLOUT) != 0) {
+        res |= EPOLLOUT;
+    }
+    return (res);
+}
+
+short epollToPoll(uint32_t events) {
+    short res = 0;
+    if ((events & EPOLLIN) != 0) {
+        res |= POLLIN;
+    }
+    if ((events & EPOLLOUT) != 0) {
+        res |= POLLOUT;
+    }
+    if ((events & EPOLLHUP) != 0) {
+        res |= POLLHUP;
+    }
+    if ((events & EPOLLERR) != 0) {
+        res |= POLLERR;
+    }
+    return (res);
+}
+}  // namespace
+
+namespace webserver {
+EpollBackend::EpollBackend()
+    : _epollFd(epoll_create(MAX_EVENTS_PER_WAIT))
+    , _events(MAX_EVENTS_PER_WAIT) {
+    if (_epollFd == -1) {
+        throw runtime_error(string("epoll_create() failed: ") + strerror(errno));
+    }
+    // NOTE: CGI children must not inherit the interest list
+    if (fcntl(_epollFd, F_SETFD, FD_CLOEXEC) == -1) {
+        close(_epollFd);
+        throw runtime_error(string("fcntl(FD_CLOEXEC) failed: ") + strerror(errno));
+    }
+}
+
+EpollBackend::~EpollBackend() {
+    close(_epollFd);
+}
+
+bool EpollBackend::isRegistered(int fd) const {
+    return (fd >= 0 && static_cast<size_t>(fd) < _triggers.size() && _triggers[fd] != -1);
+}
+
+void EpollBackend::control(int operation, int fd, short events) {
+    struct ::epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = pollToEpoll(events);
+    if (_triggers[fd] == EDGE_TRIGGERED) {
+        event.events |= EPOLLET;
+    }
+    event.data.fd = fd;
+    if (epoll_ctl(_epollFd, operation, fd, &event) == -1) {
+        throw runtime_error(string("epoll_ctl() failed: ") + strerror(errno));
+    }
+}
+
+void EpollBackend::add(int fd, short events, Trigger trigger) {
+    if (fd < 0) {
+        throw std::invalid_argument("EpollBackend::add(): negative fd");
+    }
+    if (isRegistered(fd)) {
+        modify(fd, events);
+        return;
+    }
+    if (static_cast<size_t>(fd) >= _triggers.size()) {
+        _triggers.resize(fd + 1, -1);
+    }
+    _triggers[fd] = trigger;
+    try {
+        control(EPOLL_CTL_ADD, fd, events);
+    } catch (const std::exception&) {
+        _triggers[fd] = -1;
+        throw;
+    }
+}
+
+void EpollBackend::modify(int fd, short events) {
+    if (!isRegistered(fd)) {
+        return;
+    }
+    control(EPOLL_CTL_MOD, fd, events);
+}
+
+void EpollBackend::remove(int fd) {
+    if (!isRegistered(fd)) {
+        return;
+    }
+    _triggers[fd] = -1;
+    struct ::epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    // NOTE: a closed descriptor has already left the interest list on its own
+    if (epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, &event) == -1 && errno != EBADF &&
+        errno != ENOENT) {
+        throw runtime_error(string("epoll_ctl(EPOLL_CTL_DEL) failed: ") + strerror(errno));
+    }
+}
+
+int EpollBackend::wait(vector<Event>& ready, int timeoutMs) {
+    ready.clear();
+    const int ret = epoll_wait(_epollFd, _events.data(), MAX_EVENTS_PER_WAIT, timeoutMs);
+    for (int i = 0; i < ret; i++) {
+        Event event;
+        event.fd = _events[i].data.fd;
+        event.events = epollToPoll(_events[i].events);
+        ready.push_back(event);
+    }
+    return (ret);
+}
+
+EventBackend::Type EpollBackend::getType() const {
+    return (EPOLL);
+}
+}  // namespace webserver
@@ -0,0 +1,42 @@
+#ifndef EPOLLBACKEND_HPP
+#define EPOLLBACKEND_HPP
+
+#include <sys/epoll.h>
+
+#include <vector>
+
+#include "event_backend/EventBackend.hpp"
+
+namespace webserver {
+/* NOTE: Linux epoll. the kernel keeps the interest list,
+* so a wakeup costs O(ready descriptors) instead of O(watched descriptors).
+* edge-triggered registrations are only reported on state changes:
+* their owners must drain the descriptor until EAGAIN,
+* and every modify() re-arms the descriptor, reporting readiness that is already there.
+*/
+class EpollBackend : public EventBackend {
+private:
+    static const int MAX_EVENTS_PER_WAIT = 256;
+
+    int _epollFd;
+    std::vector<struct ::epoll_event> _events;
+    std::vector<int> _triggers;  // NOTE: fd: Trigger it was added with, -1 if not registered
+
+    EpollBackend(const EpollBackend& other);
+    EpollBackend& operator=(const EpollBackend& other);
+
+    bool isRegistered(int fd) const;
+    void control(int operation, int fd, short events);
+
+public:
+    EpollBackend();
+    ~EpollBackend();
+
+    void add(int fd, short events, Trigger trigger);
+    void modify(int fd, short events);
+    void remove(int fd);
+    int wait(std::vector<Event>& ready, int timeoutMs);
+    Type getType() const;
+};
+}  // namespace webserver
+#endif
@@ -0,0 +1,45 @@
+#include "EventBackend.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "event_backend/EpollBackend.hpp"
+#include "event_backend/PollBackend.hpp"
+
+using std::string;
+
+namespace webserver {
+EventBackend::~EventBackend() {
+}
+
+EventBackend* EventBackend::create(Type type) {
+    if (type == EPOLL) {
+        return (new EpollBackend());
+    }
+    return (new PollBackend());
+}
+
+EventBackend::Type stringToEventBackendType(const string& str) {
+    if (str == "poll") {
+        return (EventBackend::POLL);
+    }
+    if (str == "epoll") {
+        return (EventBackend::EPOLL);
+    }
+    throw std::out_of_range("Invalid event backend: " + str);
+}
+
+string eventBackendTypeToString(const EventBackend::Type& type) {
+    switch (type) {
+        case EventBackend::POLL: {
+            return ("poll");
+        }
+        case EventBackend::EPOLL: {
+            return ("epoll");
+        }
+        default: {
+            throw std::out_of_range("Invalid event backend");
+        }
+    }
+}
+}  // namespace webserver
@@ -0,0 +1,41 @@
+#ifndef EVENTBACKEND_HPP
+#define EVENTBACKEND_HPP
+
+#include <string>
+#include <vector>
+
+namespace webserver {
+/* NOTE: readiness notification mechanism used by MasterListener.
+* interest sets and reported events are expressed with poll() bits
+* (POLLIN, POLLOUT, POLLHUP, POLLERR) whatever the implementation is,
+* so the event loop does not care which syscall is behind it.
+* every registration call is O(1) in the number of watched descriptors.
+*/
+class EventBackend {
+public:
+    enum Type { POLL, EPOLL };
+    enum Trigger { LEVEL_TRIGGERED, EDGE_TRIGGERED };
+
+    struct Event {
+        int fd;
+        short events;
+    };
+
+    virtual ~EventBackend();
+
+    virtual void add(int fd, short events, Trigger trigger) = 0;
+    virtual void modify(int fd, short events) = 0;
+    virtual void remove(int fd) = 0;
+    /* NOTE: fills ready with descriptors that have pending events,
+    * returns the underlying syscall result; -1 leaves errno untouched for the caller
+    */
+    virtual int wait(std::vector<Event>& ready, int timeoutMs) = 0;
+    virtual Type getType() const = 0;
+
+    static EventBackend* create(Type type);
+};
+
+EventBackend::Type stringToEventBackendType(const std::string& str);
+std::string eventBackendTypeToString(const EventBackend::Type& type);
+}  // namespace webserver
+#endif
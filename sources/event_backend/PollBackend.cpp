@@ -0,0 +1,86 @@
+#include "PollBackend.hpp"
+
+#include <poll.h>
+
+#include <stdexcept>
+#include <vector>
+
+using std::vector;
+
+namespace webserver {
+PollBackend::PollBackend() {
+}
+
+PollBackend::~PollBackend() {
+}
+
+int PollBackend::slotOf(int fd) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= _slots.size()) {
+        return (-1);
+    }
+    return (_slots[fd]);
+}
+
+void PollBackend::add(int fd, short events, Trigger trigger) {
+    (void)trigger;
+    if (fd < 0) {
+        throw std::invalid_argument("PollBackend::add(): negative fd");
+    }
+    if (slotOf(fd) != -1) {
+        modify(fd, events);
+        return;
+    }
+    if (static_cast<size_t>(fd) >= _slots.size()) {
+        _slots.resize(fd + 1, -1);
+    }
+    struct ::pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = events;
+    pfd.revents = 0;
+    _slots[fd] = static_cast<int>(_pollFds.size());
+    _pollFds.push_back(pfd);
+}
+
+void PollBackend::modify(int fd, short events) {
+    const int slot = slotOf(fd);
+    if (slot == -1) {
+        return;
+    }
+    _pollFds[slot].events = events;
+}
+
+void PollBackend::remove(int fd) {
+    const int slot = slotOf(fd);
+    if (slot == -1) {
+        return;
+    }
+    const struct ::pollfd last = _pollFds.back();
+    _pollFds[slot] = last;
+    _slots[last.fd] = slot;
+    _pollFds.pop_back();
+    _slots[fd] = -1;
+}
+
+int PollBackend::wait(vector<Event>& ready, int timeoutMs) {
+    ready.clear();
+    const int ret = poll(_pollFds.data(), _pollFds.size(), timeoutMs);
+    if (ret <= 0) {
+        return (ret);
+    }
+    for (size_t i = 0; i < _pollFds.size(); i++) {
+        if (_pollFds[i].revents == 0) {
+            continue;
+        }
+        Event event;
+        event.fd = _pollFds[i].fd;
+        event.events = _pollFds[i].revents;
+        ready.push_back(event);
+        _pollFds[i].revents = 0;
+    }
+    return (ret);
+}
+
+EventBackend::Type PollBackend::getType() const {
+    return (POLL);
+}
+}  // namespace webserver
@@ -0,0 +1,37 @@
+#ifndef POLLBACKEND_HPP
+#define POLLBACKEND_HPP
+
+#include <poll.h>
+
+#include <vector>
+
+#include "event_backend/EventBackend.hpp"
+
+namespace webserver {
+/* NOTE: portable fallback. poll() itself is still O(n) per call,
+* but registrations no longer scan the pollfd array:
+* _slots maps a descriptor to its index, and removal swaps the last entry into the hole.
+* poll() has no edge-triggered mode, so the trigger hint is ignored.
+*/
+class PollBackend : public EventBackend {
+private:
+    std::vector<struct ::pollfd> _pollFds;
+    std::vector<int> _slots;  // NOTE: fd: index in _pollFds, -1 if not registered
+
+    PollBackend(const PollBackend& other);
+    PollBackend& operator=(const PollBackend& other);
+
+    int slotOf(int fd) const;
+
+public:
+    PollBackend();
+    ~PollBackend();
+
+    void add(int fd, short events, Trigger trigger);
+    void modify(int fd, short events);
+    void remove(int fd);
+    int wait(std::vector<Event>& ready, int timeoutMs);
+    Type getType() const;
+};
+}  // namespace webserver
+#endif
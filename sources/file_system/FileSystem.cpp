@@ -4,14 +4,18 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <sstream>
 #include <stdexcept>
 #include <string>
 
 #include "file_system/MimeType.hpp"
 #include "http_status/HttpStatus.hpp"
+#include "response/FileBody.hpp"
 #include "response/Response.hpp"
 
 #define DEFAULT_BUFFER_SIZE 4096
+// NOTE: bigger files are sent straight from the descriptor, see FileBody
+#define INLINE_FILE_BODY_MAX_BYTES 65536
 
 using std::string;
 using webserver::Response;
@@ -61,12 +65,9 @@ long getFileSize(const char* path) {
     return (-1);
 }
 
-std::string readFile(const char* path) {
-    const int fileDescriptor = open(path, O_RDONLY);
-    if (fileDescriptor < 0) {
-        throw std::runtime_error("Failed to open file");
-    }
-
+namespace {
+// NOTE: closes the descriptor in any case
+std::string readAndClose(int fileDescriptor) {
     char buffer[DEFAULT_BUFFER_SIZE];
     std::string result;
 
@@ -74,13 +75,21 @@ std::string readFile(const char* path) {
     while ((bytes = read(fileDescriptor, buffer, sizeof(buffer))) > 0) {
         result.append(buffer, bytes);
     }
+    close(fileDescriptor);
     if (bytes < 0) {
         throw std::runtime_error("Failed to read file");
     }
-    close(fileDescriptor);
-
     return (result);
 }
+}  // namespace
+
+std::string readFile(const char* path) {
+    const int fileDescriptor = open(path, O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Failed to open file");
+    }
+    return (readAndClose(fileDescriptor));
+}
 
 std::string getFileExtension(const std::string& path) {
     /* NOTE: 
@@ -136,14 +145,41 @@ bool canCreateDirectory(const char* path) {
     return (isDirectory(parent.c_str()) && access(parent.c_str(), W_OK) == 0);
 }
 
+string entityTag(const struct stat& stt) {
+    std::ostringstream tag;
+    tag << std::hex << "\"" << stt.st_ino << "-" << stt.st_size << "-" << stt.st_mtim.tv_sec << "."
+        << stt.st_mtim.tv_nsec << "\"";
+    return (tag.str());
+}
+
 Response serveFile(const std::string& path, int statusCode, string reasonPhrase) {
+    struct stat stt;
+    return (serveFile(path, statusCode, reasonPhrase, stt));
+}
+
+Response
+serveFile(const std::string& path, int statusCode, string reasonPhrase, struct stat& stt) {
     const string ext = file_system::getFileExtension(path);
-    const Response resp(
-        statusCode,
-        reasonPhrase,
-        file_system::readFile(path.c_str()),
-        webserver::MimeType::getMimeType(ext)
-    );
+    Response resp(statusCode, reasonPhrase, "", webserver::MimeType::getMimeType(ext));
+    const int fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Failed to open file");
+    }
+    if (fstat(fileDescriptor, &stt) == -1) {
+        close(fileDescriptor);
+        throw std::runtime_error("Failed to stat file");
+    }
+    if (stt.st_size < INLINE_FILE_BODY_MAX_BYTES) {
+        // NOTE: one read() is cheaper than keeping a descriptor around
+        resp.setBody(readAndClose(fileDescriptor));
+        return (resp);
+    }
+    // NOTE: CGI children must not inherit it
+    if (fcntl(fileDescriptor, F_SETFD, FD_CLOEXEC) == -1) {
+        close(fileDescriptor);
+        throw std::runtime_error("Failed to set FD_CLOEXEC on file");
+    }
+    resp.setFileBody(webserver::FileBody(fileDescriptor, 0, stt.st_size));
     return (resp);
 }
 
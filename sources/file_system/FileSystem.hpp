@@ -1,6 +1,8 @@
 #ifndef FILESYSTEM_HPP
 #define FILESYSTEM_HPP
 
+#include <sys/stat.h>
+
 #include <string>
 
 #include "http_status/HttpStatus.hpp"
@@ -18,7 +20,16 @@ bool isReadableFile(const char* path);
 bool isExecutableFile(const char* path);
 bool isWritableDirectory(const char* path);
 bool canCreateDirectory(const char* path);
+// NOTE: strong, changes with the inode, the size or the mtime down to the nanosecond
+std::string entityTag(const struct ::stat& fileStat);
 webserver::Response serveFile(const std::string& path, int statusCode, std::string reasonPhrase);
+// NOTE: also reports what fstat() said about the file the body was taken from
+webserver::Response serveFile(
+    const std::string& path,
+    int statusCode,
+    std::string reasonPhrase,
+    struct ::stat& fileStat
+);
 }  // namespace file_system
 
 #endif
@@ -12,20 +12,23 @@ const string MimeType::DEFAULT_MIME_TYPE = "application/octet-stream";
 
 MimeType::MimeType()
     : _type(DEFAULT_MIME_TYPE)
-    , _isPrintable(false) {
+    , _isPrintable(false)
+    , _isCompressible(false) {
 }
 
 MimeType::MimeType(const MimeType& other)
     : _type(other._type)
-    , _isPrintable(other._isPrintable) {
+    , _isPrintable(other._isPrintable)
+    , _isCompressible(other._isCompressible) {
 }
 
 MimeType::~MimeType() {
 }
 
-MimeType::MimeType(const string& type, bool isPrintable)
+MimeType::MimeType(const string& type, bool isPrintable, bool isCompressible)
     : _type(type)
-    , _isPrintable(isPrintable) {
+    , _isPrintable(isPrintable)
+    , _isCompressible(isCompressible) {
 }
 
 MimeType& MimeType::operator=(const MimeType& other) {
@@ -34,33 +37,34 @@ MimeType& MimeType::operator=(const MimeType& other) {
     }
     _type = other._type;
     _isPrintable = other._isPrintable;
+    _isCompressible = other._isCompressible;
     return (*this);
 }
 
 map<string, MimeType> MimeType::initMimeTypeMap() {
     map<string, MimeType> map;
 
-    map["html"] = MimeType("text/html", true);
+    map["html"] = MimeType("text/html", true, true);
     map["htm"] = map["html"];
-    map["css"] = MimeType("text/css", true);
-    map["js"] = MimeType("application/javascript", true);
-    map["png"] = MimeType("image/png", false);
-    map["jpg"] = MimeType("image/jpeg", false);
+    map["css"] = MimeType("text/css", true, true);
+    map["js"] = MimeType("application/javascript", true, true);
+    map["png"] = MimeType("image/png", false, false);
+    map["jpg"] = MimeType("image/jpeg", false, false);
     map["jpeg"] = map["jpg"];
-    map["gif"] = MimeType("image/gif", false);
-    map["mp3"] = MimeType("audio/mpeg", false);
-    map["mp4"] = MimeType("video/mp4", false);
-    map["pdf"] = MimeType("application/pdf", false);
-    map["txt"] = MimeType("text/plain", true);
-    map["ico"] = MimeType("image/x-icon", false);
-    map["json"] = MimeType("application/json", true);
-    map["wasm"] = MimeType("application/wasm", false);
-    map["svg"] = MimeType("image/svg+xml", false);
-    map["webp"] = MimeType("image/webp", false);
-    map["woff"] = MimeType("font/woff", false);
-    map["woff2"] = MimeType("font/woff2", false);
-    map["csv"] = MimeType("text/csv", true);
-    map["xml"] = MimeType("application/xml", true);
+    map["gif"] = MimeType("image/gif", false, false);
+    map["mp3"] = MimeType("audio/mpeg", false, false);
+    map["mp4"] = MimeType("video/mp4", false, false);
+    map["pdf"] = MimeType("application/pdf", false, false);
+    map["txt"] = MimeType("text/plain", true, true);
+    map["ico"] = MimeType("image/x-icon", false, false);
+    map["json"] = MimeType("application/json", true, true);
+    map["wasm"] = MimeType("application/wasm", false, true);
+    map["svg"] = MimeType("image/svg+xml", false, true);
+    map["webp"] = MimeType("image/webp", false, false);
+    map["woff"] = MimeType("font/woff", false, false);
+    map["woff2"] = MimeType("font/woff2", false, false);
+    map["csv"] = MimeType("text/csv", true, true);
+    map["xml"] = MimeType("application/xml", true, true);
 
     return (map);
 }
@@ -75,6 +79,17 @@ string MimeType::getMimeType(const string& extension) {
     return (DEFAULT_MIME_TYPE);
 }
 
+bool MimeType::isCompressible(const string& mimeType) {
+    for (map<string, MimeType>::const_iterator itr = _mimeTypeMap.begin();
+         itr != _mimeTypeMap.end();
+         ++itr) {
+        if (itr->second._type == mimeType) {
+            return (itr->second._isCompressible);
+        }
+    }
+    return (false);
+}
+
 bool MimeType::isPrintable(const string& mimeType) {
     for (map<string, MimeType>::const_iterator itr = _mimeTypeMap.begin();
          itr != _mimeTypeMap.end();
@@ -9,10 +9,11 @@ class MimeType {
 private:
     std::string _type;
     bool _isPrintable;
+    bool _isCompressible;  // NOTE: text and the like, worth a Content-Encoding
     static std::map<std::string, MimeType> _mimeTypeMap;
     static const std::string DEFAULT_MIME_TYPE;
 
-    MimeType(const std::string& type, bool isPrintable);
+    MimeType(const std::string& type, bool isPrintable, bool isCompressible);
     MimeType& operator=(const MimeType& other);
 
     static std::map<std::string, MimeType> initMimeTypeMap();
@@ -24,6 +25,7 @@ public:
 
     static std::string getMimeType(const std::string& extension);
     static bool isPrintable(const std::string& mimeType);
+    static bool isCompressible(const std::string& mimeType);
 };
 }  // namespace webserver
 
@@ -0,0 +1,131 @@
+#include "StaticFileCache.hpp"
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "logger/Logger.hpp"
+#include "response/Response.hpp"
+#include "utils/utils.hpp"
+
+using std::string;
+
+namespace {
+bool isSameFile(const struct ::stat& cached, const struct ::stat& current) {
+    return (
+        S_ISREG(current.st_mode) && cached.st_dev == current.st_dev &&
+        cached.st_ino == current.st_ino && cached.st_size == current.st_size &&
+        cached.st_mtim.tv_sec == current.st_mtim.tv_sec &&
+        cached.st_mtim.tv_nsec == current.st_mtim.tv_nsec &&
+        cached.st_ctim.tv_sec == current.st_ctim.tv_sec &&
+        cached.st_ctim.tv_nsec == current.st_ctim.tv_nsec
+    );
+}
+}  // namespace
+
+namespace webserver {
+Logger StaticFileCache::_log;
+
+StaticFileCache::StaticFileCache(size_t capacityBytes)
+    : _capacityBytes(capacityBytes)
+    , _sizeBytes(0)
+    , _clock(0) {
+}
+
+StaticFileCache::~StaticFileCache() {
+}
+
+size_t StaticFileCache::costOf(const string& path, const Entry& entry) {
+    return (path.size() + entry.response.getBody().size());
+}
+
+void StaticFileCache::touch(EntryMap::iterator entry) {
+    _recency.erase(entry->second.lastUse);
+    entry->second.lastUse = ++_clock;
+    _recency[entry->second.lastUse] = entry->first;
+}
+
+void StaticFileCache::evict(EntryMap::iterator entry) {
+    _sizeBytes -= costOf(entry->first, entry->second);
+    _recency.erase(entry->second.lastUse);
+    _entries.erase(entry);
+}
+
+// NOTE: no path holds a \0, so a variant never takes the place of another file
+string StaticFileCache::keyOf(const string& path, const string& variant) {
+    if (variant.empty()) {
+        return (path);
+    }
+    return (path + '\0' + variant);
+}
+
+bool StaticFileCache::lookup(const string& path, Response& response) {
+    return (lookup(path, "", response));
+}
+
+bool StaticFileCache::lookup(const string& path, const string& variant, Response& response) {
+    const EntryMap::iterator found = _entries.find(keyOf(path, variant));
+    if (found == _entries.end()) {
+        return (false);
+    }
+    struct ::stat current;
+    if (stat(path.c_str(), &current) == -1 || !isSameFile(found->second.fileStat, current)) {
+        _log.stream(LOG_DEBUG) << "Cached " << path << " is stale\n";
+        evict(found);
+        return (false);
+    }
+    touch(found);
+    response = found->second.response;
+    response.setHeader("Date", utils::getTimestamp());
+    return (true);
+}
+
+void StaticFileCache::store(
+    const string& path,
+    const struct ::stat& fileStat,
+    const Response& response
+) {
+    store(path, "", fileStat, response);
+}
+
+void StaticFileCache::store(
+    const string& path,
+    const string& variant,
+    const struct ::stat& fileStat,
+    const Response& response
+) {
+    if (response.getFileBody().isSet()) {
+        return;
+    }
+    const string key = keyOf(path, variant);
+    const EntryMap::iterator found = _entries.find(key);
+    if (found != _entries.end()) {
+        evict(found);
+    }
+    Entry entry;
+    entry.fileStat = fileStat;
+    entry.response = response;
+    entry.lastUse = 0;  // NOTE: never a real use, touch() below assigns one
+    const size_t cost = costOf(key, entry);
+    if (cost > _capacityBytes) {
+        return;
+    }
+    while (_sizeBytes + cost > _capacityBytes) {
+        evict(_entries.find(_recency.begin()->second));
+    }
+    const EntryMap::iterator inserted = _entries.insert(std::make_pair(key, entry)).first;
+    touch(inserted);
+    _sizeBytes += cost;
+}
+
+size_t StaticFileCache::getSizeBytes() const {
+    return (_sizeBytes);
+}
+
+size_t StaticFileCache::getEntryCount() const {
+    return (_entries.size());
+}
+}  // namespace webserver
@@ -0,0 +1,67 @@
+#ifndef STATICFILECACHE_HPP
+#define STATICFILECACHE_HPP
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include "logger/Logger.hpp"
+#include "response/Response.hpp"
+
+namespace webserver {
+/* NOTE: ready responses for small static files, keyed by the resolved path.
+* a hit costs one stat() instead of the checks, open() and read() of serving from disk:
+* the entry is used only while the file still has the device, inode, size, mtime and ctime
+* it had when it was read, otherwise it is dropped and the file is served from disk again.
+* only inline bodies are kept, bigger files go with sendfile() and are cheap already.
+* when the bodies and paths held exceed the capacity, least recently used entries go first.
+* a file may have variants next to its own entry, such as its gzip encoding,
+* kept and checked against the file the same way.
+*/
+class StaticFileCache {
+private:
+    struct Entry {
+        struct ::stat fileStat;
+        Response response;
+        unsigned long lastUse;
+    };
+    typedef std::map<std::string, Entry> EntryMap;  // NOTE: path, or path \0 variant: entry
+
+    static Logger _log;
+    size_t _capacityBytes;
+    size_t _sizeBytes;
+    unsigned long _clock;  // NOTE: counts uses, orders entries by recency
+    EntryMap _entries;
+    std::map<unsigned long, std::string> _recency;  // NOTE: last use: path, oldest first
+
+    StaticFileCache();
+    StaticFileCache(const StaticFileCache& other);
+    StaticFileCache& operator=(const StaticFileCache& other);
+
+    static size_t costOf(const std::string& path, const Entry& entry);
+    void touch(EntryMap::iterator entry);
+    void evict(EntryMap::iterator entry);
+    static std::string keyOf(const std::string& path, const std::string& variant);
+
+public:
+    explicit StaticFileCache(size_t capacityBytes);  // NOTE: 0 keeps nothing
+    ~StaticFileCache();
+
+    bool lookup(const std::string& path, Response& response);
+    bool lookup(const std::string& path, const std::string& variant, Response& response);
+    // NOTE: fileStat has to be taken from the descriptor the body was read from
+    void store(const std::string& path, const struct ::stat& fileStat, const Response& response);
+    void store(
+        const std::string& path,
+        const std::string& variant,
+        const struct ::stat& fileStat,
+        const Response& response
+    );
+    size_t getSizeBytes() const;
+    size_t getEntryCount() const;
+};
+}  // namespace webserver
+
+#endif
@@ -14,6 +14,7 @@
 #include "file_system/MimeType.hpp"
 #include "logger/Logger.hpp"
 #include "response/Response.hpp"
+#include "utils/utils.hpp"
 
 using std::map;
 using std::ostream;
@@ -143,12 +144,16 @@ map<int, HttpStatus::Item> HttpStatus::createDefaultStatusMap() {
     addStatus(res, CREATED, "Created");
     addStatus(res, ACCEPTED, "Accepted");
     addStatus(res, NO_CONTENT, "No Content");
+    addStatus(res, PARTIAL_CONTENT, "Partial Content");
     addStatus(res, MOVED_PERMANENTLY, "Moved permanently");
+    addStatus(res, NOT_MODIFIED, "Not Modified");
     addStatus(res, BAD_REQUEST, "Bad Request");
     addStatus(res, FORBIDDEN, "Forbidden");
     addStatus(res, NOT_FOUND, "Not Found");
     addStatus(res, METHOD_NOT_ALLOWED, "Method Not Allowed");
     addStatus(res, PAYLOAD_TOO_LARGE, "Payload Too Large");
+    addStatus(res, URI_TOO_LONG, "URI Too Long");
+    addStatus(res, RANGE_NOT_SATISFIABLE, "Range Not Satisfiable");
     addStatus(res, I_AM_A_TEAPOT, "I am a teapot");
     addStatus(res, REQUEST_HEADER_FIELDS_TOO_LARGE, "Request Header Fields Too Large");
     addStatus(res, INTERNAL_SERVER_ERROR, "Internal Server Error");
@@ -215,9 +220,58 @@ Response HttpStatus::serveStatusPage(int statusCode, string reasonPhrase, string
 }
 
 Response HttpStatus::serveStatusPage(int statusCode) const {
-    return (
-        serveStatusPage(statusCode, getReasonPhrase(statusCode), getPageFileLocation(statusCode))
-    );
+    const string& location = getPageFileLocation(statusCode);
+    const map<std::pair<int, string>, Response>::const_iterator rendered =
+        renderedPages().find(std::make_pair(statusCode, location));
+    if (rendered != renderedPages().end()) {
+        Response response(rendered->second);
+        response.setHeader("Date", utils::getTimestamp());
+        return (response);
+    }
+    return (serveStatusPage(statusCode, getReasonPhrase(statusCode), location));
+}
+
+map<std::pair<int, string>, Response>& HttpStatus::renderedPages() {
+    static map<std::pair<int, string>, Response> pages;
+    return (pages);
+}
+
+void HttpStatus::renderPages() const {
+    const int firstErrorCode = 400;
+    for (map<int, Item>::const_iterator itr = _statusMap.lower_bound(firstErrorCode);
+         itr != _statusMap.end();
+         itr++) {
+        const Response page = serveStatusPage(
+            itr->first,
+            itr->second.getReasonPhrase(),
+            itr->second.getPageFileLocation()
+        );
+        // NOTE: a page big enough to go with sendfile() is left on disk, copies would share the fd
+        if (!page.getFileBody().isSet()) {
+            renderedPages()[std::make_pair(itr->first, itr->second.getPageFileLocation())] = page;
+        }
+    }
+}
+
+void HttpStatus::reloadRenderedPages() {
+    Logger log;
+    map<std::pair<int, string>, Response>& pages = renderedPages();
+    for (map<std::pair<int, string>, Response>::iterator itr = pages.begin();
+         itr != pages.end();) {
+        const int code = itr->first.first;
+        const Response page = serveStatusPage(
+            code,
+            defaultStatusMap().at(code).getReasonPhrase(),
+            itr->first.second
+        );
+        if (page.getFileBody().isSet()) {
+            pages.erase(itr++);
+            continue;
+        }
+        itr->second = page;
+        itr++;
+    }
+    log.stream(LOG_INFO) << "Reloaded " << pages.size() << " status pages\n";
 }
 
 Response HttpStatus::ultimateInternalServerError() {
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 
 #include "response/Response.hpp"
 
@@ -42,6 +43,11 @@ private:
     static void addStatus(std::map<int, Item>& map, int code, const std::string& reasonPhrase);
     static std::map<int, Item> createDefaultStatusMap();
     static Response serveStatusPage(int code, std::string reasonPhrase, std::string uncheckedPath);
+    /* NOTE: code and page file: the complete response made of them.
+    * filled by renderPages() at startup and shared by all catalogues, they are copied around a lot.
+    * so an error is a copy and a fresh Date, with no disk access, however often it happens.
+    */
+    static std::map<std::pair<int, std::string>, Response>& renderedPages();
 
 public:
     HttpStatus();
@@ -61,6 +67,9 @@ public:
 
     const std::string& getPageFileLocation(int code) const;
     Response serveStatusPage(int statusCode) const;
+    void renderPages() const;  // NOTE: error pages only, 4xx and 5xx
+    // NOTE: reads all rendered pages from disk again, for when the files have changed
+    static void reloadRenderedPages();
     static Response ultimateInternalServerError();
     // NOTE: uncustomized, as default as possible, static. use in emergency.
 
@@ -69,12 +78,16 @@ public:
         CREATED = 201,
         ACCEPTED = 202,
         NO_CONTENT = 204,
+        PARTIAL_CONTENT = 206,
         MOVED_PERMANENTLY = 301,
+        NOT_MODIFIED = 304,
         BAD_REQUEST = 400,
         FORBIDDEN = 403,
         NOT_FOUND = 404,
         METHOD_NOT_ALLOWED = 405,
         PAYLOAD_TOO_LARGE = 413,
+        URI_TOO_LONG = 414,
+        RANGE_NOT_SATISFIABLE = 416,
         I_AM_A_TEAPOT = 418,
         REQUEST_HEADER_FIELDS_TOO_LARGE = 431,
         INTERNAL_SERVER_ERROR = 500,
@@ -0,0 +1,86 @@
+#ifndef FDTABLE_HPP
+#define FDTABLE_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace webserver {
+/* NOTE: objects by file descriptor, in a vector indexed by the descriptor itself.
+* the kernel hands out the lowest free descriptor, so the vector stays as long
+* as the peak number of open files: a lookup is one bounds check and one load.
+* the table does not own what it points to.
+*/
+template <typename T>
+class FdTable {
+public:
+    FdTable()
+        : _count(0) {
+    }
+
+    FdTable(const FdTable& other)
+        : _slots(other._slots)
+        , _count(other._count) {
+    }
+
+    FdTable& operator=(const FdTable& other) {
+        _slots = other._slots;
+        _count = other._count;
+        return (*this);
+    }
+
+    ~FdTable() {
+    }
+
+    T* find(int fdesc) const {  // NOTE: NULL if absent
+        if (fdesc < 0 || static_cast<size_t>(fdesc) >= _slots.size()) {
+            return (NULL);
+        }
+        return (_slots[fdesc]);
+    }
+
+    T* at(int fdesc) const {
+        T* value = find(fdesc);
+        if (value == NULL) {
+            throw std::out_of_range("file descriptor not in the table");
+        }
+        return (value);
+    }
+
+    void insert(int fdesc, T* value) {
+        if (static_cast<size_t>(fdesc) >= _slots.size()) {
+            _slots.resize(fdesc + 1, NULL);
+        }
+        if (_slots[fdesc] == NULL) {
+            _count++;
+        }
+        _slots[fdesc] = value;
+    }
+
+    void erase(int fdesc) {
+        if (find(fdesc) != NULL) {
+            _slots[fdesc] = NULL;
+            _count--;
+        }
+    }
+
+    size_t size() const {
+        return (_count);
+    }
+
+    bool empty() const {
+        return (_count == 0);
+    }
+
+    // NOTE: iterate with fd from 0 below this, skipping NULLs; erasing on the way is safe
+    int getUpperBound() const {
+        return (static_cast<int>(_slots.size()));
+    }
+
+private:
+    std::vector<T*> _slots;
+    size_t _count;
+};
+}  // namespace webserver
+
+#endif
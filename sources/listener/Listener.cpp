@@ -5,6 +5,7 @@
 #include <netinet/in.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <cerrno>
@@ -14,19 +15,21 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "configuration/Endpoint.hpp"
 #include "logger/Logger.hpp"
 #include "request/Request.hpp"
+#include "response/Response.hpp"
 
-using std::map;
 using std::runtime_error;
 using std::strerror;
 using std::string;
 
 namespace {
-int setupSocket() {
-    const int socketFd = socket(AF_INET, SOCK_STREAM, 0);
+int setupSocket(bool isPortShared) {
+    // NOTE: close-on-exec, or every CGI child would inherit the listening socket
+    const int socketFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (socketFd == -1) {
         throw runtime_error(string("socket() failed: ") + strerror(errno));
     }
@@ -35,6 +38,10 @@ int setupSocket() {
         close(socketFd);
         throw runtime_error(string("setsockopt() failed: ") + strerror(errno));
     }
+    if (isPortShared && setsockopt(socketFd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1) {
+        close(socketFd);
+        throw runtime_error(string("setsockopt(SO_REUSEPORT) failed: ") + strerror(errno));
+    }
     // NOTE: not sure, subject forbids this flag for MacOS
     // NOTE: for MacOS, fcntl() can only be used with: F_SETFL, O_NONBLOCK, FD_CLOEXEC
     const int flags = fcntl(socketFd, F_GETFL, 0);
@@ -96,11 +103,11 @@ struct ::sockaddr_in Listener::resolveAddress() const {
     return (addr);
 }
 
-Listener::Listener(const Endpoint& configuration)
-    : _interface(configuration.getInterface())
-    , _port(configuration.getPort())
-    , _listeningSocketFd(setupSocket())
-    , _configuration(configuration) {
+Listener::Listener(const std::vector<const Endpoint*>& servers, bool isPortShared)
+    : _interface(servers[0]->getInterface())
+    , _port(servers[0]->getPort())
+    , _listeningSocketFd(setupSocket(isPortShared))
+    , _virtualHosts(servers) {
     struct sockaddr_in addr = resolveAddress();
 
     /* NOTE:
@@ -120,6 +127,10 @@ Listener::Listener(const Endpoint& configuration)
     // clang-format off
     _log.stream(LOG_INFO) << "Listener initialized on " << "http://" << _interface << ":" << _port << " via socket " << _listeningSocketFd << "\n";
     // clang-format on
+    _pooledConnections.reserve(MAX_POOLED_CONNECTIONS);
+    for (size_t i = 0; i < PREALLOCATED_CONNECTIONS; ++i) {
+        _pooledConnections.push_back(new Connection(_virtualHosts));
+    }
 }
 
 string Listener::getResponse(int clientSocketFd) const {
@@ -131,7 +142,12 @@ Listener& Listener::setResponse(int clientSocketFd, string response) {
     return (*this);
 }
 
-Request Listener::getRequestFor(int clientSocketFd) const {
+Listener& Listener::setResponse(int clientSocketFd, const Response& response) {
+    _clientConnections.at(clientSocketFd)->setResponse(response);
+    return (*this);
+}
+
+const Request& Listener::getRequestFor(int clientSocketFd) const {
     return (_clientConnections.at(clientSocketFd)->getRequest());
 }
 
@@ -140,15 +156,50 @@ int Listener::getListeningSocketFd() const {
 }
 
 bool Listener::hasActiveClientSocket(int clientSocketFd) const {
-    return (_clientConnections.find(clientSocketFd) != _clientConnections.end());
+    return (_clientConnections.find(clientSocketFd) != NULL);
 }
 
 int Listener::acceptConnection() {
-    Connection* nconn = new Connection(_listeningSocketFd, _configuration);
-    _clientConnections[nconn->getClientSocketFd()] = nconn;
-    _log.stream(LOG_TRACE) << "CONN_TRACK: Created connection for fd " << nconn->getClientSocketFd()
-                           << "\n";
-    return (nconn->getClientSocketFd());
+    struct sockaddr_in clientAddr;
+    socklen_t clientAddrLen = sizeof(clientAddr);
+    int clientSocketFd = -1;
+    // NOTE: both flags set by the same call, no window where the fd blocks or leaks into a fork
+    do {
+        clientAddrLen = sizeof(clientAddr);
+        clientSocketFd = accept4(
+            _listeningSocketFd,
+            reinterpret_cast<struct sockaddr*>(&clientAddr),
+            &clientAddrLen,
+            SOCK_NONBLOCK | SOCK_CLOEXEC
+        );
+    } while (clientSocketFd == -1 && (errno == EINTR || errno == ECONNABORTED));
+    if (clientSocketFd == -1) {
+        if (errno == EMFILE || errno == ENFILE) {
+            return (OUT_OF_FILE_DESCRIPTORS);
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            _log.stream(LOG_ERROR) << "accept4() failed: " << strerror(errno) << "\n";
+        }
+        return (BACKLOG_EMPTY);
+    }
+    Connection* nconn = NULL;
+    if (_pooledConnections.empty()) {
+        nconn = new Connection(_virtualHosts);
+    } else {
+        nconn = _pooledConnections.back();
+        _pooledConnections.pop_back();
+    }
+    nconn->attachClient(clientSocketFd, clientAddr);
+    _clientConnections.insert(clientSocketFd, nconn);
+    _log.stream(LOG_TRACE) << "CONN_TRACK: Created connection for fd " << clientSocketFd << "\n";
+    return (clientSocketFd);
+}
+
+void Listener::refuseConnection() {
+    const int clientSocketFd = accept4(_listeningSocketFd, NULL, NULL, SOCK_CLOEXEC);
+    if (clientSocketFd != -1) {
+        close(clientSocketFd);
+    }
 }
 
 Connection::State Listener::receiveRequest(int clientSocketFd) {
@@ -159,32 +210,88 @@ Connection::State Listener::generateResponse(int clientSocketFd) {
     return (_clientConnections.at(clientSocketFd)->generateResponse());
 }
 
-void Listener::sendResponse(int clientSocketFd) {
-    _clientConnections.at(clientSocketFd)->sendResponse();
+Connection::State Listener::sendResponse(int clientSocketFd) {
+    return (_clientConnections.at(clientSocketFd)->sendResponse());
 }
 
-const Endpoint& Listener::getConfiguration() const {
-    return (_configuration);
+size_t Listener::getUnsentResponseBytes(int clientSocketFd) const {
+    return (_clientConnections.at(clientSocketFd)->getUnsentResponseBytes());
+}
+
+bool Listener::receiveCgiOutput(int clientSocketFd, const char* data, size_t size) {
+    return (_clientConnections.at(clientSocketFd)->receiveCgiOutput(data, size));
+}
+
+void Listener::finishCgiOutput(int clientSocketFd) {
+    _clientConnections.at(clientSocketFd)->finishCgiOutput();
+}
+
+void Listener::failCgiOutput(int clientSocketFd, HttpStatus::CODE status) {
+    _clientConnections.at(clientSocketFd)->failCgiOutput(status);
 }
 
 void Listener::killConnection(int clientSocketFd) {
     _log.stream(LOG_INFO) << "Killing connection\n";
     _log.stream(LOG_TRACE) << "CONN_TRACK: Killing connection for fd " << clientSocketFd << "\n";
     close(clientSocketFd);
-    const map<int, Connection*>::iterator itr = _clientConnections.find(clientSocketFd);
-    delete itr->second;
-    _clientConnections.erase(itr);
+    Connection* conn = _clientConnections.find(clientSocketFd);
+    if (conn == NULL) {
+        return;
+    }
+    _clientConnections.erase(clientSocketFd);
+    if (_pooledConnections.size() < MAX_POOLED_CONNECTIONS) {
+        conn->release();
+        _pooledConnections.push_back(conn);
+    } else {
+        delete conn;
+    }
+}
+
+bool Listener::isKeepAlive(int clientSocketFd) const {
+    return (_clientConnections.at(clientSocketFd)->isKeepAlive());
+}
+
+bool Listener::isIdleLongerThan(int clientSocketFd, int seconds, time_t now) const {
+    return (_clientConnections.at(clientSocketFd)->isIdleLongerThan(seconds, now));
+}
+
+bool Listener::isWriteStalled(int clientSocketFd, time_t now) const {
+    return (_clientConnections.at(clientSocketFd)->isWriteStalled(now));
+}
+
+int Listener::getKeepAliveTimeoutSeconds(int clientSocketFd) const {
+    return (_clientConnections.at(clientSocketFd)->getKeepAliveTimeoutSeconds());
 }
 
-Connection::State Listener::executeCgi(int clientSocketFd) {
-    return (_clientConnections.at(clientSocketFd)->executeCgi(_configuration));
+void Listener::resetConnection(int clientSocketFd) {
+    _log.stream(LOG_TRACE) << "CONN_TRACK: Keeping connection for fd " << clientSocketFd
+                           << " alive\n";
+    _clientConnections.at(clientSocketFd)->resetForNextRequest();
 }
 
-std::string Listener::getRequestBody(int clientSocketFd) {
+bool Listener::hasBufferedRequestData(int clientSocketFd) const {
+    return (_clientConnections.at(clientSocketFd)->hasBufferedRequestData());
+}
+
+const std::string& Listener::getRequestBody(int clientSocketFd) {
     return (_clientConnections.at(clientSocketFd)->getRequestBody());
 }
 
+const CgiHandlerConfig* Listener::getCgiHandler(int clientSocketFd) {
+    return (_clientConnections.at(clientSocketFd)->getCgiHandler());
+}
+
+std::map<string, string> Listener::getCgiParameters(int clientSocketFd) {
+    return (_clientConnections.at(clientSocketFd)->getCgiParameters());
+}
+
 Listener::~Listener() {
+    for (int fdesc = 0; fdesc < _clientConnections.getUpperBound(); ++fdesc) {
+        delete _clientConnections.find(fdesc);
+    }
+    for (size_t i = 0; i < _pooledConnections.size(); ++i) {
+        delete _pooledConnections[i];
+    }
     if (_listeningSocketFd != -1) {
         close(_listeningSocketFd);
         _listeningSocketFd = -1;
@@ -3,13 +3,21 @@
 #define LISTENER_HPP
 
 #include <netinet/in.h>
+#include <time.h>
 
+#include <cstddef>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "configuration/AppConfig.hpp"
 #include "connection/Connection.hpp"
+#include "file_system/StaticFileCache.hpp"
+#include "http_status/HttpStatus.hpp"
+#include "listener/FdTable.hpp"
+#include "listener/VirtualHosts.hpp"
 #include "logger/Logger.hpp"
+#include "response/Response.hpp"
 
 namespace webserver {
 class Listener {
@@ -19,17 +27,26 @@ private:
     Listener(const Listener& other);
 
     static Logger _log;
+    static const size_t PREALLOCATED_CONNECTIONS = 16;
+    static const size_t MAX_POOLED_CONNECTIONS = 1024;  // NOTE: the rest of a burst is deleted
+
     std::string _interface;
     int _port;
     int _listeningSocketFd;
-    std::map<int, Connection*> _clientConnections;
-    // NOTE: client socket file descriptor: connection
-    const Endpoint& _configuration;
+    VirtualHosts _virtualHosts;  // NOTE: the servers on this interface:port, picked per request
+    FdTable<Connection> _clientConnections;  // NOTE: by client socket file descriptor
+    /* NOTE: closed connections are kept here and handed to the next accepts,
+    * so once the pool has grown to the usual load, accepting allocates nothing
+    */
+    std::vector<Connection*> _pooledConnections;
 
     struct ::sockaddr_in resolveAddress() const;
 
 public:
-    Listener(const Endpoint& configuration);
+    /* NOTE: all the servers given share the interface:port of the first one.
+    * a shared port is bound by every worker process, the kernel spreads accepts among them
+    */
+    Listener(const std::vector<const Endpoint*>& servers, bool isPortShared);
 
     /* NOTE: a Connection creates a socket file descriptor on itself,
     * then we pass it up to MasterListener so that it can create a proper pollfd,
@@ -39,18 +56,33 @@ public:
     int getListeningSocketFd() const;
     bool hasActiveClientSocket(int clientSocketFd) const;
 
-    int acceptConnection();  // NOTE: returns client socket fd
+    static const int BACKLOG_EMPTY = -1;
+    static const int OUT_OF_FILE_DESCRIPTORS = -2;  // NOTE: EMFILE or ENFILE, client still waits
+
+    int acceptConnection();  // NOTE: returns client socket fd, or one of the two above
+    void refuseConnection();  // NOTE: takes the next client off the backlog and closes it at once
     Connection::State receiveRequest(int clientSocketFd);
     Connection::State generateResponse(int clientSocketFd);
     std::string getResponse(int clientSocketFd) const;
     Listener& setResponse(int clientSocketFd, std::string response);
-    const Endpoint& getConfiguration() const;
-    Request getRequestFor(int clientSocketFd) const;
-    void sendResponse(int clientSocketFd);
+    Listener& setResponse(int clientSocketFd, const Response& response);
+    const Request& getRequestFor(int clientSocketFd) const;
+    Connection::State sendResponse(int clientSocketFd);
+    size_t getUnsentResponseBytes(int clientSocketFd) const;
+    bool receiveCgiOutput(int clientSocketFd, const char* data, size_t size);
+    void finishCgiOutput(int clientSocketFd);
+    void failCgiOutput(int clientSocketFd, HttpStatus::CODE status);
     void killConnection(int clientSocketFd);
+    bool isKeepAlive(int clientSocketFd) const;
+    bool isIdleLongerThan(int clientSocketFd, int seconds, time_t now) const;
+    int getKeepAliveTimeoutSeconds(int clientSocketFd) const;
+    bool isWriteStalled(int clientSocketFd, time_t now) const;
+    void resetConnection(int clientSocketFd);
+    bool hasBufferedRequestData(int clientSocketFd) const;
 
-    Connection::State executeCgi(int clientSocketFd);
-    std::string getRequestBody(int clientSocketFd);
+    const std::string& getRequestBody(int clientSocketFd);
+    const CgiHandlerConfig* getCgiHandler(int clientSocketFd);
+    std::map<std::string, std::string> getCgiParameters(int clientSocketFd);
 
     ~Listener();
 };
@@ -1,8 +1,8 @@
 #include "MasterListener.hpp"
 
+#include <poll.h>
 #include <signal.h>
 #include <string.h>
-#include <sys/poll.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -16,6 +16,7 @@
 
 #include "cgi_handler/CgiProcessManager.hpp"
 #include "connection/Connection.hpp"
+#include "event_backend/EventBackend.hpp"
 #include "http_status/HttpStatus.hpp"
 #include "listener/Listener.hpp"
 #include "logger/Logger.hpp"
@@ -33,24 +34,63 @@ namespace webserver {
 Connection::State MasterListener::callCgi(Listener* listener, int activeFd) {
     _log.stream(LOG_TRACE) << "processing cgi request: " << listener->getRequestFor(activeFd)
                            << "\n";
-    const string requestBody = listener->getRequestBody(activeFd);
+    const CgiHandlerConfig* cgiConfig = listener->getCgiHandler(activeFd);
+    if (cgiConfig == NULL) {
+        listener->failCgiOutput(activeFd, HttpStatus::INTERNAL_SERVER_ERROR);
+        markResponseReadyForReturn(activeFd);
+        return (Connection::WRITING);
+    }
+    if (cgiConfig->isFastCgi() || cgiConfig->hasWorkerPool()) {
+        return (callFastCgi(listener, activeFd, *cgiConfig));
+    }
+    const string& requestBody = listener->getRequestBody(activeFd);
 
     int controlPipeReadEnd = -1;
     int responsePipeReadEnd = -1;
+    int requestPipeWriteEnd = -1;
 
     const pid_t pid = CgiProcessManager::startCgiProcess(
-        listener,
-        activeFd,
-        requestBody,
+        cgiConfig->getExecutablePath(),
+        listener->getCgiParameters(activeFd),
         controlPipeReadEnd,
-        responsePipeReadEnd
+        responsePipeReadEnd,
+        requestPipeWriteEnd
     );
+    if (pid == -1) {
+        listener->failCgiOutput(activeFd, HttpStatus::INTERNAL_SERVER_ERROR);
+        markResponseReadyForReturn(activeFd);
+        return (Connection::WRITING);
+    }
 
     _cgiManager.registerWorker(activeFd, pid);
     registerResponseWorker(controlPipeReadEnd, responsePipeReadEnd, activeFd);
+    _cgiManager.registerInput(requestPipeWriteEnd, activeFd, requestBody);
+    // NOTE: most bodies fit into the pipe buffer right away, the rest waits for POLLOUT
+    if (_cgiManager.writeInput(requestPipeWriteEnd)) {
+        _cgiManager.dropInput(requestPipeWriteEnd);
+    } else {
+        _eventBackend->add(requestPipeWriteEnd, POLLOUT, EventBackend::LEVEL_TRIGGERED);
+    }
     return (Connection::WRITING);
 }
 
+void MasterListener::handleCgiInput(int pipeFd, short revents) {
+    // NOTE: POLLERR on a writing end: the script closed its stdin, the rest of the body is moot
+    if ((revents & POLLERR) > 0 || _cgiManager.writeInput(pipeFd)) {
+        removePollFd(pipeFd);
+        _cgiManager.dropInput(pipeFd);
+    }
+}
+
+// NOTE: the input points into the client's request body, it must not outlive the script's worker
+void MasterListener::dropCgiInput(int clientFd) {
+    const int inputFd = _cgiManager.findInput(clientFd);
+    if (inputFd != -1) {
+        removePollFd(inputFd);
+        _cgiManager.dropInput(inputFd);
+    }
+}
+
 Connection::State MasterListener::generateResponse(Listener* listener, int activeFd) {
     const Connection::State connState = listener->generateResponse(activeFd);
     if (connState != Connection::WRITING_COMPLETE &&
@@ -65,43 +105,50 @@ Connection::State MasterListener::generateResponse(Listener* listener, int activ
 }
 
 Connection::State MasterListener::isItANewConnectionOnAListeningSocket(int activeFd) {
-    Listener* listener = findListener(_listeners, activeFd);
+    Listener* listener = _listeners.find(activeFd);
     if (listener == NULL) {
         return (Connection::IGNORED);
     }
-    const int clientSocket = registerNewConnection(activeFd, listener);
-    _clientListeners[clientSocket] = listener;
-    _log.stream(LOG_TRACE) << "CONN_TRACK: Added fd " << clientSocket
-                           << " to _clientListeners map (total: " << _clientListeners.size()
-                           << ")\n";
+    // NOTE: drain the backlog up to the budget, one wakeup accepts a whole burst
+    for (int accepted = 0; accepted < _acceptBatch; ++accepted) {
+        const int clientSocket = registerNewConnection(activeFd, listener);
+        if (clientSocket == Listener::OUT_OF_FILE_DESCRIPTORS) {
+            shedConnection(listener);
+            break;
+        }
+        if (clientSocket < 0) {
+            break;
+        }
+        _clientListeners.insert(clientSocket, listener);
+        _log.stream(LOG_TRACE) << "CONN_TRACK: Added fd " << clientSocket
+                               << " to _clientListeners map (total: " << _clientListeners.size()
+                               << ")\n";
+    }
     return (Connection::NEWBORN);
 }
 
 Connection::State MasterListener::isItADataRequestOnAClientSocketFromARegisteredClient(
-    ::pollfd& activeFd
+    int activeFd
 ) {
-    Listener* listener = findListener(_clientListeners, activeFd.fd);
+    Listener* listener = _clientListeners.find(activeFd);
     if (listener == NULL) {
         return (Connection::IGNORED);
     }
-    _log.stream(LOG_TRACE) << "Existing client on socket fd " << activeFd.fd << " has sent data\n"
-                           << "CONN_TRACK: Processing data for fd " << activeFd.fd << "\n";
-    Connection::State connState = listener->receiveRequest(activeFd.fd);
+    _log.stream(LOG_TRACE) << "Existing client on socket fd " << activeFd << " has sent data\n"
+                           << "CONN_TRACK: Processing data for fd " << activeFd << "\n";
+    Connection::State connState = listener->receiveRequest(activeFd);
     if (connState == Connection::CLOSED_BY_CLIENT) {
-        _log.stream(LOG_TRACE) << "Client on socket fd " << activeFd.fd
+        _log.stream(LOG_TRACE) << "Client on socket fd " << activeFd
                                << " closed the connection before completing the request\n";
-        markConnectionClosedToAvoidRequestOverlapping(activeFd);
-        _clientListeners.erase(_clientListeners.find(activeFd.fd));
-        listener->killConnection(activeFd.fd);
-        removePollFd(activeFd.fd);
+        closeClientConnection(activeFd);
         return (connState);
     }
     if (connState == Connection::READING_COMPLETE || connState == Connection::METHOD_NOT_ALLOWED ||
         connState == Connection::BAD_REQUEST_READ) {
         markConnectionClosedToAvoidRequestOverlapping(activeFd);
-        connState = generateResponse(listener, activeFd.fd);
+        connState = generateResponse(listener, activeFd);
         if (connState == Connection::REROUTING_BACK_TO_CGI) {
-            return (callCgi(listener, activeFd.fd));
+            return (callCgi(listener, activeFd));
         }
     }
     return (connState);  // NOTE: READING
@@ -120,49 +167,78 @@ Connection::State MasterListener::isItAControlMessageFromAResponseGeneratorWorke
     return (connState);
 }
 
-Connection::State MasterListener::isItAResponseFromAResponseGeneratorWorker(int activeFd) {
-    const map<int, int>::iterator responseReadyFor = _responseWorkers.find(activeFd);
-    if (responseReadyFor == _responseWorkers.end()) {
-        return (Connection::IGNORED);
+void MasterListener::handleCgiOutput(int pipeFd) {
+    const int clientFd = _responseWorkers[pipeFd];
+    Listener* client = _clientListeners.find(clientFd);
+    if (client == NULL) {
+        _log.stream(LOG_ERROR) << "Couldn't find client listener for client " << clientFd
+                               << ", dropping CGI output\n";
+        dropCgiOutput(pipeFd);
+        return;
     }
-
-    const int clientFd = responseReadyFor->second;
-
-    _log.stream(LOG_TRACE) << "Response for " << clientFd << " made by worker on fd "
-                           << responseReadyFor->first << " is being picked up by main thread\n";
-    const string rawOutput = readStringAndClose(responseReadyFor->first);
-    _log.stream(LOG_TRACE) << rawOutput << "\n";
-
-    string finalResponse;
-    if (_cgiManager.isWorker(clientFd)) {
-        _log.stream(LOG_DEBUG) << "Parsing CGI output for client " << clientFd << "\n";
-        Listener* client = findListener(_clientListeners, clientFd);
-        if (client == NULL) {
-            _log.stream(LOG_ERROR) << "Couldn't find client listener for client " << clientFd
-                                   << ", cannot validate original request, cannot form a response, "
-                                      "aborting connection\n";
-            finalResponse = HttpStatus::ultimateInternalServerError().serialize();
+    char buffer[CGI_READ_BUFFER_SIZE];
+    while (client->getUnsentResponseBytes(clientFd) < CGI_OUTPUT_BACKLOG_BYTES) {
+        const ssize_t bytesRead = read(pipeFd, buffer, sizeof(buffer));
+        if (bytesRead > 0) {
+            _cgiManager.touchWorker(clientFd);
+            if (!client->receiveCgiOutput(clientFd, buffer, bytesRead)) {
+                kill(_cgiManager.getProcessId(clientFd), SIGKILL);
+                cleanupCgiProcess(clientFd, false);
+                markResponseReadyForReturn(clientFd);
+                return;
+            }
+            continue;
+        }
+        if (bytesRead == -1 && errno == EAGAIN) {
+            if (client->getUnsentResponseBytes(clientFd) > 0) {
+                markResponseReadyForReturn(clientFd);
+            }
+            return;
+        }
+        _log.stream(LOG_DEBUG) << "Response pipe " << pipeFd << " closed for client " << clientFd
+                               << "\n";
+        if (bytesRead == 0) {
+            client->finishCgiOutput(clientFd);
         } else {
-            finalResponse =
-                CgiProcessManager::parseCgiResponse(rawOutput, client->getConfiguration());
+            client->failCgiOutput(clientFd, HttpStatus::BAD_GATEWAY);
         }
-        _cgiManager.unregisterWorker(clientFd);
-    } else {
-        finalResponse = rawOutput;
+        dropCgiOutput(pipeFd);
+        dropCgiInput(clientFd);  // NOTE: a script done with its output has no use for the rest
+        _cgiManager.cleanupProcess(clientFd);
+        markResponseReadyForReturn(clientFd);
+        return;
     }
-
-    _clientListeners.at(clientFd)->setResponse(clientFd, finalResponse);
+    // NOTE: the client reads slower than the script writes, the pipe fills up and holds it
+    _eventBackend->modify(pipeFd, 0);
     markResponseReadyForReturn(clientFd);
-    removePollFd(responseReadyFor->first);
-    _responseWorkers.erase(responseReadyFor);
-    return (Connection::WRITING_COMPLETE);
+}
+
+void MasterListener::dropCgiOutput(int pipeFd) {
+    removePollFd(pipeFd);
+    close(pipeFd);
+    _responseWorkers.erase(pipeFd);
+}
+
+void MasterListener::resumeCgiOutput(int clientFd) {
+    for (map<int, int>::iterator it = _responseWorkers.begin(); it != _responseWorkers.end();
+         ++it) {
+        if (it->second == clientFd) {
+            // NOTE: re-arming also reports output that was left in the pipe
+            _eventBackend->modify(it->first, POLLIN);
+        }
+    }
+    for (map<string, FastCgiPool*>::iterator it = _fastCgiPools.begin();
+         it != _fastCgiPools.end();
+         ++it) {
+        it->second->resumeOutput(clientFd);
+    }
 }
 
 Connection::State
-MasterListener::handleIncomingConnection(::pollfd& activeFd, bool& acceptingNewConnections) {
+MasterListener::handleIncomingConnection(int activeFd, bool& acceptingNewConnections) {
     Connection::State ret;
     if (acceptingNewConnections) {
-        ret = isItANewConnectionOnAListeningSocket(activeFd.fd);
+        ret = isItANewConnectionOnAListeningSocket(activeFd);
         if (ret != Connection::IGNORED) {
             return (ret);
         }
@@ -175,7 +251,7 @@ MasterListener::handleIncomingConnection(::pollfd& activeFd, bool& acceptingNewC
         }
         return (ret);
     }
-    ret = isItAControlMessageFromAResponseGeneratorWorker(activeFd.fd);
+    ret = isItAControlMessageFromAResponseGeneratorWorker(activeFd);
     if (ret != Connection::IGNORED) {
         if (ret == Connection::SERVER_SHUTTING_DOWN) {
             handleShutdownSignal();
@@ -183,72 +259,71 @@ MasterListener::handleIncomingConnection(::pollfd& activeFd, bool& acceptingNewC
         }
         return (ret);
     }
-    ret = isItAResponseFromAResponseGeneratorWorker(activeFd.fd);
-    if (ret != Connection::IGNORED) {
-        return (ret);
-    }
-    _log.stream(LOG_WARN) << "Unknown socket fd " << activeFd.fd << " has sent data, ignoring\n";
+    _log.stream(LOG_WARN) << "Unknown socket fd " << activeFd << " has sent data, ignoring\n";
     return (Connection::IGNORED);
 }
 
-void MasterListener::handleOutgoingConnection(const ::pollfd& activeFd) {
-    _log.stream(LOG_TRACE) << "Starting sending response back to " << activeFd.fd << "\n";
-    Listener* listener = findListener(_clientListeners, activeFd.fd);
+void MasterListener::handleOutgoingConnection(int activeFd, bool& acceptingNewConnections) {
+    _log.stream(LOG_TRACE) << "Starting sending response back to " << activeFd << "\n";
+    Listener* listener = _clientListeners.find(activeFd);
 
     if (listener == NULL) {
-        _log.stream(LOG_WARN) << "Tried to send data to an unknown socket fd " << activeFd.fd
+        _log.stream(LOG_WARN) << "Tried to send data to an unknown socket fd " << activeFd
                               << ", ignoring\n";
         return;
     }
-    listener->sendResponse(activeFd.fd);
-    // NOTE: no keep-alive in HTTP 1.0, so killing right away
-    // NOTE: if he wants to go on, he'd have to go to listening socket again
-    _log.stream(LOG_INFO) << "Sent response to socket fd " << activeFd.fd << "\n";
-    _log.stream(LOG_TRACE) << "CONN_TRACK: Removing fd " << activeFd.fd
-                           << " from _clientListeners (before: " << _clientListeners.size()
-                           << ")\n";
-    _clientListeners.erase(_clientListeners.find(activeFd.fd));
-    _log.stream(LOG_TRACE) << "CONN_TRACK: Removed fd " << activeFd.fd
-                           << " from _clientListeners (after: " << _clientListeners.size() << ")\n";
-    listener->killConnection(activeFd.fd);
-    removePollFd(activeFd.fd);
-}
-
-Connection::State MasterListener::handleResponseWorkerContent(int activeFd) {
-    const map<int, int>::iterator responseIt = _responseWorkers.find(activeFd);
-    if (responseIt == _responseWorkers.end()) {
-        return (Connection::IGNORED);
+    const Connection::State connState = listener->sendResponse(activeFd);
+    if (connState == Connection::WRITING) {
+        // NOTE: re-arming also re-reports an edge-triggered socket that is still writable
+        _eventBackend->modify(activeFd, POLLOUT);
+        return;
     }
-    const int clientFd = responseIt->second;
-    _log.stream(LOG_DEBUG) << "Response pipe " << activeFd << " closed for client " << clientFd
-                           << "\n";
-
-    const string rawOutput = readStringAndClose(activeFd);
-
-    string finalResponse;
-    if (_cgiManager.isWorker(clientFd)) {
-        _log.stream(LOG_DEBUG) << "Parsing CGI output for client " << clientFd << "\n";
-        Listener* client = findListener(_clientListeners, clientFd);
-        if (client == NULL) {
-            _log.stream(LOG_ERROR) << "Couldn't find client listener for client " << clientFd
-                                   << ", cannot validate original request, cannot form a response, "
-                                      "aborting connection\n";
-            finalResponse = HttpStatus::ultimateInternalServerError().serialize();
-            markResponseReadyForReturn(clientFd);
-            removePollFd(activeFd);
-            _responseWorkers.erase(responseIt);
+    if (connState == Connection::WRITING_PAUSED) {
+        // NOTE: nothing to send until the CGI writes more, handleCgiOutput() re-arms the socket
+        _eventBackend->modify(activeFd, 0);
+        resumeCgiOutput(activeFd);
+        return;
+    }
+    if (connState == Connection::CLOSED_BY_CLIENT) {
+        _log.stream(LOG_DEBUG) << "Client on socket fd " << activeFd
+                               << " went away before the response was sent\n";
+        closeClientConnection(activeFd);
+        return;
+    }
+    _log.stream(LOG_INFO) << "Sent response to socket fd " << activeFd << "\n";
+    if (acceptingNewConnections && listener->isKeepAlive(activeFd)) {
+        // NOTE: same socket, fresh request; the client may already have pipelined it
+        listener->resetConnection(activeFd);
+        _eventBackend->modify(activeFd, POLLIN);
+        if (listener->hasBufferedRequestData(activeFd)) {
+            // NOTE: no readiness event will announce bytes that were already read
+            handleIncomingConnection(activeFd, acceptingNewConnections);
         }
-        finalResponse = CgiProcessManager::parseCgiResponse(rawOutput, client->getConfiguration());
-        _cgiManager.unregisterWorker(clientFd);
-    } else {
-        finalResponse = rawOutput;
+        return;
     }
+    closeClientConnection(activeFd);
+}
 
-    _clientListeners.at(clientFd)->setResponse(clientFd, finalResponse);
-    markResponseReadyForReturn(clientFd);
-    removePollFd(activeFd);
-    _responseWorkers.erase(responseIt);
-    return (Connection::RECEIVED_RESPONSE_FROM_WORKER);
+void MasterListener::closeClientConnection(int clientFd) {
+    Listener* listener = _clientListeners.find(clientFd);
+    if (listener == NULL) {
+        return;
+    }
+    // NOTE: a script still working for this client would only be talking to a reused fd later
+    const pid_t cgiPid = _cgiManager.getProcessId(clientFd);
+    if (cgiPid > 0) {
+        kill(cgiPid, SIGKILL);
+        cleanupCgiProcess(clientFd, false);
+    }
+    cancelFastCgiRequest(clientFd);
+    _log.stream(LOG_TRACE) << "CONN_TRACK: Removing fd " << clientFd
+                           << " from _clientListeners (before: " << _clientListeners.size()
+                           << ")\n";
+    _clientListeners.erase(clientFd);
+    _log.stream(LOG_TRACE) << "CONN_TRACK: Removed fd " << clientFd
+                           << " from _clientListeners (after: " << _clientListeners.size() << ")\n";
+    removePollFd(clientFd);
+    listener->killConnection(clientFd);
 }
 
 Connection::State MasterListener::handleResponseWorkerStatusReport(int activeFd) {
@@ -265,29 +340,45 @@ Connection::State MasterListener::handleResponseWorkerStatusReport(int activeFd)
 }
 
 void MasterListener::handlePollEvents(bool& acceptingNewConnections) {
-    for (size_t i = 0; i < _pollFds.size(); i++) {
-        if ((_pollFds[i].revents & (POLLHUP | POLLERR)) > 0) {
-            if (handleResponseWorkerContent(_pollFds[i].fd) ==
-                Connection::RECEIVED_RESPONSE_FROM_WORKER) {
+    for (size_t i = 0; i < _readyEvents.size(); i++) {
+        const int activeFd = _readyEvents[i].fd;
+        const short revents = _readyEvents[i].events;
+        if (_cgiManager.isInput(activeFd)) {
+            handleCgiInput(activeFd, revents);
+            continue;
+        }
+        FastCgiPool* fastCgiPool = findFastCgiPool(activeFd);
+        if (fastCgiPool != NULL) {
+            handleFastCgiEvent(*fastCgiPool, activeFd, revents);
+            continue;
+        }
+        if (_responseWorkers.find(activeFd) != _responseWorkers.end()) {
+            handleCgiOutput(activeFd);
+            continue;
+        }
+        if ((revents & (POLLHUP | POLLERR)) > 0) {
+            if (handleResponseWorkerStatusReport(activeFd) ==
+                Connection::RECEIVED_STATUS_FROM_WORKER) {
                 continue;
             }
-            if (handleResponseWorkerStatusReport(_pollFds[i].fd) ==
-                Connection::RECEIVED_STATUS_FROM_WORKER) {
+            if (_clientListeners.find(activeFd) != NULL) {
+                _log.stream(LOG_DEBUG) << "Client on socket fd " << activeFd << " hung up\n";
+                closeClientConnection(activeFd);
                 continue;
             }
-            close(_pollFds[i].fd);
-            removePollFd(_pollFds[i].fd);
+            removePollFd(activeFd);
+            close(activeFd);
             continue;
         }
 
-        if ((_pollFds[i].revents & POLLIN) > 0) {
+        if ((revents & POLLIN) > 0) {
             // NOTE: something happened on that listening socket, let's dive in
-            handleIncomingConnection(_pollFds[i], acceptingNewConnections);
+            handleIncomingConnection(activeFd, acceptingNewConnections);
             continue;
         }
-        if ((_pollFds[i].revents & POLLOUT) > 0) {
+        if ((revents & POLLOUT) > 0) {
             // NOTE: the response is ready to be sent back
-            handleOutgoingConnection(_pollFds[i]);
+            handleOutgoingConnection(activeFd, acceptingNewConnections);
             continue;
         }
     }
@@ -300,21 +391,34 @@ void MasterListener::listenAndHandle(
     bool acceptingNewConnections = true;
 
     populateFdsFromListeners();
+    _log.stream(LOG_INFO) << "Waiting for events with "
+                          << eventBackendTypeToString(_eventBackend->getType()) << "\n";
     while (isRunning == 1) {
-        resetPollEvents();
-        const int ret = poll(_pollFds.data(), _pollFds.size(), -1);
-        if (ret == -1) {
-            if (errno != EINTR) {
-                throw runtime_error(string("poll() failed: ") + strerror(errno));
-            }
-            if ((signals & SIG_SHUTDOWN) != 0) {
-                handleShutdownSignal();
-                acceptingNewConnections = false;
-            }
+        const int ret = _eventBackend->wait(_readyEvents, IDLE_SWEEP_INTERVAL_MS);
+        if (ret == -1 && errno != EINTR) {
+            throw runtime_error(
+                eventBackendTypeToString(_eventBackend->getType()) + " wait failed: " +
+                strerror(errno)
+            );
+        }
+        // NOTE: a signal landing outside wait() does not interrupt it, so look every round
+        if ((signals & SIG_SHUTDOWN) != 0 && acceptingNewConnections) {
+            handleShutdownSignal();
+            acceptingNewConnections = false;
+        }
+        if ((signals & SIG_RELOAD) != 0) {
+            signals &= ~SIG_RELOAD;
+            HttpStatus::reloadRenderedPages();
         }
         checkCgiTimeouts();
         reapChildren();
         handlePollEvents(acceptingNewConnections);
+        const time_t now = time(NULL);
+        if (now != _lastIdleSweep) {
+            _lastIdleSweep = now;
+            cleanupIdleConnections(false);
+            maintainFastCgiPools(now);
+        }
         if (!acceptingNewConnections && shouldContinueRunning()) {
             isRunning = 0;
         }
@@ -326,7 +430,7 @@ void MasterListener::handleShutdownSignal() {
                           << _clientListeners.size() << " existing connections left\n";
 
     cleanupTimedOutCgiProcesses();
-    cleanupIdleConnections();
+    cleanupIdleConnections(true);
 }
 
 void MasterListener::cleanupTimedOutCgiProcesses() {
@@ -340,46 +444,57 @@ void MasterListener::cleanupTimedOutCgiProcesses() {
     }
 }
 
-void MasterListener::cleanupIdleConnections() {
-    for (map<int, Listener*>::iterator it = _clientListeners.begin();
-         it != _clientListeners.end();) {
-        const int clientFd = it->first;
-        Listener* listener = it->second;
+void MasterListener::cleanupIdleConnections(bool shuttingDown) {
+    const time_t now = time(NULL);
+    for (int clientFd = 0; clientFd < _clientListeners.getUpperBound(); ++clientFd) {
+        Listener* listener = _clientListeners.find(clientFd);
+        if (listener == NULL) {
+            continue;
+        }
 
         if (!listener->hasActiveClientSocket(clientFd)) {
             _log.stream(LOG_WARN) << "Connection fd " << clientFd
                                   << " in _clientListeners but not in listener's connections!\n";
-            _clientListeners.erase(it);
-            it = _clientListeners.begin();
+            _clientListeners.erase(clientFd);
             continue;
         }
 
-        const Request req = listener->getRequestFor(clientFd);
-        if (!req.isRequestTargetReceived()) {
-            _log.stream(LOG_INFO) << "Forcing closure of idle connection fd " << clientFd
-                                  << " during shutdown\n";
-            removePollFd(clientFd);
-            listener->killConnection(clientFd);
-            _clientListeners.erase(it);
-            it = _clientListeners.begin();
+        if (listener->isWriteStalled(clientFd, now)) {
+            _log.stream(LOG_DEBUG) << "Closing connection fd " << clientFd
+                                   << ", the client stopped reading the response\n";
+            closeClientConnection(clientFd);
+            continue;
+        }
+
+        const int timeout = listener->getKeepAliveTimeoutSeconds(clientFd);
+        if (timeout > 0 && listener->isIdleLongerThan(clientFd, timeout, now)) {
+            _log.stream(LOG_DEBUG) << "Closing connection fd " << clientFd << " idle for "
+                                   << timeout << "s\n";
+            closeClientConnection(clientFd);
             continue;
         }
 
-        ++it;
+        if (shuttingDown && !listener->getRequestFor(clientFd).isRequestTargetReceived()) {
+            _log.stream(LOG_INFO) << "Forcing closure of idle connection fd " << clientFd
+                                  << " during shutdown\n";
+            closeClientConnection(clientFd);
+        }
     }
 }
 
 bool MasterListener::shouldContinueRunning() const {
     _log.stream(LOG_TRACE) << "CONN_TRACK: Dumping all _clientListeners entries:\n";
-    for (map<int, Listener*>::const_iterator itr = _clientListeners.begin();
-         itr != _clientListeners.end();
-         itr++) {
-        _log.stream(LOG_TRACE) << "  CONN_TRACK: fd=" << itr->first << " listener=" << itr->second
+    for (int clientFd = 0; clientFd < _clientListeners.getUpperBound(); ++clientFd) {
+        const Listener* listener = _clientListeners.find(clientFd);
+        if (listener == NULL) {
+            continue;
+        }
+        _log.stream(LOG_TRACE) << "  CONN_TRACK: fd=" << clientFd << " listener=" << listener
                                << " hasActiveClientSocket="
-                               << itr->second->hasActiveClientSocket(itr->first) << "\n";
+                               << listener->hasActiveClientSocket(clientFd) << "\n";
         try {
             _log.stream(LOG_TRACE)
-                << "  CONN_TRACK: request=" << itr->second->getRequestFor(itr->first) << "\n";
+                << "  CONN_TRACK: request=" << listener->getRequestFor(clientFd) << "\n";
         } catch (...) {
             _log.stream(LOG_TRACE) << "  CONN_TRACK: (no request available)\n";
         }
@@ -390,6 +505,8 @@ bool MasterListener::shouldContinueRunning() const {
 void MasterListener::cleanupCgiProcess(int clientFd, bool sendTimeoutResponse) {
     _log.stream(LOG_DEBUG) << "Cleaning up CGI process for client " << clientFd << "\n";
 
+    dropCgiInput(clientFd);
+
     for (map<int, int>::iterator it = _responseWorkers.begin(); it != _responseWorkers.end();) {
         if (it->second == clientFd) {
             close(it->first);
@@ -418,17 +535,9 @@ void MasterListener::cleanupCgiProcess(int clientFd, bool sendTimeoutResponse) {
     _cgiManager.cleanupProcess(clientFd);
 
     if (sendTimeoutResponse) {
-        const map<int, Listener*>::iterator listenerIt = _clientListeners.find(clientFd);
-        if (listenerIt != _clientListeners.end()) {
-            Listener* listener = listenerIt->second;
-
-            listener->setResponse(
-                clientFd,
-                listenerIt->second->getConfiguration()
-                    .getStatusCatalogue()
-                    .serveStatusPage(HttpStatus::GATEWAY_TIMEOUT)
-                    .serialize()
-            );
+        Listener* listener = _clientListeners.find(clientFd);
+        if (listener != NULL) {
+            listener->failCgiOutput(clientFd, HttpStatus::GATEWAY_TIMEOUT);
             markResponseReadyForReturn(clientFd);
         }
     }
@@ -440,6 +549,7 @@ void MasterListener::checkCgiTimeouts() {
     for (size_t i = 0; i < timedOutFds.size(); ++i) {
         cleanupCgiProcess(timedOutFds[i], true);
     }
+    checkFastCgiTimeouts();
 }
 
 }  // namespace webserver
@@ -1,7 +1,6 @@
 #ifndef MASTERLISTENER_HPP
 #define MASTERLISTENER_HPP
 
-#include <poll.h>
 #include <time.h>
 
 #include <map>
@@ -10,56 +9,90 @@
 
 #include "Listener.hpp"
 #include "cgi_handler/CgiProcessManager.hpp"
+#include "cgi_handler/FastCgiPool.hpp"
 #include "configuration/AppConfig.hpp"
+#include "configuration/CgiHandlerConfig.hpp"
+#include "event_backend/EventBackend.hpp"
+#include "listener/FdTable.hpp"
 
 namespace webserver {
 class MasterListener {
 private:
     static Logger _log;
+    // NOTE: upper bound on how late an idle connection is noticed when nothing else happens
+    static const int IDLE_SWEEP_INTERVAL_MS = 1000;
+    static const int CGI_READ_BUFFER_SIZE = 16384;
+    // NOTE: unsent CGI output per client; past it the script waits for the client to catch up
+    static const size_t CGI_OUTPUT_BACKLOG_BYTES = 262144;
 
-    std::vector<struct ::pollfd> _pollFds;
+    EventBackend* _eventBackend;
+    std::vector<EventBackend::Event> _readyEvents;
     /* NOTE:
 	* every Listener is created for a specific interface:port pair,
 	* gets a LISTENING socket file descriptor.
 	* when a new connection comes in on that socket,
 	* we accept it and issue a CLIENT socket file descriptor for the same Listener.
 	* both file descriptors are stored in Listener,
-	* and also in these maps for easier navigation
+	* and also in these tables for easier navigation
 	*/
-    std::map<int, Listener*> _listeners;        // NOTE: listening socket fd: Listener
-    std::map<int, Listener*> _clientListeners;  // NOTE: client socket fd: Listener
+    FdTable<Listener> _listeners;        // NOTE: listening socket fd: Listener
+    FdTable<Listener> _clientListeners;  // NOTE: client socket fd: Listener
     std::map<int, int> _responseWorkerControls;
     // NOTE: reading pipe end fd with an expected control message: client socket fd
     std::map<int, int> _responseWorkers;
     // NOTE: reading pipe end fd with an expected generated response: client socket fd
     CgiProcessManager _cgiManager;
+    // NOTE: a responder socket, or an interpreter with pool sizes: its connections
+    std::map<std::string, FastCgiPool*> _fastCgiPools;
+    time_t _lastIdleSweep;
+    int _acceptBatch;  // NOTE: accepts per wakeup of one listening socket, the rest waits a turn
+    /* NOTE: an open /dev/null kept for the moment the process runs out of descriptors:
+    * closing it frees one, enough to accept and drop the client at the head of the backlog
+    * instead of leaving the listening socket ready forever
+    */
+    int _reserveFd;
 
     MasterListener(const MasterListener& other);
 
     int registerNewConnection(int listeningFd, Listener* listener);
+    void shedConnection(Listener* listener);
     void removePollFd(int fdesc);
     void populateFdsFromListeners();
+    void markConnectionClosedToAvoidRequestOverlapping(int clientFd);
     void
     registerResponseWorker(int controlPipeReadingEnd, int responsePipeReadingEnd, int clientFd);
     void markResponseReadyForReturn(int clientFd);
     Connection::State callCgi(Listener* listener, int activeFd);
+    void handleCgiInput(int pipeFd, short revents);
+    void dropCgiInput(int clientFd);
+    Connection::State
+    callFastCgi(Listener* listener, int activeFd, const CgiHandlerConfig& cgiConfig);
+    FastCgiPool& fastCgiPoolFor(const CgiHandlerConfig& cgiConfig);
+    void startCgiWorkerPools(const AppConfig& configuration);
+    void maintainFastCgiPools(time_t now);
+    FastCgiPool* findFastCgiPool(int fd);
+    void handleFastCgiEvent(FastCgiPool& pool, int fd, short revents);
+    void cancelFastCgiRequest(int clientFd);
+    void checkFastCgiTimeouts();
     Connection::State generateResponse(Listener* listener, int activeFd);
     Connection::State isItANewConnectionOnAListeningSocket(int activeFd);
-    Connection::State isItADataRequestOnAClientSocketFromARegisteredClient(::pollfd& activeFd);
+    Connection::State isItADataRequestOnAClientSocketFromARegisteredClient(int activeFd);
     Connection::State isItAControlMessageFromAResponseGeneratorWorker(int activeFd);
-    Connection::State isItAResponseFromAResponseGeneratorWorker(int activeFd);
-    Connection::State handleIncomingConnection(::pollfd& activeFd, bool& acceptingNewConnections);
-    Connection::State handleResponseWorkerContent(int activeFd);
+    Connection::State handleIncomingConnection(int activeFd, bool& acceptingNewConnections);
+    void handleCgiOutput(int pipeFd);
+    void dropCgiOutput(int pipeFd);
+    void resumeCgiOutput(int clientFd);
     Connection::State handleResponseWorkerStatusReport(int activeFd);
-    void handleOutgoingConnection(const ::pollfd& activeFd);
-    void resetPollEvents();
+    void handleOutgoingConnection(int activeFd, bool& acceptingNewConnections);
+    void closeClientConnection(int clientFd);
     void handlePollEvents(bool& acceptingNewConnections);
     static void reapChildren();
+    static int openReserveFd();
     void cleanupCgiProcess(int clientFd, bool sendTimeoutResponse);
     void checkCgiTimeouts();
     void handleShutdownSignal();
     void cleanupTimedOutCgiProcesses();
-    void cleanupIdleConnections();
+    void cleanupIdleConnections(bool shuttingDown);
     bool shouldContinueRunning() const;
 
 public:
@@ -70,9 +103,6 @@ public:
 
     void listenAndHandle(volatile __sig_atomic_t& isRunning, volatile __sig_atomic_t& signals);
 };
-Listener* findListener(std::map<int, Listener*> where, int byFd);
-void markConnectionClosedToAvoidRequestOverlapping(::pollfd& activeFd);
 Connection::State readControlMessageAndClose(int pipeFd);
-std::string readStringAndClose(int pipeFd);
 }  // namespace webserver
 #endif
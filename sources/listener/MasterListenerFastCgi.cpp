@@ -0,0 +1,171 @@
+#include <time.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "MasterListener.hpp"
+#include "cgi_handler/CgiProcessManager.hpp"
+#include "cgi_handler/CgiWorkerPool.hpp"
+#include "cgi_handler/FastCgiPool.hpp"
+#include "configuration/AppConfig.hpp"
+#include "configuration/CgiHandlerConfig.hpp"
+#include "configuration/Endpoint.hpp"
+#include "configuration/RouteConfig.hpp"
+#include "connection/Connection.hpp"
+#include "http_status/HttpStatus.hpp"
+#include "listener/Listener.hpp"
+#include "logger/Logger.hpp"
+#include "utils/utils.hpp"
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace webserver {
+Connection::State MasterListener::callFastCgi(
+    Listener* listener,
+    int activeFd,
+    const CgiHandlerConfig& cgiConfig
+) {
+    if (!fastCgiPoolFor(cgiConfig).startRequest(
+            activeFd,
+            listener->getCgiParameters(activeFd),
+            listener->getRequestBody(activeFd)
+        )) {
+        listener->failCgiOutput(activeFd, HttpStatus::BAD_GATEWAY);
+        markResponseReadyForReturn(activeFd);
+    }
+    return (Connection::WRITING);
+}
+
+FastCgiPool& MasterListener::fastCgiPoolFor(const CgiHandlerConfig& cgiConfig) {
+    if (cgiConfig.isFastCgi()) {
+        FastCgiPool*& pool = _fastCgiPools["unix:" + cgiConfig.getFastCgiSocketPath()];
+        if (pool == NULL) {
+            pool = new FastCgiPool(cgiConfig.getFastCgiSocketPath(), *_eventBackend);
+        }
+        return (*pool);
+    }
+    const string key = cgiConfig.getExecutablePath() + " pool " +
+                       utils::toString(cgiConfig.getPoolMinWorkers()) + " " +
+                       utils::toString(cgiConfig.getPoolMaxWorkers());
+    FastCgiPool*& pool = _fastCgiPools[key];
+    if (pool == NULL) {
+        pool = new CgiWorkerPool(
+            cgiConfig.getExecutablePath(),
+            *_eventBackend,
+            cgiConfig.getPoolMinWorkers(),
+            cgiConfig.getPoolMaxWorkers()
+        );
+    }
+    return (*pool);
+}
+
+// NOTE: the minimum of every CGI worker pool starts with the server, not with its first request
+void MasterListener::startCgiWorkerPools(const AppConfig& configuration) {
+    const time_t now = time(NULL);
+    const set<Endpoint*>& endpoints = configuration.getEndpoints();
+    for (set<Endpoint*>::const_iterator itr = endpoints.begin(); itr != endpoints.end(); ++itr) {
+        vector<const CgiHandlerConfig*> handlers;
+        const map<string, CgiHandlerConfig*>& serverHandlers = (*itr)->getCgiHandlers();
+        for (map<string, CgiHandlerConfig*>::const_iterator handler = serverHandlers.begin();
+             handler != serverHandlers.end();
+             ++handler) {
+            handlers.push_back(handler->second);
+        }
+        const set<RouteConfig>& routes = (*itr)->getRoutes();
+        for (set<RouteConfig>::const_iterator route = routes.begin(); route != routes.end();
+             ++route) {
+            const map<string, CgiHandlerConfig*>& routeHandlers = route->getCgiHandlers();
+            for (map<string, CgiHandlerConfig*>::const_iterator handler = routeHandlers.begin();
+                 handler != routeHandlers.end();
+                 ++handler) {
+                handlers.push_back(handler->second);
+            }
+        }
+        for (size_t i = 0; i < handlers.size(); ++i) {
+            if (handlers[i]->hasWorkerPool()) {
+                fastCgiPoolFor(*handlers[i]).maintain(now);
+            }
+        }
+    }
+}
+
+void MasterListener::maintainFastCgiPools(time_t now) {
+    for (map<string, FastCgiPool*>::iterator it = _fastCgiPools.begin();
+         it != _fastCgiPools.end();
+         ++it) {
+        it->second->maintain(now);
+    }
+}
+
+FastCgiPool* MasterListener::findFastCgiPool(int fd) {
+    for (map<string, FastCgiPool*>::iterator it = _fastCgiPools.begin();
+         it != _fastCgiPools.end();
+         ++it) {
+        if (it->second->owns(fd)) {
+            return (it->second);
+        }
+    }
+    return (NULL);
+}
+
+void MasterListener::handleFastCgiEvent(FastCgiPool& pool, int fd, short revents) {
+    vector<FastCgiPool::Output> outputs;
+    pool.handleEvent(fd, revents, outputs);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        const int clientFd = outputs[i].clientFd;
+        Listener* client = _clientListeners.find(clientFd);
+        if (client == NULL) {
+            _log.stream(LOG_ERROR) << "Couldn't find client listener for client " << clientFd
+                                   << ", dropping FastCGI output\n";
+            pool.cancelRequest(clientFd);
+            continue;
+        }
+        if (!outputs[i].data.empty() &&
+            !client->receiveCgiOutput(clientFd, outputs[i].data.data(), outputs[i].data.size())) {
+            pool.cancelRequest(clientFd);
+            markResponseReadyForReturn(clientFd);
+            continue;
+        }
+        if (outputs[i].state == FastCgiPool::COMPLETE) {
+            client->finishCgiOutput(clientFd);
+        } else if (outputs[i].state == FastCgiPool::FAILED) {
+            client->failCgiOutput(clientFd, HttpStatus::BAD_GATEWAY);
+        } else if (client->getUnsentResponseBytes(clientFd) >= CGI_OUTPUT_BACKLOG_BYTES) {
+            pool.pauseOutput(clientFd);
+        }
+        markResponseReadyForReturn(clientFd);
+    }
+}
+
+void MasterListener::cancelFastCgiRequest(int clientFd) {
+    for (map<string, FastCgiPool*>::iterator it = _fastCgiPools.begin();
+         it != _fastCgiPools.end();
+         ++it) {
+        it->second->cancelRequest(clientFd);
+    }
+}
+
+void MasterListener::checkFastCgiTimeouts() {
+    vector<int> timedOut;
+    const time_t now = time(NULL);
+    for (map<string, FastCgiPool*>::iterator it = _fastCgiPools.begin();
+         it != _fastCgiPools.end();
+         ++it) {
+        it->second->collectTimedOut(now, CgiProcessManager::DEFAULT_CGI_TIMEOUT_SECONDS, timedOut);
+    }
+    for (size_t i = 0; i < timedOut.size(); ++i) {
+        _log.stream(LOG_WARN) << "FastCGI request for client " << timedOut[i] << " timed out\n";
+        cancelFastCgiRequest(timedOut[i]);
+        Listener* client = _clientListeners.find(timedOut[i]);
+        if (client != NULL) {
+            client->failCgiOutput(timedOut[i], HttpStatus::GATEWAY_TIMEOUT);
+            markResponseReadyForReturn(timedOut[i]);
+        }
+    }
+}
+}  // namespace webserver
@@ -1,13 +1,18 @@
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <cerrno>
 #include <map>
 #include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "MasterListener.hpp"
 #include "configuration/AppConfig.hpp"
 #include "configuration/Endpoint.hpp"
+#include "event_backend/EventBackend.hpp"
 #include "listener/Listener.hpp"
 #include "logger/Logger.hpp"
 
@@ -15,38 +20,69 @@ using std::map;
 using std::ostringstream;
 using std::set;
 using std::string;
+using std::vector;
 
 namespace webserver {
 
 Logger MasterListener::_log;
 
-MasterListener::MasterListener(const AppConfig& configuration) {
+int MasterListener::openReserveFd() {
+    const int fdesc = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (fdesc == -1) {
+        _log.stream(LOG_WARN) << "No reserve descriptor, running out of them will stall accepts\n";
+    }
+    return (fdesc);
+}
+
+MasterListener::MasterListener(const AppConfig& configuration)
+    : _eventBackend(EventBackend::create(configuration.getEventBackend()))
+    , _lastIdleSweep(0)
+    , _acceptBatch(configuration.getAcceptBatch())
+    , _reserveFd(openReserveFd()) {
+    const bool isPortShared = configuration.getWorkerProcesses() > 1;
+    // NOTE: name-based virtual hosts: the servers of one interface:port share a socket
+    map<std::pair<string, int>, vector<const Endpoint*> > byAddress;
     const set<Endpoint*>& endpoints = configuration.getEndpoints();
     for (set<Endpoint*>::const_iterator itr = endpoints.begin(); itr != endpoints.end(); ++itr) {
-        Listener* newListener = new Listener(**itr);
-        _listeners[newListener->getListeningSocketFd()] = newListener;
+        byAddress[std::make_pair((*itr)->getInterface(), (*itr)->getPort())].push_back(*itr);
+    }
+    for (map<std::pair<string, int>, vector<const Endpoint*> >::const_iterator itr =
+             byAddress.begin();
+         itr != byAddress.end();
+         ++itr) {
+        Listener* newListener = new Listener(itr->second, isPortShared);
+        _listeners.insert(newListener->getListeningSocketFd(), newListener);
     }
+    startCgiWorkerPools(configuration);
 }
 
 MasterListener& MasterListener::operator=(const MasterListener& other) {
     if (this == &other) {
         return (*this);
     }
-    _pollFds = other._pollFds;
     _listeners = other._listeners;
     _clientListeners = other._clientListeners;
     return (*this);
 }
 
 MasterListener::~MasterListener() {
-    for (map<int, Listener*>::iterator it = _clientListeners.begin(); it != _clientListeners.end();
-         ++it) {
-        it->second->killConnection(it->first);
+    for (int clientFd = 0; clientFd < _clientListeners.getUpperBound(); ++clientFd) {
+        Listener* listener = _clientListeners.find(clientFd);
+        if (listener != NULL) {
+            listener->killConnection(clientFd);
+        }
     }
-    for (map<int, Listener*>::const_iterator it = _listeners.begin(); it != _listeners.end();
-         ++it) {
-        delete it->second;
+    for (int listeningFd = 0; listeningFd < _listeners.getUpperBound(); ++listeningFd) {
+        delete _listeners.find(listeningFd);
     }  // NOTE: deleting from listeners only, clientListeners contains pointers to the same Listener objects
+    for (map<string, FastCgiPool*>::iterator it = _fastCgiPools.begin(); it != _fastCgiPools.end();
+         ++it) {
+        delete it->second;  // NOTE: unregisters its sockets, so before the event backend goes
+    }
+    delete _eventBackend;
+    if (_reserveFd != -1) {
+        close(_reserveFd);
+    }
 }
 
 }  // namespace webserver
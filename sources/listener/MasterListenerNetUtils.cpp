@@ -1,25 +1,22 @@
+#include <poll.h>
 #include <signal.h>
 #include <string.h>
-#include <sys/poll.h>
 #include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
 #include <cerrno>
 #include <iostream>
-#include <map>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "MasterListener.hpp"
 #include "connection/Connection.hpp"
+#include "event_backend/EventBackend.hpp"
 #include "listener/Listener.hpp"
 #include "logger/Logger.hpp"
 
-using std::map;
-using std::ostringstream;
 using std::runtime_error;
 using std::string;
 using std::vector;
@@ -28,18 +25,6 @@ namespace webserver {
 using webserver::Connection;
 using webserver::Listener;
 
-Listener* findListener(map<int, Listener*> where, int byFd) {
-    const map<int, Listener*>::const_iterator res = where.find(byFd);
-    if (res == where.end()) {
-        return (NULL);
-    }
-    return (res->second);
-}
-
-void markConnectionClosedToAvoidRequestOverlapping(::pollfd& activeFd) {
-    activeFd.events = 0;
-}
-
 Connection::State readControlMessageAndClose(int pipeFd) {
     Connection::State state;
     const ssize_t result = read(pipeFd, &state, sizeof(state));
@@ -58,85 +43,61 @@ Connection::State readControlMessageAndClose(int pipeFd) {
     return (state);
 }
 
-string readStringAndClose(int pipeFd) {
-    const int RESPONSE_STRING_BUFFER_SIZE = 4096;
-    char buffer[RESPONSE_STRING_BUFFER_SIZE];
-    ostringstream oss;
-    ssize_t bytesRead = 0;
-
-    while ((bytesRead = read(pipeFd, buffer, sizeof(buffer))) > 0) {
-        oss << string(buffer, bytesRead);
+int MasterListener::registerNewConnection(int listeningFd, Listener* listener) {
+    _log.stream(LOG_DEBUG) << "A new connection on socket fd " << listeningFd << "\n";
+    const int clientFd = listener->acceptConnection();
+    if (clientFd < 0) {
+        return (clientFd);
     }
-
-    close(pipeFd);
-    return (oss.str());
+    // NOTE: client sockets are drained until EAGAIN, so they can be edge-triggered
+    _eventBackend->add(clientFd, POLLIN, EventBackend::EDGE_TRIGGERED);
+    _log.stream(LOG_DEBUG) << "Connection accepted, client socket " << clientFd << "\n";
+    _log.stream(LOG_TRACE) << "CONN_TRACK: Added fd " << clientFd
+                           << " to _clientListeners (not yet in the table)\n";
+    return (clientFd);
 }
 
-int MasterListener::registerNewConnection(int listeningFd, Listener* listener) {
-    _log.stream(LOG_DEBUG) << "A new connection on socket fd " << listeningFd << "\n";
-    struct ::pollfd clientPfd;
-    clientPfd.fd = listener->acceptConnection();
-    clientPfd.events = POLLIN;
-    clientPfd.revents = 0;
-    _pollFds.push_back(clientPfd);
-    _log.stream(LOG_DEBUG) << "Connection accepted, client socket " << clientPfd.fd << "\n";
-    _log.stream(LOG_TRACE) << "CONN_TRACK: Added fd " << clientPfd.fd
-                           << " to _clientListeners (not yet in map)\n";
-    return (clientPfd.fd);
+void MasterListener::shedConnection(Listener* listener) {
+    _log.stream(LOG_WARN) << "Out of file descriptors, dropping a connection on socket fd "
+                          << listener->getListeningSocketFd() << "\n";
+    if (_reserveFd != -1) {
+        close(_reserveFd);
+    }
+    listener->refuseConnection();
+    _reserveFd = openReserveFd();
 }
 
 void MasterListener::populateFdsFromListeners() {
-    for (map<int, Listener*>::const_iterator it = _listeners.begin(); it != _listeners.end();
-         ++it) {
-        struct ::pollfd pfd;
-        pfd.fd = it->first;
-        pfd.events = POLLIN;
-        pfd.revents = 0;
-        _pollFds.push_back(pfd);
+    for (int listeningFd = 0; listeningFd < _listeners.getUpperBound(); ++listeningFd) {
+        if (_listeners.find(listeningFd) == NULL) {
+            continue;
+        }
+        // NOTE: accepts stop at the batch budget, what is left must be reported again next wakeup
+        _eventBackend->add(listeningFd, POLLIN, EventBackend::LEVEL_TRIGGERED);
     }
 }
 
+void MasterListener::markConnectionClosedToAvoidRequestOverlapping(int clientFd) {
+    _eventBackend->modify(clientFd, 0);
+}
+
 void MasterListener::registerResponseWorker(
     int controlPipeReadingEnd,
     int responsePipeReadingEnd,
     int clientFd
 ) {
-    struct ::pollfd controlPipePollFd;
-    controlPipePollFd.fd = controlPipeReadingEnd;
-    controlPipePollFd.events = POLLIN;
-    controlPipePollFd.revents = 0;
-    _pollFds.push_back(controlPipePollFd);
-    struct ::pollfd responsePipePollFd;
-    responsePipePollFd.fd = responsePipeReadingEnd;
-    responsePipePollFd.events = POLLIN;
-    responsePipePollFd.revents = 0;
-    _pollFds.push_back(responsePipePollFd);
+    _eventBackend->add(controlPipeReadingEnd, POLLIN, EventBackend::EDGE_TRIGGERED);
+    _eventBackend->add(responsePipeReadingEnd, POLLIN, EventBackend::EDGE_TRIGGERED);
     _responseWorkerControls[controlPipeReadingEnd] = clientFd;
     _responseWorkers[responsePipeReadingEnd] = clientFd;
 }
 
 void MasterListener::markResponseReadyForReturn(int clientFd) {
-    for (vector<struct ::pollfd>::iterator itr = _pollFds.begin(); itr != _pollFds.end(); itr++) {
-        if (itr->fd == clientFd) {
-            itr->events = POLLOUT;
-            return;
-        }
-    }
+    _eventBackend->modify(clientFd, POLLOUT);
 }
 
 void MasterListener::removePollFd(int fdesc) {
-    for (vector<pollfd>::iterator it = _pollFds.begin(); it != _pollFds.end(); ++it) {
-        if (it->fd == fdesc) {
-            _pollFds.erase(it);
-            return;
-        }
-    }
-}
-
-void MasterListener::resetPollEvents() {
-    for (size_t i = 0; i < _pollFds.size(); ++i) {
-        _pollFds[i].revents = 0;
-    }
+    _eventBackend->remove(fdesc);
 }
 
 void MasterListener::reapChildren() {
@@ -0,0 +1,92 @@
+#include "VirtualHosts.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "configuration/Endpoint.hpp"
+#include "file_system/StaticFileCache.hpp"
+#include "utils/StringView.hpp"
+#include "utils/utils.hpp"
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace webserver {
+VirtualHosts::VirtualHosts(const vector<const Endpoint*>& servers)
+    : _default(0) {
+    for (size_t i = 0; i < servers.size(); ++i) {
+        Server server;
+        server.configuration = servers[i];
+        server.fileCache = new StaticFileCache(servers[i]->getFileCacheSizeBytes());
+        _servers.push_back(server);
+        if (servers[i]->isDefaultServer()) {
+            _default = i;
+        }
+        const vector<string>& names = servers[i]->getServerNames();
+        for (size_t j = 0; j < names.size(); ++j) {
+            const string name = utils::toLower(names[j]);
+            // NOTE: insert() keeps the first server to claim a name, the config checker forbids more
+            if (name.compare(0, 2, "*.") == 0) {
+                _leadingWildcards.insert(std::make_pair(name.substr(1), i));
+            } else if (name.size() > 1 && name.compare(name.size() - 2, 2, ".*") == 0) {
+                _trailingWildcards.insert(std::make_pair(name.substr(0, name.size() - 1), i));
+            } else {
+                _exactNames.insert(std::make_pair(name, i));
+            }
+        }
+    }
+}
+
+VirtualHosts::~VirtualHosts() {
+    for (size_t i = 0; i < _servers.size(); ++i) {
+        delete _servers[i].fileCache;
+    }
+}
+
+// NOTE: "Example.COM:8080" and "example.com." are both "example.com"
+string VirtualHosts::normalizeHost(const string& host) {
+    size_t end = host.size();
+    if (!host.empty() && host[0] == '[') {
+        const size_t bracket = host.find(']');
+        end = (bracket == string::npos ? host.size() : bracket + 1);
+    } else {
+        const size_t colon = host.find(':');
+        end = (colon == string::npos ? host.size() : colon);
+    }
+    if (end > 0 && host[end - 1] == '.') {
+        end--;
+    }
+    return (utils::toLower(host.substr(0, end)));
+}
+
+const size_t* VirtualHosts::find(const map<string, size_t>& names, const string& name) {
+    const map<string, size_t>::const_iterator found = names.find(name);
+    return (found == names.end() ? NULL : &found->second);
+}
+
+const VirtualHosts::Server& VirtualHosts::select(const StringView& host) const {
+    if (_servers.size() == 1 || host.empty()) {
+        return (_servers[_default]);
+    }
+    const string name = normalizeHost(host.str());
+    const size_t* found = find(_exactNames, name);
+    // NOTE: the longest suffix starts at the first dot, "a.b.example.com" tries ".b.example.com" first
+    for (size_t dot = name.find('.'); found == NULL && dot != string::npos;
+         dot = name.find('.', dot + 1)) {
+        found = find(_leadingWildcards, name.substr(dot));
+    }
+    for (size_t dot = name.rfind('.'); found == NULL && dot != string::npos && dot > 0;
+         dot = name.rfind('.', dot - 1)) {
+        found = find(_trailingWildcards, name.substr(0, dot + 1));
+    }
+    return (_servers[found == NULL ? _default : *found]);
+}
+
+const VirtualHosts::Server& VirtualHosts::getDefault() const {
+    return (_servers[_default]);
+}
+}  // namespace webserver
@@ -0,0 +1,48 @@
+#ifndef VIRTUALHOSTS_HPP
+#define VIRTUALHOSTS_HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "configuration/Endpoint.hpp"
+#include "file_system/StaticFileCache.hpp"
+#include "utils/StringView.hpp"
+
+namespace webserver {
+/* NOTE: the servers sharing one listening socket, told apart by the Host header.
+* the order is nginx's: the exact name, the longest "*.suffix" wildcard, the longest "prefix.*",
+* and the default server of the address when nothing matches or there is no Host at all.
+* names are compared lowercase, without the port. each server keeps its own file cache.
+*/
+class VirtualHosts {
+public:
+    struct Server {
+        const Endpoint* configuration;
+        StaticFileCache* fileCache;
+    };
+
+    explicit VirtualHosts(const std::vector<const Endpoint*>& servers);
+    ~VirtualHosts();
+
+    const Server& select(const StringView& host) const;
+    const Server& getDefault() const;
+
+private:
+    std::vector<Server> _servers;
+    size_t _default;
+    std::map<std::string, size_t> _exactNames;
+    std::map<std::string, size_t> _leadingWildcards;   // NOTE: "*.example.com" kept as ".example.com"
+    std::map<std::string, size_t> _trailingWildcards;  // NOTE: "www.example.*" kept as "www.example."
+
+    static std::string normalizeHost(const std::string& host);
+    static const size_t* find(const std::map<std::string, size_t>& names, const std::string& name);
+
+    VirtualHosts();
+    VirtualHosts(const VirtualHosts& other);
+    VirtualHosts& operator=(const VirtualHosts& other);
+};
+}  // namespace webserver
+
+#endif
@@ -0,0 +1,97 @@
+#include "BodySink.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include "http_status/HttpException.hpp"
+#include "http_status/HttpStatus.hpp"
+#include "utils/utils.hpp"
+
+using std::string;
+
+namespace webserver {
+BodySink::~BodySink() {
+}
+
+StringSink::StringSink(string& body)
+    : _body(body) {
+}
+
+StringSink::~StringSink() {
+}
+
+void StringSink::write(const char* data, size_t size) {
+    _body.append(data, size);
+}
+
+/* NOTE: a hidden name next to the target, so the rename stays within one file system.
+* a name left over by an earlier run is skipped, O_EXCL never opens somebody else's file
+*/
+FileSink::FileSink(const string& path)
+    : _path(path)
+    , _fileDescriptor(-1) {
+    static size_t uploads = 0;
+    const size_t slash = path.find_last_of('/');
+    const string folder = (slash == string::npos ? "" : path.substr(0, slash + 1));
+    const string name = (slash == string::npos ? path : path.substr(slash + 1));
+    for (size_t attempt = 0; attempt < MAX_TEMP_NAME_ATTEMPTS; attempt++) {
+        _tempPath = folder + "." + name + ".upload" + utils::toString(uploads++);
+        _fileDescriptor =
+            open(_tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (_fileDescriptor != -1 || errno != EEXIST) {
+            break;
+        }
+    }
+    if (_fileDescriptor == -1) {
+        _tempPath.clear();
+    }
+}
+
+FileSink::~FileSink() {
+    if (_fileDescriptor != -1) {
+        close(_fileDescriptor);
+    }
+    if (!_tempPath.empty()) {
+        std::remove(_tempPath.c_str());
+    }
+}
+
+bool FileSink::isOpen() const {
+    return (_fileDescriptor != -1);
+}
+
+void FileSink::write(const char* data, size_t size) {
+    if (_fileDescriptor == -1) {
+        throw HttpException(HttpStatus::INTERNAL_SERVER_ERROR, "upload file is closed");
+    }
+    while (size > 0) {
+        const ssize_t written = ::write(_fileDescriptor, data, size);
+        if (written <= 0) {
+            throw HttpException(HttpStatus::INTERNAL_SERVER_ERROR, "cannot write " + _tempPath);
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+void FileSink::finish() {
+    if (_fileDescriptor == -1) {
+        throw HttpException(HttpStatus::INTERNAL_SERVER_ERROR, "upload file is closed");
+    }
+    close(_fileDescriptor);
+    _fileDescriptor = -1;
+    const bool isMoved = (std::rename(_tempPath.c_str(), _path.c_str()) == 0);
+    if (!isMoved) {
+        std::remove(_tempPath.c_str());
+    }
+    _tempPath.clear();
+    if (!isMoved) {
+        throw HttpException(HttpStatus::INTERNAL_SERVER_ERROR, "cannot replace " + _path);
+    }
+}
+}  // namespace webserver
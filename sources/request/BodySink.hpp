@@ -0,0 +1,61 @@
+#ifndef BODYSINK_HPP
+#define BODYSINK_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace webserver {
+/* NOTE: where the bytes of a request body go as they are decoded.
+* the decoders hand over pieces of their input buffer as they are, nothing is gathered first.
+*/
+class BodySink {
+public:
+    virtual ~BodySink();
+    virtual void write(const char* data, size_t size) = 0;
+};
+
+// NOTE: the body kept in memory, for the handlers and for a CGI script's stdin
+class StringSink : public BodySink {
+private:
+    std::string& _body;
+
+    StringSink();
+    StringSink(const StringSink& other);
+    StringSink& operator=(const StringSink& other);
+
+public:
+    explicit StringSink(std::string& body);
+    virtual ~StringSink();
+
+    virtual void write(const char* data, size_t size);
+};
+
+/* NOTE: an upload written to a file as it arrives.
+* the bytes go to a temporary file next to the target, created by the constructor;
+* finish() renames it onto the target, which until then stays as it was.
+* the destructor removes the temporary file unless finish() was called:
+* a body that never arrived whole leaves nothing behind and replaces nothing.
+* write() and finish() throw HttpException 500 when the file does not take the bytes.
+*/
+class FileSink : public BodySink {
+private:
+    static const size_t MAX_TEMP_NAME_ATTEMPTS = 16;
+
+    std::string _path;
+    std::string _tempPath;  // NOTE: empty when it could not be created and after finish()
+    int _fileDescriptor;    // NOTE: -1 when it could not be created and after finish()
+
+    FileSink();
+    FileSink(const FileSink& other);
+    FileSink& operator=(const FileSink& other);
+
+public:
+    explicit FileSink(const std::string& path);
+    virtual ~FileSink();
+
+    bool isOpen() const;  // NOTE: false if the file could not be created
+    virtual void write(const char* data, size_t size);
+    void finish();  // NOTE: the body is complete, it replaces the target
+};
+}  // namespace webserver
+#endif
@@ -0,0 +1,180 @@
+#include "ChunkedDecoder.hpp"
+
+#include <cstddef>
+
+#include "http_status/BadRequest.hpp"
+#include "http_status/HttpException.hpp"
+#include "http_status/HttpStatus.hpp"
+#include "http_status/PayloadTooLarge.hpp"
+#include "request/BodySink.hpp"
+
+namespace {
+const int HEX_BASE = 16;
+const int DECIMAL_BASE = 10;
+
+int hexDigit(char chr) {
+    if (chr >= '0' && chr <= '9') {
+        return (chr - '0');
+    }
+    if (chr >= 'a' && chr <= 'f') {
+        return (chr - 'a' + DECIMAL_BASE);
+    }
+    if (chr >= 'A' && chr <= 'F') {
+        return (chr - 'A' + DECIMAL_BASE);
+    }
+    return (-1);
+}
+}  // namespace
+
+namespace webserver {
+ChunkedDecoder::ChunkedDecoder(size_t maxBodyBytes)
+    : _state(SIZE)
+    , _maxBodyBytes(maxBodyBytes)
+    , _bodyBytes(0)
+    , _chunkSize(0)
+    , _chunkBytesLeft(0)
+    , _lineBytes(0) {
+}
+
+ChunkedDecoder::~ChunkedDecoder() {
+}
+
+void ChunkedDecoder::reset(size_t maxBodyBytes) {
+    _state = SIZE;
+    _maxBodyBytes = maxBodyBytes;
+    _bodyBytes = 0;
+    _chunkSize = 0;
+    _chunkBytesLeft = 0;
+    _lineBytes = 0;
+}
+
+size_t ChunkedDecoder::decode(const char* data, size_t size, BodySink* sink) {
+    size_t pos = 0;
+    while (pos < size && _state != COMPLETE) {
+        if (_state == DATA) {
+            size_t count = size - pos;
+            if (count > _chunkBytesLeft) {
+                count = _chunkBytesLeft;
+            }
+            if (sink != NULL) {
+                sink->write(data + pos, count);
+            }
+            pos += count;
+            _bodyBytes += count;
+            _chunkBytesLeft -= count;
+            if (_chunkBytesLeft == 0) {
+                _state = DATA_CR;
+            }
+            continue;
+        }
+        const char chr = data[pos++];
+        switch (_state) {
+            case SIZE:
+            case EXTENSION: {
+                onSizeLineChar(chr);
+                break;
+            }
+            case SIZE_LINE_END: {
+                if (chr != '\n') {
+                    throw BadRequest("invalid line endings");
+                }
+                onSizeLineEnd();
+                break;
+            }
+            case DATA_CR:
+            case DATA_LF: {
+                if (chr != (_state == DATA_CR ? '\r' : '\n')) {
+                    throw BadRequest("invalid chunk body data ending");
+                }
+                _state = (_state == DATA_CR ? DATA_LF : SIZE);
+                break;
+            }
+            case TRAILER: {
+                onTrailerChar(chr);
+                break;
+            }
+            case TRAILER_LINE_END: {
+                if (chr != '\n') {
+                    throw BadRequest("invalid line endings");
+                }
+                // NOTE: trailer fields themselves are dropped, the empty line ends the body
+                _state = (_lineBytes == 0 ? COMPLETE : TRAILER);
+                _lineBytes = 0;
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+    return (pos);
+}
+
+void ChunkedDecoder::onSizeLineChar(char chr) {
+    if (chr == '\n') {
+        throw BadRequest("invalid line endings");
+    }
+    const bool isFirst = (_lineBytes == 0);
+    countLineByte();
+    if (_state == EXTENSION) {
+        if (chr == '\r') {
+            _state = SIZE_LINE_END;
+        }
+        return;
+    }
+    const int digit = hexDigit(chr);
+    if (digit != -1) {
+        const size_t maxSize = static_cast<size_t>(-1);
+        if (_chunkSize > (maxSize - digit) / HEX_BASE) {
+            throw BadRequest("invalid chunk size in chunked body");
+        }
+        _chunkSize = _chunkSize * HEX_BASE + digit;
+        return;
+    }
+    if (isFirst || (chr != ';' && chr != '\r')) {
+        throw BadRequest("invalid chunk size in chunked body");
+    }
+    // NOTE: chunk extensions are allowed by RFC 9112 7.1.1 and carry nothing we use
+    _state = (chr == ';' ? EXTENSION : SIZE_LINE_END);
+}
+
+void ChunkedDecoder::onSizeLineEnd() {
+    _lineBytes = 0;
+    if (_chunkSize == 0) {
+        _state = TRAILER;
+        return;
+    }
+    if (_chunkSize > _maxBodyBytes - _bodyBytes) {
+        throw PayloadTooLarge("request body exceeds maximum allowed size");
+    }
+    _chunkBytesLeft = _chunkSize;
+    _chunkSize = 0;
+    _state = DATA;
+}
+
+void ChunkedDecoder::onTrailerChar(char chr) {
+    if (chr == '\n') {
+        throw BadRequest("invalid line endings");
+    }
+    if (chr == '\r') {
+        _state = TRAILER_LINE_END;
+        return;
+    }
+    countLineByte();
+}
+
+void ChunkedDecoder::countLineByte() {
+    _lineBytes++;
+    if (_lineBytes > MAX_LINE_BYTES) {
+        throw HttpException(HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE, "line too long");
+    }
+}
+
+bool ChunkedDecoder::isComplete() const {
+    return (_state == COMPLETE);
+}
+
+size_t ChunkedDecoder::getBodyBytes() const {
+    return (_bodyBytes);
+}
+}  // namespace webserver
@@ -0,0 +1,62 @@
+#ifndef CHUNKEDDECODER_HPP
+#define CHUNKEDDECODER_HPP
+
+#include <cstddef>
+
+#include "request/BodySink.hpp"
+
+namespace webserver {
+/* NOTE: resumable decoder of a Transfer-Encoding: chunked body, RFC 9112 7.1.
+* it takes the body in whatever pieces recv() gives and keeps only counters between them:
+* the chunk size is accumulated digit by digit, extensions and trailer fields are skipped,
+* and chunk data goes to the sink straight from the input, so memory does not grow with the body.
+* the body size limit is checked against every chunk size as soon as it is read,
+* before any of the chunk's bytes are accepted.
+* protocol errors are thrown as HttpException subclasses.
+*/
+class ChunkedDecoder {
+public:
+    static const size_t MAX_LINE_BYTES = 8192;  // NOTE: a size line or a trailer field
+
+    explicit ChunkedDecoder(size_t maxBodyBytes);
+    ~ChunkedDecoder();
+
+    void reset(size_t maxBodyBytes);  // NOTE: for the next body
+    /* NOTE: decodes what it can of data, writing chunk data to sink, or dropping it when NULL.
+    * returns how many bytes were taken: all of them, unless the body ended before.
+    */
+    size_t decode(const char* data, size_t size, BodySink* sink);
+    bool isComplete() const;
+    size_t getBodyBytes() const;  // NOTE: decoded so far
+
+private:
+    enum State {
+        SIZE,
+        EXTENSION,
+        SIZE_LINE_END,
+        DATA,
+        DATA_CR,
+        DATA_LF,
+        TRAILER,
+        TRAILER_LINE_END,
+        COMPLETE
+    };
+
+    State _state;
+    size_t _maxBodyBytes;
+    size_t _bodyBytes;
+    size_t _chunkSize;  // NOTE: while in SIZE, the digits read so far
+    size_t _chunkBytesLeft;
+    size_t _lineBytes;  // NOTE: of the size line or the trailer field being skipped
+
+    ChunkedDecoder();
+    ChunkedDecoder(const ChunkedDecoder& other);
+    ChunkedDecoder& operator=(const ChunkedDecoder& other);
+
+    void onSizeLineChar(char chr);
+    void onSizeLineEnd();
+    void onTrailerChar(char chr);
+    void countLineByte();
+};
+}  // namespace webserver
+#endif
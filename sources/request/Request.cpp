@@ -3,22 +3,46 @@
 #include <cstddef>
 #include <iostream>
 #include <limits>
-#include <map>
+#include <new>
 #include <sstream>
 #include <string>
 
 #include "http_methods/HttpMethodType.hpp"
 #include "http_status/BadRequest.hpp"
+#include "http_status/HttpException.hpp"
+#include "http_status/HttpStatus.hpp"
 #include "http_status/IncompleteRequest.hpp"
 #include "http_status/MethodNotAllowed.hpp"
 #include "http_status/PayloadTooLarge.hpp"
+#include "request/BodySink.hpp"
+#include "request/ChunkedDecoder.hpp"
+#include "request/RequestArena.hpp"
+#include "utils/StringView.hpp"
+#include "utils/utils.hpp"
 
 using std::istringstream;
-using std::map;
 using std::ostream;
-using std::ostringstream;
 using std::string;
 
+namespace {
+const size_t INITIAL_HEADER_CAPACITY = 16;
+const size_t REQUEST_LINE_TOKENS = 3;
+
+bool isSpace(char chr) {
+    return (chr == ' ' || chr == '\t' || chr == '\r' || chr == '\v' || chr == '\f');
+}
+
+size_t findLineEnd(const webserver::StringView& text, size_t from) {
+    for (size_t pos = text.find('\r', from); pos != webserver::StringView::npos;
+         pos = text.find('\r', pos + 1)) {
+        if (pos + 1 < text.size() && text[pos + 1] == '\n') {
+            return (pos);
+        }
+    }
+    return (webserver::StringView::npos);
+}
+}  // namespace
+
 namespace webserver {
 const HttpMethodType Request::DEFAULT_TYPE = GET;
 const string Request::DEFAULT_REQUEST_TARGET = "/dev/null";
@@ -29,31 +53,35 @@ size_t Request::defaultMaxClientBodySizeBytes() {
 }
 
 Request::Request()
-    : _method(DEFAULT_TYPE)
+    : _arena()
+    , _method(DEFAULT_TYPE)
     , _requestTarget(DEFAULT_REQUEST_TARGET)
     , _isRequestTargetReceived(false)
     , _path(DEFAULT_REQUEST_TARGET)
-    , _query("")
+    , _query()
     , _protocolVersion(DEFAULT_HTTP_VERSION)
-    , _headers()
+    , _headers(NULL)
+    , _headerCount(0)
+    , _headerCapacity(0)
     , _isBodyRaw(true)
     , _body("")
     , _maxClientBodySizeBytes(defaultMaxClientBodySizeBytes())
-    , _isCgiRequest(false) {
+    , _isCgiRequest(false)
+    , _isBodyStored(false) {
 }
 
 Request::Request(const Request& other)
-    : _method(other._method)
-    , _requestTarget(other._requestTarget)
-    , _isRequestTargetReceived(other._isRequestTargetReceived)
-    , _path(other._path)
-    , _query(other._query)
-    , _protocolVersion(other._protocolVersion)
-    , _headers(other._headers)
-    , _isBodyRaw(other._isBodyRaw)
-    , _body(other._body)
+    : _arena()
+    , _method(DEFAULT_TYPE)
+    , _isRequestTargetReceived(false)
+    , _headers(NULL)
+    , _headerCount(0)
+    , _headerCapacity(0)
+    , _isBodyRaw(true)
     , _maxClientBodySizeBytes(other._maxClientBodySizeBytes)
-    , _isCgiRequest(other._isCgiRequest) {
+    , _isCgiRequest(false)
+    , _isBodyStored(false) {
+    copyFields(other);
 }
 
 const std::string Request::MALFORMED_FIRST_LINE =
@@ -61,50 +89,22 @@ const std::string Request::MALFORMED_FIRST_LINE =
     "a requestTarget starting with '/', a protocol version starting with "
     "'HTTP/', and \\r\\n in the end";
 
-void Request::parseChunkedBody() {
-    size_t pos = 0;
-    ostringstream bodybuf;
-    while (true) {
-        const string::size_type lineEnd = _body.find("\r\n", pos);
-        if (lineEnd == string::npos) {
-            throw IncompleteRequest("incomplete chunked body");
-        }
-        const string chunkSizeStr = _body.substr(pos, lineEnd - pos);
-        istringstream iss(chunkSizeStr);
-        size_t chunkSize;
-        iss >> std::hex >> chunkSize;
-        if (iss.fail() || !iss.eof()) {
-            throw BadRequest("invalid chunk size in chunked body");
-        }
-        pos = lineEnd + 2;
-        if (chunkSize == 0) {
-            break;
-        }
-        if (pos + chunkSize + 2 > _body.size()) {
-            throw IncompleteRequest("incomplete chunked body data");
-        }
-        bodybuf << _body.substr(pos, chunkSize);
-        if (_body.substr(pos + chunkSize, 2) != "\r\n") {
-            throw BadRequest("invalid chunk body data ending");
-        }
-        pos += chunkSize + 2;
-        if (static_cast<size_t>(bodybuf.tellp()) > _maxClientBodySizeBytes) {
-            throw PayloadTooLarge("request body exceeds maximum allowed size");
-        }
-    }
-    _body = bodybuf.str();
-}
-
 Request::Request(string raw)
-    : _method(DEFAULT_TYPE)
+    : _arena()
+    , _method(DEFAULT_TYPE)
     , _requestTarget(DEFAULT_REQUEST_TARGET)
     , _isRequestTargetReceived(false)
     , _path(DEFAULT_REQUEST_TARGET)
+    , _query()
     , _protocolVersion(DEFAULT_HTTP_VERSION)
+    , _headers(NULL)
+    , _headerCount(0)
+    , _headerCapacity(0)
     , _isBodyRaw(true)
     , _body("")
     , _maxClientBodySizeBytes(defaultMaxClientBodySizeBytes())
-    , _isCgiRequest(false) {
+    , _isCgiRequest(false)
+    , _isBodyStored(false) {
     if (raw.empty()) {
         throw IncompleteRequest("empty request");
     }
@@ -115,18 +115,23 @@ Request::Request(string raw)
         }
         throw IncompleteRequest(MALFORMED_FIRST_LINE);
     }
-    parseFirstLine(raw.substr(0, endOfFirstLine));
+    const StringView text(raw);
+    parseFirstLine(text.substr(0, endOfFirstLine));
     const string::size_type endOfHeaders = raw.find("\r\n\r\n");
     if (endOfHeaders == string::npos) {
         throw IncompleteRequest("no formal end of headers");
     }
-    parseHeaders(raw.substr(endOfFirstLine + 2, endOfHeaders - endOfFirstLine - 2));
+    parseHeaders(text.substr(endOfFirstLine + 2, endOfHeaders - endOfFirstLine - 2));
     _body = (endOfHeaders != string::npos ? raw.substr(endOfHeaders + 4) : string());
 }
 
 void Request::parseBody() {
     // NOTE: do not call getBody() here, this would be a faulty recursive call
     _isBodyRaw = false;
+    if (hasAmbiguousLength()) {
+        throw BadRequest("ambiguous request body length");
+    }
+    const bool isChunkedBody = isChunked();
     if (getType() != POST) {
         _body = "";
         return;
@@ -142,28 +147,50 @@ void Request::parseBody() {
         if (_body.size() < getContentLength()) {
             throw IncompleteRequest(msg);
         }
-    } else if (getHeader("Transfer-Encoding") == "chunked") {
-        parseChunkedBody();
+    } else if (isChunkedBody) {
+        // NOTE: one pass over the raw body, decoded into _body again as it goes
+        string raw;
+        raw.swap(_body);
+        StringSink decoded(_body);
+        ChunkedDecoder decoder(_maxClientBodySizeBytes);
+        decoder.decode(raw.data(), raw.size(), &decoded);
+        if (!decoder.isComplete()) {
+            throw IncompleteRequest("incomplete chunked body");
+        }
     } else {
         throw BadRequest("no Content-Length or Transfer-Encoding header for POST request");
     }
 }
 
-void Request::parseFirstLine(const string& firstLine) {
-    istringstream iss(firstLine);
-    string method;
-    if (!(iss >> method >> _requestTarget >> _protocolVersion)) {
-        throw BadRequest(MALFORMED_FIRST_LINE);
+void Request::parseFirstLine(const StringView& firstLine) {
+    const StringView line = _arena.copy(firstLine);
+    StringView tokens[REQUEST_LINE_TOKENS];
+    size_t count = 0;
+    size_t pos = 0;
+    while (count < REQUEST_LINE_TOKENS) {
+        while (pos < line.size() && isSpace(line[pos])) {
+            pos++;
+        }
+        if (pos == line.size()) {
+            throw BadRequest(MALFORMED_FIRST_LINE);
+        }
+        const size_t start = pos;
+        while (pos < line.size() && !isSpace(line[pos])) {
+            pos++;
+        }
+        tokens[count++] = line.substr(start, pos - start);
     }
     try {
-        _method = stringToMethod(method);
+        _method = stringToMethod(tokens[0].str());
     } catch (...) {
-        throw MethodNotAllowed("unsupported HTTP method: " + method);
+        throw MethodNotAllowed("unsupported HTTP method: " + tokens[0].str());
     }
-    const size_t endOfPathPosition = _requestTarget.find("?");
-    if (endOfPathPosition != string::npos) {
+    _requestTarget = tokens[1];
+    _protocolVersion = tokens[2];
+    const size_t endOfPathPosition = _requestTarget.find('?', 0);
+    if (endOfPathPosition != StringView::npos) {
         _path = _requestTarget.substr(0, endOfPathPosition);
-        _query = _requestTarget.substr(endOfPathPosition + 1);
+        _query = _requestTarget.substr(endOfPathPosition + 1, StringView::npos);
     } else {
         _path = _requestTarget;
     }
@@ -174,43 +201,117 @@ bool Request::isRequestTargetReceived() const {
     return (_isRequestTargetReceived);
 }
 
-void Request::parseHeaders(const string& rawHeaders) {
-    string::size_type lineStart = 0;
+void Request::parseHeaders(const StringView& rawHeaders) {
+    size_t lineStart = 0;
     while (lineStart < rawHeaders.size()) {
-        string::size_type lineEnd = rawHeaders.find("\r\n", lineStart);
-        if (lineEnd == string::npos) {
+        size_t lineEnd = findLineEnd(rawHeaders, lineStart);
+        if (lineEnd == StringView::npos) {
             lineEnd = rawHeaders.size();
         }
-        const string::size_type colon = rawHeaders.find(':', lineStart);
-        if (colon == string::npos || colon > lineEnd) {
-            throw BadRequest("no colon in a header line");
+        parseHeaderLine(rawHeaders.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 2;
+    }
+}
+
+void Request::parseHeaderLine(const StringView& line) {
+    const size_t colon = line.find(':', 0);
+    if (colon == StringView::npos) {
+        throw BadRequest("no colon in a header line");
+    }
+    const StringView stored = _arena.copy(line);
+    // NOTE: skip spaces after colon
+    size_t valueStart = colon + 1;
+    while (valueStart < stored.size() && stored[valueStart] == ' ') {
+        valueStart++;
+    }
+    appendHeader(stored.substr(0, colon), stored.substr(valueStart, StringView::npos));
+}
+
+void Request::appendHeader(const StringView& name, const StringView& value) {
+    if (_headerCount == _headerCapacity) {
+        // NOTE: the old table stays in the arena unused, it is gone with the rest on reset()
+        const size_t capacity =
+            (_headerCapacity == 0 ? INITIAL_HEADER_CAPACITY : _headerCapacity * 2);
+        Header* headers = static_cast<Header*>(_arena.allocate(capacity * sizeof(Header)));
+        for (size_t i = 0; i < _headerCount; ++i) {
+            new (&headers[i]) Header(_headers[i]);
         }
-        const string key = rawHeaders.substr(lineStart, colon - lineStart);
-        // NOTE: skip spaces after colon
-        string::size_type valueStart = colon + 1;
-        while (valueStart < lineEnd && rawHeaders[valueStart] == ' ') {
-            valueStart++;
+        _headers = headers;
+        _headerCapacity = capacity;
+    }
+    Header* header = new (&_headers[_headerCount]) Header();
+    header->name = name;
+    header->value = value;
+    _headerCount++;
+}
+
+const Request::Header* Request::findHeader(const StringView& name) const {
+    for (size_t i = _headerCount; i > 0; --i) {
+        if (_headers[i - 1].name.equalsIgnoreCase(name)) {
+            return (&_headers[i - 1]);
         }
-        const string value = rawHeaders.substr(valueStart, lineEnd - valueStart);
-        _headers[key] = value;
-        lineStart = lineEnd + 2;
     }
+    return (NULL);
 }
 
-Request& Request::operator=(const Request& other) {
-    if (this == &other) {
-        return (*this);
+bool Request::hasSameHeaders(const Request& other) const {
+    for (size_t i = 0; i < _headerCount; ++i) {
+        const Header* theirs = other.findHeader(_headers[i].name);
+        if (theirs == NULL || theirs->value != findHeader(_headers[i].name)->value) {
+            return (false);
+        }
     }
+    for (size_t i = 0; i < other._headerCount; ++i) {
+        if (findHeader(other._headers[i].name) == NULL) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+void Request::copyFields(const Request& other) {
+    _arena.reset();
     _method = other._method;
-    _requestTarget = other._requestTarget;
+    _requestTarget = _arena.copy(other._requestTarget);
     _isRequestTargetReceived = other._isRequestTargetReceived;
-    _path = other._path;
-    _query = other._query;
-    _protocolVersion = other._protocolVersion;
-    _headers = other._headers;
+    _path = _arena.copy(other._path);
+    _query = _arena.copy(other._query);
+    _protocolVersion = _arena.copy(other._protocolVersion);
+    _headers = NULL;
+    _headerCount = 0;
+    _headerCapacity = 0;
+    for (size_t i = 0; i < other._headerCount; ++i) {
+        appendHeader(_arena.copy(other._headers[i].name), _arena.copy(other._headers[i].value));
+    }
     _body = other._body;
     _isBodyRaw = other._isBodyRaw;
     _isCgiRequest = other._isCgiRequest;
+    _isBodyStored = other._isBodyStored;
+}
+
+void Request::reset() {
+    _arena.reset();
+    _method = DEFAULT_TYPE;
+    _requestTarget = DEFAULT_REQUEST_TARGET;
+    _isRequestTargetReceived = false;
+    _path = DEFAULT_REQUEST_TARGET;
+    _query = StringView();
+    _protocolVersion = DEFAULT_HTTP_VERSION;
+    _headers = NULL;
+    _headerCount = 0;
+    _headerCapacity = 0;
+    _isBodyRaw = true;
+    string().swap(_body);  // NOTE: clear() would keep the capacity of a large upload
+    _maxClientBodySizeBytes = defaultMaxClientBodySizeBytes();
+    _isCgiRequest = false;
+    _isBodyStored = false;
+}
+
+Request& Request::operator=(const Request& other) {
+    if (this == &other) {
+        return (*this);
+    }
+    copyFields(other);
     return (*this);
 }
 
@@ -221,7 +322,7 @@ bool Request::operator==(const Request& other) {
     return (
         _method == other._method && _requestTarget == other._requestTarget &&
         _isRequestTargetReceived == other._isRequestTargetReceived &&
-        _protocolVersion == other._protocolVersion && _headers == other._headers &&
+        _protocolVersion == other._protocolVersion && hasSameHeaders(other) &&
         _body == other._body && _path == other._path && _query == other._query &&
         _isBodyRaw == other._isBodyRaw &&
         _maxClientBodySizeBytes == other._maxClientBodySizeBytes &&
@@ -240,38 +341,97 @@ HttpMethodType Request::getType() const {
 
 Request& Request::setRequestTarget(string requestTarget) {
     _isRequestTargetReceived = true;
-    _requestTarget = requestTarget;
+    _requestTarget = _arena.copy(requestTarget);
     return (*this);
 }
 
 string Request::getRequestTarget() const {
-    return (_requestTarget);
+    return (_requestTarget.str());
 }
 
 std::string Request::getVersion() const {
+    return (_protocolVersion.str());
+}
+
+const StringView& Request::getVersionView() const {
     return (_protocolVersion);
 }
 
 Request& Request::setVersion(string version) {
-    _protocolVersion = version;
+    _protocolVersion = _arena.copy(version);
     return (*this);
 }
 
 Request& Request::addHeader(string key, string value) {
-    _headers[key] = value;
+    appendHeader(_arena.copy(key), _arena.copy(value));
     return (*this);
 }
 
 string Request::getHeader(std::string key) const {
-    const map<string, string>::const_iterator itr = _headers.find(key);
-    if (itr != _headers.end()) {
-        return (itr->second);
-    }
-    return ("");
+    return (getHeaderView(key).str());
+}
+
+StringView Request::getHeaderView(const StringView& key) const {
+    const Header* header = findHeader(key);
+    return (header == NULL ? StringView() : header->value);
 }
 
 bool Request::contentLengthSet() const {
-    return (!getHeader("Content-Length").empty());
+    return (!getHeaderView("Content-Length").empty());
+}
+
+bool Request::hasAmbiguousLength() const {
+    size_t lengths = 0;
+    bool isTransferCoded = false;
+    for (size_t i = 0; i < _headerCount; ++i) {
+        if (_headers[i].name.equalsIgnoreCase("Content-Length")) {
+            lengths++;
+            if (_headers[i].value.find(',', 0) != StringView::npos) {
+                return (true);
+            }
+        } else if (_headers[i].name.equalsIgnoreCase("Transfer-Encoding")) {
+            isTransferCoded = true;
+        }
+    }
+    return (lengths > 1 || (lengths == 1 && isTransferCoded));
+}
+
+bool Request::isChunked() const {
+    size_t codings = 0;
+    string last;
+    bool isChunkedTwice = false;
+    bool isTransferCoded = false;
+    for (size_t i = 0; i < _headerCount; ++i) {
+        if (!_headers[i].name.equalsIgnoreCase("Transfer-Encoding")) {
+            continue;
+        }
+        isTransferCoded = true;
+        const string value = _headers[i].value.str();
+        size_t pos = 0;
+        while (pos < value.size()) {
+            size_t comma = value.find(',', pos);
+            comma = (comma == string::npos ? value.size() : comma);
+            const string entry = value.substr(pos, comma - pos);
+            const string coding = utils::toLower(utils::trim(entry.substr(0, entry.find(';'))));
+            pos = comma + 1;
+            if (coding.empty()) {
+                continue;
+            }
+            isChunkedTwice = isChunkedTwice || last == "chunked";
+            last = coding;
+            codings++;
+        }
+    }
+    if (!isTransferCoded) {
+        return (false);
+    }
+    if (last != "chunked" || isChunkedTwice) {
+        throw BadRequest("chunked is not the final transfer coding, once");
+    }
+    if (codings > 1) {
+        throw HttpException(HttpStatus::NOT_IMPLEMENTED, "unsupported transfer coding");
+    }
+    return (true);
 }
 
 size_t Request::getContentLength() const {
@@ -285,7 +445,7 @@ size_t Request::getContentLength() const {
     return (ret);
 }
 
-string Request::getBody() {
+const string& Request::getBody() {
     if (_isBodyRaw) {
         parseBody();
     }
@@ -303,15 +463,19 @@ Request& Request::setIsBodyRaw(bool isBodyRaw) {
 }
 
 string Request::getPath() const {
+    return (_path.str());
+}
+
+const StringView& Request::getPathView() const {
     return (_path);
 }
 
 Request& Request::setPath(string path) {
-    _path = path;
+    _path = _arena.copy(path);
     return (*this);
 }
 string Request::getQuery() const {
-    return (_query);
+    return (_query.str());
 }
 
 Request::~Request() {
@@ -334,6 +498,15 @@ Request& Request::markAsCgiRequest() {
     return (*this);
 }
 
+bool Request::isBodyStored() const {
+    return (_isBodyStored);
+}
+
+Request& Request::markBodyStored() {
+    _isBodyStored = true;
+    return (*this);
+}
+
 std::ostream& operator<<(std::ostream& oss, const Request& request) {
     oss << "method: " << methodToString(request._method);
     oss << " target: " << request._requestTarget;
@@ -343,10 +516,8 @@ std::ostream& operator<<(std::ostream& oss, const Request& request) {
     oss << " protocol: " << request._protocolVersion;
     oss << " is body raw: " << request._isBodyRaw;
     oss << " body: " << request._body << "\n";
-    for (map<string, string>::const_iterator itr = request._headers.begin();
-         itr != request._headers.end();
-         itr++) {
-        oss << itr->first << ": " << itr->second << "\n";
+    for (size_t i = 0; i < request._headerCount; ++i) {
+        oss << request._headers[i].name << ": " << request._headers[i].value << "\n";
     }
     return (oss);
 }
@@ -1,26 +1,43 @@
 #ifndef REQUEST_HPP
 #define REQUEST_HPP
 
-#include <map>
+#include <cstddef>
+#include <ostream>
 #include <string>
 
 #include "http_methods/HttpMethodType.hpp"
+#include "request/RequestArena.hpp"
+#include "utils/StringView.hpp"
 
 namespace webserver {
+/* NOTE: the request line and the headers are views into the request's own arena:
+* each line is copied there once as it is parsed, the fields are slices of that copy.
+* a copy of the Request copies the bytes into its own arena, reset() drops them all at once.
+* the body stays a std::string, it is not on the way of a GET.
+*/
 class Request {
 private:
+    struct Header {
+        StringView name;
+        StringView value;
+    };
+
+    RequestArena _arena;
     HttpMethodType _method;
-    std::string _requestTarget;  // NOTE: full form as in /foo/bar?x=1
+    StringView _requestTarget;  // NOTE: full form as in /foo/bar?x=1
     bool _isRequestTargetReceived;
     // NOTE: technically request can be split even here, so yes, this should be checked separately
-    std::string _path;   // NOTE: only /foo/bar
-    std::string _query;  // NOTE: only x=1
-    std::string _protocolVersion;
-    std::map<std::string, std::string> _headers;
+    StringView _path;   // NOTE: only /foo/bar
+    StringView _query;  // NOTE: only x=1
+    StringView _protocolVersion;
+    Header* _headers;  // NOTE: in the arena, in arrival order, a repeated name wins on lookup
+    size_t _headerCount;
+    size_t _headerCapacity;
     bool _isBodyRaw;
     std::string _body;
     size_t _maxClientBodySizeBytes;
     bool _isCgiRequest;
+    bool _isBodyStored;
 
     static const HttpMethodType DEFAULT_TYPE;
     static const std::string DEFAULT_REQUEST_TARGET;
@@ -28,10 +45,14 @@ private:
 
     static const std::string MALFORMED_FIRST_LINE;
 
-    void parseFirstLine(const std::string& firstLine);
-    void parseHeaders(const std::string& rawHeaders);
-    void parseChunkedBody();
+    void parseFirstLine(const StringView& firstLine);
+    void parseHeaders(const StringView& rawHeaders);
+    void parseHeaderLine(const StringView& line);
     void parseBody();
+    void appendHeader(const StringView& name, const StringView& value);
+    const Header* findHeader(const StringView& name) const;
+    bool hasSameHeaders(const Request& other) const;
+    void copyFields(const Request& other);
 
 public:
     Request();
@@ -50,28 +71,48 @@ public:
     Request& setRequestTarget(std::string requestTarget);
 
     std::string getPath() const;
+    const StringView& getPathView() const;
     Request& setPath(std::string path);
 
     std::string getQuery() const;
 
     // NOTE: not const due to lazy body initalization
-    std::string getBody();
+    const std::string& getBody();
     Request& setBody(std::string body);
     Request& setIsBodyRaw(bool isBodyRaw);
     bool isCgiRequest() const;
     Request& markAsCgiRequest();
+    // NOTE: the body went to a file as it arrived, see Connection::openUpload(); _body is empty
+    bool isBodyStored() const;
+    Request& markBodyStored();
 
     std::string getVersion() const;
+    const StringView& getVersionView() const;
     Request& setVersion(std::string version);
 
     Request& addHeader(std::string key, std::string value);
     std::string getHeader(std::string key) const;
+    // NOTE: names match case-insensitively, the view lives until reset()
+    StringView getHeaderView(const StringView& key) const;
     bool contentLengthSet() const;
+    /* NOTE: RFC 9112 6.3: Content-Length next to Transfer-Encoding, repeated or listed twice
+    * lets two readers of the same bytes disagree on where the body ends; such requests are refused.
+    */
+    bool hasAmbiguousLength() const;
+    /* NOTE: RFC 9112 6.1, 6.3: whether Transfer-Encoding frames the body, codings in any case.
+    * with the header there, chunked has to be the final coding and come once, else nobody knows
+    * where the body ends and BadRequest is thrown; a coding applied before it throws 501,
+    * chunked is the only one decoded here.
+    */
+    bool isChunked() const;
     size_t getContentLength() const;
     void setMaxClientBodySizeBytes(size_t maxClientBodySizeBytes);
     size_t getMaxClientBodySizeBytes() const;
     static size_t defaultMaxClientBodySizeBytes();
+    // NOTE: back to a freshly constructed request, keeping only the arena's inline block
+    void reset();
     friend std::ostream& operator<<(std::ostream& oss, const Request& request);
+    friend class RequestParser;
 };
 
 }  // namespace webserver
@@ -0,0 +1,65 @@
+#include "RequestArena.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "utils/StringView.hpp"
+
+namespace {
+const size_t ALIGNMENT = sizeof(void*);
+}  // namespace
+
+namespace webserver {
+RequestArena::RequestArena()
+    : _block(_inline.bytes)
+    , _used(0)
+    , _capacity(INLINE_BYTES) {
+}
+
+RequestArena::~RequestArena() {
+    freeHeapBlocks();
+}
+
+void* RequestArena::allocate(size_t size) {
+    const size_t start = (_used + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (start > _capacity || size > _capacity - start) {
+        // NOTE: the tail of the full block is abandoned until reset()
+        const size_t capacity = std::max(size, static_cast<size_t>(BLOCK_BYTES));
+        _heapBlocks.push_back(new char[capacity]);
+        _block = _heapBlocks.back();
+        _capacity = capacity;
+        _used = size;
+        return (_block);
+    }
+    _used = start + size;
+    return (_block + start);
+}
+
+StringView RequestArena::copy(const StringView& text) {
+    if (text.empty()) {
+        return (StringView());
+    }
+    char* dst = static_cast<char*>(allocate(text.size()));
+    std::copy(text.data(), text.data() + text.size(), dst);
+    return (StringView(dst, text.size()));
+}
+
+void RequestArena::reset() {
+    freeHeapBlocks();
+    _block = _inline.bytes;
+    _used = 0;
+    _capacity = INLINE_BYTES;
+}
+
+size_t RequestArena::getHeapBlockCount() const {
+    return (_heapBlocks.size());
+}
+
+void RequestArena::freeHeapBlocks() {
+    for (size_t i = 0; i < _heapBlocks.size(); ++i) {
+        delete[] _heapBlocks[i];
+    }
+    _heapBlocks.clear();
+}
+}  // namespace webserver
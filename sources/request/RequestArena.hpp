@@ -0,0 +1,47 @@
+#ifndef REQUESTARENA_HPP
+#define REQUESTARENA_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "utils/StringView.hpp"
+
+namespace webserver {
+/* NOTE: bump allocator for what one request is parsed into: the request line, the header lines,
+* the table of header views. nothing is freed on its own, reset() drops it all at once.
+* the first block lives inside the object, so a request with a usual head mallocs nothing;
+* bigger heads spill into heap blocks that are given back on reset().
+*/
+class RequestArena {
+public:
+    static const size_t INLINE_BYTES = 4096;
+    static const size_t BLOCK_BYTES = 16384;
+
+    RequestArena();
+    ~RequestArena();
+
+    void* allocate(size_t size);
+    StringView copy(const StringView& text);  // NOTE: the result points into the arena
+    void reset();
+    size_t getHeapBlockCount() const;
+
+private:
+    union InlineBlock {
+        char bytes[INLINE_BYTES];
+        void* alignment;  // NOTE: never used, forces pointer alignment on the bytes
+    };
+
+    InlineBlock _inline;
+    char* _block;
+    size_t _used;
+    size_t _capacity;
+    std::vector<char*> _heapBlocks;
+
+    void freeHeapBlocks();
+
+    RequestArena(const RequestArena& other);
+    RequestArena& operator=(const RequestArena& other);
+};
+}  // namespace webserver
+
+#endif
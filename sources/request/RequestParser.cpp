@@ -0,0 +1,256 @@
+#include "RequestParser.hpp"
+
+#include <cstddef>
+#include <string>
+
+#include "http_methods/HttpMethodType.hpp"
+#include "http_status/BadRequest.hpp"
+#include "http_status/HttpException.hpp"
+#include "http_status/HttpStatus.hpp"
+#include "http_status/PayloadTooLarge.hpp"
+#include "request/BodySink.hpp"
+#include "request/Request.hpp"
+#include "utils/StringView.hpp"
+#include "utils/utils.hpp"
+
+using std::string;
+
+namespace {
+const int DECIMAL_BASE = 10;
+
+int digitValue(char chr, int base) {
+    int res = -1;
+    if (chr >= '0' && chr <= '9') {
+        res = chr - '0';
+    } else if (chr >= 'a' && chr <= 'f') {
+        res = chr - 'a' + DECIMAL_BASE;
+    } else if (chr >= 'A' && chr <= 'F') {
+        res = chr - 'A' + DECIMAL_BASE;
+    }
+    return (res < base ? res : -1);
+}
+
+// NOTE: strict unsigned number, no sign, no spaces, no overflow
+bool parseSize(const webserver::StringView& str, int base, size_t& result) {
+    if (str.empty()) {
+        return (false);
+    }
+    const size_t maxSize = static_cast<size_t>(-1);
+    result = 0;
+    for (size_t i = 0; i < str.size(); i++) {
+        const int digit = digitValue(str[i], base);
+        if (digit == -1 || result > (maxSize - digit) / base) {
+            return (false);
+        }
+        result = result * base + digit;
+    }
+    return (true);
+}
+}  // namespace
+
+namespace webserver {
+RequestParser::RequestParser(Request& request)
+    : _request(request)
+    , _state(REQUEST_LINE)
+    , _pos(0)
+    , _scanPos(0)
+    , _headBytes(0)
+    , _bodyBytesLeft(0)
+    , _chunks(0)
+    , _isBodyKept(false)
+    , _requestBody(request._body)
+    , _bodySink(&_requestBody) {
+}
+
+RequestParser::~RequestParser() {
+}
+
+void RequestParser::feed(const char* data, size_t size) {
+    _buffer.append(data, size);
+}
+
+RequestParser::State RequestParser::parse() {
+    StringView line;
+    while (_state != COMPLETE) {
+        if (_state == BODY || _state == CHUNKED_BODY) {
+            if (_pos == _buffer.size()) {
+                break;
+            }
+            if (_state == BODY) {
+                consumeBody();
+            } else {
+                consumeChunks();
+            }
+            continue;
+        }
+        if (_state == HEADERS_COMPLETE) {
+            onHeadersEnd();
+            continue;
+        }
+        if (!nextLine(line)) {
+            break;
+        }
+        if (_state == REQUEST_LINE) {
+            if (line.empty()) {
+                continue;  // NOTE: RFC 9112 2.2: stray empty lines before a request are ignored
+            }
+            onRequestLine(line);
+            continue;
+        }
+        if (_state == HEADERS) {
+            if (line.empty()) {
+                _state = HEADERS_COMPLETE;
+                break;
+            }
+            onHeaderLine(line);
+        }
+    }
+    compact();
+    return (_state);
+}
+
+bool RequestParser::nextLine(StringView& line) {
+    const string::size_type end = _buffer.find('\n', _scanPos);
+    const size_t lineLength = (end == string::npos ? _buffer.size() : end) - _pos;
+    if (lineLength > MAX_LINE_BYTES) {
+        if (_state == REQUEST_LINE) {
+            throw HttpException(HttpStatus::URI_TOO_LONG, "request line too long");
+        }
+        throw HttpException(HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE, "line too long");
+    }
+    if (end == string::npos) {
+        _scanPos = _buffer.size();
+        return (false);
+    }
+    if (end == _pos || _buffer[end - 1] != '\r') {
+        throw BadRequest("invalid line endings");
+    }
+    if (_state == REQUEST_LINE || _state == HEADERS) {
+        _headBytes += end + 1 - _pos;
+        if (_headBytes > MAX_HEAD_BYTES) {
+            throw HttpException(HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE, "headers too large");
+        }
+    }
+    line = StringView(_buffer.data() + _pos, end - 1 - _pos);
+    _pos = end + 1;
+    _scanPos = _pos;
+    return (true);
+}
+
+void RequestParser::consumeBody() {
+    size_t count = _buffer.size() - _pos;
+    if (count > _bodyBytesLeft) {
+        count = _bodyBytesLeft;
+    }
+    if (_isBodyKept && _bodySink == &_requestBody && _request._body.empty()) {
+        // NOTE: the declared length is only a promise, do not let it allocate more than a bit
+        const size_t cap = static_cast<size_t>(utils::MIB);
+        _request._body.reserve(_bodyBytesLeft < cap ? _bodyBytesLeft : cap);
+    }
+    if (_isBodyKept) {
+        _bodySink->write(_buffer.data() + _pos, count);
+    }
+    _pos += count;
+    _scanPos = _pos;
+    _bodyBytesLeft -= count;
+    if (_bodyBytesLeft == 0) {
+        _state = COMPLETE;
+    }
+}
+
+void RequestParser::consumeChunks() {
+    _pos += _chunks.decode(
+        _buffer.data() + _pos,
+        _buffer.size() - _pos,
+        (_isBodyKept ? _bodySink : NULL)
+    );
+    _scanPos = _pos;
+    if (_chunks.isComplete()) {
+        _state = COMPLETE;
+    }
+}
+
+void RequestParser::onRequestLine(const StringView& line) {
+    _request.parseFirstLine(line);
+    _state = HEADERS;
+}
+
+void RequestParser::onHeaderLine(const StringView& line) {
+    _request.parseHeaderLine(line);
+}
+
+void RequestParser::onHeadersEnd() {
+    _isBodyKept = _request.getType() == POST;
+    _request._isBodyRaw = false;
+    _request._body.clear();
+    const size_t maxBodySize = _request.getMaxClientBodySizeBytes();
+    if (_request.hasAmbiguousLength()) {
+        // NOTE: whatever follows cannot be told apart from a next request, the connection closes
+        throw BadRequest("ambiguous request body length");
+    }
+    // NOTE: framing is checked for every method, a body left unread would pass for the next request
+    const bool isChunkedBody = _request.isChunked();
+    if (_request.contentLengthSet()) {
+        size_t contentLength;
+        if (!parseSize(_request.getHeaderView("Content-Length"), DECIMAL_BASE, contentLength)) {
+            throw BadRequest("invalid Content-Length");
+        }
+        if (contentLength > maxBodySize) {
+            throw PayloadTooLarge("request body exceeds maximum allowed size");
+        }
+        _bodyBytesLeft = contentLength;
+        _state = (contentLength == 0 ? COMPLETE : BODY);
+    } else if (isChunkedBody) {
+        _chunks.reset(maxBodySize);
+        _state = CHUNKED_BODY;
+    } else if (_isBodyKept) {
+        throw BadRequest("no Content-Length or Transfer-Encoding header for POST request");
+    } else {
+        _state = COMPLETE;
+    }
+}
+
+void RequestParser::compact() {
+    // NOTE: what stays is an unfinished line or a pipelined request, never a whole body
+    if (_pos == 0) {
+        return;
+    }
+    _buffer.erase(0, _pos);
+    _scanPos -= _pos;
+    _pos = 0;
+}
+
+RequestParser::State RequestParser::getState() const {
+    return (_state);
+}
+
+bool RequestParser::hasBufferedData() const {
+    return (_pos < _buffer.size());
+}
+
+RequestParser::State RequestParser::applyBodyLimits() {
+    if (_state == HEADERS_COMPLETE) {
+        onHeadersEnd();
+    }
+    return (_state);
+}
+
+void RequestParser::setBodySink(BodySink* sink) {
+    _bodySink = sink;
+}
+
+void RequestParser::reset() {
+    _state = REQUEST_LINE;
+    _scanPos = _pos;
+    _headBytes = 0;
+    _bodyBytesLeft = 0;
+    _isBodyKept = false;
+    _bodySink = &_requestBody;
+}
+
+void RequestParser::clear() {
+    _buffer.clear();
+    _pos = 0;
+    reset();
+}
+}  // namespace webserver
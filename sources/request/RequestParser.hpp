@@ -0,0 +1,83 @@
+#ifndef REQUESTPARSER_HPP
+#define REQUESTPARSER_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "request/BodySink.hpp"
+#include "request/ChunkedDecoder.hpp"
+#include "request/Request.hpp"
+#include "utils/StringView.hpp"
+
+namespace webserver {
+/* NOTE: resumable request reader. bytes are fed as they arrive and every byte is looked at once:
+* the parser remembers its state and the position of an unfinished line between feeds,
+* so a request costs time linear in its size, however it is split by recv().
+* it fills the Request it is bound to in place: the request line, then the headers,
+* then the body, each visible as soon as it is complete.
+* a body goes to the request's own string unless setBodySink() points it elsewhere;
+* chunked bodies are decoded by a ChunkedDecoder straight from the buffer.
+* bytes following a complete request (a pipelined next one) are kept for after reset().
+* protocol errors are thrown as HttpException subclasses.
+*/
+class RequestParser {
+public:
+    enum State {
+        REQUEST_LINE,
+        HEADERS,
+        HEADERS_COMPLETE,  // NOTE: the body limits are not applied yet
+        BODY,
+        CHUNKED_BODY,
+        COMPLETE
+    };
+
+    static const size_t MAX_LINE_BYTES = 8192;
+    static const size_t MAX_HEAD_BYTES = 65536;  // NOTE: request line and all headers together
+
+private:
+    Request& _request;
+    State _state;
+    std::string _buffer;
+    size_t _pos;      // NOTE: first byte of _buffer not consumed yet
+    size_t _scanPos;  // NOTE: where the search for the end of the current line resumes
+    size_t _headBytes;
+    size_t _bodyBytesLeft;  // NOTE: of a Content-Length body
+    ChunkedDecoder _chunks;
+    bool _isBodyKept;  // NOTE: only POST bodies reach the handlers, others are read and dropped
+    StringSink _requestBody;
+    BodySink* _bodySink;  // NOTE: not owned
+
+    RequestParser();
+    RequestParser(const RequestParser& other);
+    RequestParser& operator=(const RequestParser& other);
+
+    bool nextLine(StringView& line);  // NOTE: the line points into _buffer, valid until compact()
+    void consumeBody();
+    void consumeChunks();
+    void onRequestLine(const StringView& line);
+    void onHeaderLine(const StringView& line);
+    void onHeadersEnd();
+    void compact();
+
+public:
+    explicit RequestParser(Request& request);
+    ~RequestParser();
+
+    void feed(const char* data, size_t size);
+    // NOTE: pauses once right after the headers, for the caller to pick limits by Host and path
+    State parse();
+    /* NOTE: once paused after the headers, checks the body framing and the declared length
+    * against the limit now rather than in the next parse(); throws as parse() would
+    */
+    State applyBodyLimits();
+    State getState() const;
+    bool hasBufferedData() const;
+    // NOTE: where the kept body of the current request goes, not owned; until reset()
+    void setBodySink(BodySink* sink);
+    // NOTE: start over for the next request on the same connection, keeping unconsumed bytes
+    void reset();
+    void clear();  // NOTE: reset() for another client, the unconsumed bytes are dropped too
+};
+}  // namespace webserver
+
+#endif
@@ -0,0 +1,214 @@
+#include "ByteRanges.hpp"
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "http_status/HttpStatus.hpp"
+#include "logger/Logger.hpp"
+#include "response/FileBody.hpp"
+#include "response/Response.hpp"
+#include "utils/StringView.hpp"
+#include "utils/utils.hpp"
+
+using std::string;
+using std::vector;
+
+namespace {
+const size_t NO_LIMIT = static_cast<size_t>(-1);
+
+// NOTE: digits only; a number too big for size_t saturates, it is past the end of any file anyway
+bool parsePosition(const string& text, size_t& value) {
+    const size_t BASE = 10;
+    if (text.empty()) {
+        return (false);
+    }
+    value = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return (false);
+        }
+        const size_t digit = static_cast<size_t>(text[i] - '0');
+        value = (value > (NO_LIMIT - digit) / BASE ? NO_LIMIT : value * BASE + digit);
+    }
+    return (true);
+}
+}  // namespace
+
+namespace webserver {
+Logger ByteRanges::_log;
+const string ByteRanges::UNIT_PREFIX = "bytes=";
+const string ByteRanges::BOUNDARY_PREFIX = "webserv_byteranges_";
+
+/* NOTE: If-Range carries the validator of the copy the client holds a part of.
+* an entity tag has to match ETag, a date has to match Last-Modified exactly,
+* and a date is only trusted when the file was not changed in the same second it was read.
+*/
+bool ByteRanges::isValidatorCurrent(const Response& full, const StringView& ifRange) {
+    if (ifRange.empty()) {
+        return (true);
+    }
+    const string validator = ifRange.str();
+    if (validator[0] == '"') {
+        return (validator == full.getHeader("ETag"));
+    }
+    const string lastModified = full.getHeader("Last-Modified");
+    return (
+        !lastModified.empty() && validator == lastModified &&
+        lastModified != full.getHeader("Date")
+    );
+}
+
+bool ByteRanges::parseSpec(const string& spec, size_t size, vector<Range>& ranges) {
+    const size_t dash = spec.find('-');
+    if (dash == string::npos) {
+        return (false);
+    }
+    Range range;
+    if (dash == 0) {  // NOTE: -500 is the last 500 bytes
+        size_t suffix = 0;
+        if (!parsePosition(spec.substr(1), suffix)) {
+            return (false);
+        }
+        if (suffix == 0 || size == 0) {
+            return (true);
+        }
+        range.first = (suffix < size ? size - suffix : 0);
+        range.last = size - 1;
+        ranges.push_back(range);
+        return (true);
+    }
+    range.last = NO_LIMIT;  // NOTE: 500- is everything from 500 on
+    if (!parsePosition(spec.substr(0, dash), range.first) ||
+        (dash + 1 < spec.size() && !parsePosition(spec.substr(dash + 1), range.last)) ||
+        range.last < range.first) {
+        return (false);
+    }
+    if (range.first >= size) {
+        return (true);
+    }
+    range.last = (range.last < size ? range.last : size - 1);
+    ranges.push_back(range);
+    return (true);
+}
+
+bool ByteRanges::parse(const string& header, size_t size, vector<Range>& ranges) {
+    if (header.size() < UNIT_PREFIX.size() ||
+        utils::toLower(header.substr(0, UNIT_PREFIX.size())) != UNIT_PREFIX) {
+        return (false);
+    }
+    size_t specs = 0;
+    size_t pos = UNIT_PREFIX.size();
+    while (pos <= header.size()) {
+        size_t comma = header.find(',', pos);
+        comma = (comma == string::npos ? header.size() : comma);
+        const string spec = utils::trim(header.substr(pos, comma - pos));
+        pos = comma + 1;
+        if (spec.empty()) {
+            continue;  // NOTE: empty list elements are allowed
+        }
+        if (++specs > MAX_RANGES || !parseSpec(spec, size, ranges)) {
+            return (false);
+        }
+    }
+    return (specs > 0 && !overlap(ranges));
+}
+
+// NOTE: asking for the same bytes again and again is a way to make us send a file many times over
+bool ByteRanges::overlap(const vector<Range>& ranges) {
+    for (size_t i = 0; i < ranges.size(); i++) {
+        for (size_t j = i + 1; j < ranges.size(); j++) {
+            if (ranges[i].first <= ranges[j].last && ranges[j].first <= ranges[i].last) {
+                return (true);
+            }
+        }
+    }
+    return (false);
+}
+
+string ByteRanges::contentRange(const Range& range, size_t size) {
+    return (
+        "bytes " + utils::toString(range.first) + "-" + utils::toString(range.last) + "/" +
+        utils::toString(size)
+    );
+}
+
+void ByteRanges::setParts(
+    Response& partial,
+    const Response& full,
+    const vector<Range>& ranges,
+    const vector<string>& leads,
+    const string& tail
+) {
+    if (full.getFileBody().isSet()) {
+        FileBody body;
+        for (size_t i = 0; i < ranges.size(); i++) {
+            const off_t offset = static_cast<off_t>(ranges[i].first);
+            const size_t length = ranges[i].last - ranges[i].first + 1;
+            if (i == 0) {
+                body = full.getFileBody().slice(leads[i], offset, length);
+            } else {
+                body.append(leads[i], offset, length);
+            }
+        }
+        if (!tail.empty()) {
+            body.append(tail, 0, 0);
+        }
+        partial.setFileBody(body);
+        return;
+    }
+    // NOTE: a small file is in memory already, cached or just read
+    string body;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        body += leads[i];
+        body.append(full.getBody(), ranges[i].first, ranges[i].last - ranges[i].first + 1);
+    }
+    partial.setBody(body + tail);
+}
+
+Response ByteRanges::apply(
+    const Response& full,
+    const StringView& range,
+    const StringView& ifRange,
+    const HttpStatus& catalogue
+) {
+    if (range.empty() || full.getStatus() != HttpStatus::OK ||
+        !isValidatorCurrent(full, ifRange)) {
+        return (full);
+    }
+    const size_t size =
+        (full.getFileBody().isSet() ? full.getFileBody().getLength() : full.getBody().size());
+    vector<Range> ranges;
+    if (!parse(range.str(), size, ranges)) {
+        _log.stream(LOG_DEBUG) << "Ignoring Range: " << range << "\n";
+        return (full);
+    }
+    if (ranges.empty()) {
+        Response unsatisfiable = catalogue.serveStatusPage(HttpStatus::RANGE_NOT_SATISFIABLE);
+        unsatisfiable.setHeader("Content-Range", "bytes */" + utils::toString(size));
+        return (unsatisfiable);
+    }
+    Response partial(full);
+    partial.setStatus(HttpStatus::PARTIAL_CONTENT)
+        .setReasonPhrase(catalogue.getReasonPhrase(HttpStatus::PARTIAL_CONTENT));
+    if (ranges.size() == 1) {
+        partial.setHeader("Content-Range", contentRange(ranges[0], size));
+        setParts(partial, full, ranges, vector<string>(1), "");
+        return (partial);
+    }
+    static size_t responsesSent = 0;  // NOTE: a new boundary every time, unlikely to be in a file
+    const string boundary = BOUNDARY_PREFIX + utils::toString(++responsesSent);
+    vector<string> leads;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        leads.push_back(
+            "\r\n--" + boundary + "\r\nContent-Type: " + full.getHeader("Content-Type") +
+            "\r\nContent-Range: " + contentRange(ranges[i], size) + "\r\n\r\n"
+        );
+    }
+    partial.setHeader("Content-Type", "multipart/byteranges; boundary=" + boundary);
+    setParts(partial, full, ranges, leads, "\r\n--" + boundary + "--\r\n");
+    return (partial);
+}
+}  // namespace webserver
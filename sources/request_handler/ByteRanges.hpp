@@ -0,0 +1,63 @@
+#ifndef BYTERANGES_HPP
+#define BYTERANGES_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "http_status/HttpStatus.hpp"
+#include "logger/Logger.hpp"
+#include "response/Response.hpp"
+#include "utils/StringView.hpp"
+
+namespace webserver {
+/* NOTE:
+A non-instantiable utility class providing only static functions.
+Cuts the complete 200 response for a static file down to what a Range header asks for:
+206 with one range, 206 multipart/byteranges with several, 416 when none of them is in the file.
+A file body stays on disk, the ranges become offsets into the same descriptor.
+A Range that does not parse, or that asks for too many or overlapping ranges, is ignored
+and the whole file goes out, as RFC 9110 allows.
+*/
+class ByteRanges {
+private:
+    struct Range {
+        size_t first;
+        size_t last;  // NOTE: inclusive, as on the wire
+    };
+
+    static Logger _log;
+    static const size_t MAX_RANGES = 16;
+    static const std::string UNIT_PREFIX;
+    static const std::string BOUNDARY_PREFIX;
+
+    ByteRanges();
+    ByteRanges(const ByteRanges& other);
+    ByteRanges& operator=(const ByteRanges& other);
+    ~ByteRanges();
+
+    static bool isValidatorCurrent(const Response& full, const StringView& ifRange);
+    // NOTE: false when the header is to be ignored; no ranges left means none is satisfiable
+    static bool parse(const std::string& header, size_t size, std::vector<Range>& ranges);
+    static bool parseSpec(const std::string& spec, size_t size, std::vector<Range>& ranges);
+    static bool overlap(const std::vector<Range>& ranges);
+    static std::string contentRange(const Range& range, size_t size);
+    // NOTE: leads[i] goes right before ranges[i], the tail after the last one
+    static void setParts(
+        Response& partial,
+        const Response& full,
+        const std::vector<Range>& ranges,
+        const std::vector<std::string>& leads,
+        const std::string& tail
+    );
+
+public:
+    static Response apply(
+        const Response& full,
+        const StringView& range,
+        const StringView& ifRange,
+        const HttpStatus& catalogue
+    );
+};
+}  // namespace webserver
+#endif
@@ -0,0 +1,80 @@
+#include "CompressedFile.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+
+#include "file_system/StaticFileCache.hpp"
+#include "logger/Logger.hpp"
+#include "response/DeflateEncoder.hpp"
+#include "response/Response.hpp"
+#include "response/StreamBody.hpp"
+
+using std::string;
+
+namespace webserver {
+Logger CompressedFile::_log;
+
+CompressedFile::CompressedFile(
+    int fileDescriptor,
+    const string& path,
+    const string& coding,
+    const struct ::stat& fileStat,
+    const Response& head,
+    StaticFileCache* fileCache
+)
+    : _fileDescriptor(fileDescriptor)
+    , _path(path)
+    , _coding(coding)
+    , _fileStat(fileStat)
+    , _head(head)
+    , _fileCache(fileCache)
+    , _encoder(coding == "gzip" ? DeflateEncoder::GZIP : DeflateEncoder::ZLIB) {
+}
+
+CompressedFile::~CompressedFile() {
+    closeFile();
+}
+
+void CompressedFile::closeFile() {
+    if (_fileDescriptor != -1) {
+        close(_fileDescriptor);
+        _fileDescriptor = -1;
+    }
+}
+
+// NOTE: the encoder keeps what does not make a whole block yet, reading goes on until it gives some
+void CompressedFile::produce(StreamBody& body) {
+    char block[BLOCK_BYTES];
+    string out;
+    while (out.empty() && _fileDescriptor != -1) {
+        const ssize_t got = read(_fileDescriptor, block, sizeof(block));
+        if (got < 0) {
+            _log.stream(LOG_ERROR) << "Cannot read " << _path << " while compressing it\n";
+            closeFile();
+            body.abandon();
+            return;
+        }
+        if (got == 0) {
+            _encoder.finish(out);
+            closeFile();
+        } else {
+            _encoder.write(block, static_cast<size_t>(got), out);
+        }
+    }
+    body.write(out.data(), out.size());
+    if (_fileCache != NULL) {
+        _encoded += out;
+    }
+    if (_fileDescriptor != -1) {
+        return;
+    }
+    body.close();
+    if (_fileCache != NULL) {
+        _head.setBody(_encoded);
+        _fileCache->store(_path, _coding, _fileStat, _head);
+    }
+}
+}  // namespace webserver
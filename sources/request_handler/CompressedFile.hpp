@@ -0,0 +1,57 @@
+#ifndef COMPRESSEDFILE_HPP
+#define COMPRESSEDFILE_HPP
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <string>
+
+#include "file_system/StaticFileCache.hpp"
+#include "logger/Logger.hpp"
+#include "response/DeflateEncoder.hpp"
+#include "response/Response.hpp"
+#include "response/StreamBody.hpp"
+
+namespace webserver {
+/* NOTE: a static file compressed as the connection asks for it, a block of the file per piece,
+* so a file nobody compressed yet does not hold the loop until the last byte of it is encoded.
+* what comes out is gathered on the side too and, once the file is read to the end,
+* goes into the cache under the coding with head, the way a file served whole is kept.
+* a read error cuts the body short, the head is out already.
+*/
+class CompressedFile : public StreamBody::Producer {
+public:
+    // NOTE: takes ownership of fileDescriptor; fileCache may be NULL
+    CompressedFile(
+        int fileDescriptor,
+        const std::string& path,
+        const std::string& coding,
+        const struct ::stat& fileStat,
+        const Response& head,
+        StaticFileCache* fileCache
+    );
+    virtual ~CompressedFile();
+
+    virtual void produce(StreamBody& body);
+
+private:
+    static Logger _log;
+    static const size_t BLOCK_BYTES = 16384;
+
+    int _fileDescriptor;  // NOTE: -1 once the file is read to the end
+    std::string _path;
+    std::string _coding;
+    struct ::stat _fileStat;
+    Response _head;
+    StaticFileCache* _fileCache;
+    DeflateEncoder _encoder;
+    std::string _encoded;
+
+    void closeFile();
+
+    CompressedFile();
+    CompressedFile(const CompressedFile& other);
+    CompressedFile& operator=(const CompressedFile& other);
+};
+}  // namespace webserver
+#endif
@@ -0,0 +1,145 @@
+#include "ContentEncoding.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+
+#include "file_system/FileSystem.hpp"
+#include "file_system/MimeType.hpp"
+#include "logger/Logger.hpp"
+#include "utils/StringView.hpp"
+#include "utils/utils.hpp"
+
+using std::string;
+
+namespace {
+const int FULL_QUALITY = 1000;
+
+struct Candidate {
+    const char* coding;
+    const char* sidecarExtension;  // NOTE: NULL when there is never a sidecar for it
+    bool isEncodedHere;
+};
+
+// NOTE: in the order the server prefers them when the client likes them equally
+const Candidate CANDIDATES[] = {
+    {"br", ".br", false},
+    {"gzip", ".gz", true},
+    {"deflate", NULL, true}
+};
+const size_t CANDIDATE_COUNT = sizeof(CANDIDATES) / sizeof(CANDIDATES[0]);
+}  // namespace
+
+namespace webserver {
+Logger ContentEncoding::_log;
+
+// NOTE: q is 0 to 1 with at most three decimals; anything else makes the entry unacceptable
+int ContentEncoding::parseQuality(const string& params) {
+    const size_t DECIMALS = 3;
+    const size_t start = params.find("q=");
+    if (start == string::npos) {
+        return (FULL_QUALITY);
+    }
+    const string value = utils::trim(params.substr(start + 2));
+    if (value.empty() || (value[0] != '0' && value[0] != '1') ||
+        (value.size() > 1 && value[1] != '.') || value.size() > DECIMALS + 2) {
+        return (0);
+    }
+    int res = (value[0] - '0') * FULL_QUALITY;
+    int scale = FULL_QUALITY;
+    for (size_t i = 2; i < value.size(); i++) {
+        if (value[i] < '0' || value[i] > '9') {
+            return (0);
+        }
+        scale /= 10;
+        res += (value[i] - '0') * scale;
+    }
+    return (res > FULL_QUALITY ? 0 : res);
+}
+
+// NOTE: an entry naming the coding wins over *, a coding not listed at all is not acceptable
+int ContentEncoding::quality(const string& acceptEncoding, const string& coding) {
+    int wildcard = 0;
+    size_t pos = 0;
+    while (pos < acceptEncoding.size()) {
+        size_t comma = acceptEncoding.find(',', pos);
+        comma = (comma == string::npos ? acceptEncoding.size() : comma);
+        const string entry = utils::toLower(acceptEncoding.substr(pos, comma - pos));
+        pos = comma + 1;
+        const size_t semicolon = entry.find(';');
+        const string name = utils::trim(entry.substr(0, semicolon));
+        const string params = (semicolon == string::npos ? "" : entry.substr(semicolon + 1));
+        if (name == coding) {
+            return (parseQuality(params));
+        }
+        if (name == "*") {
+            wildcard = parseQuality(params);
+        }
+    }
+    return (wildcard);
+}
+
+// NOTE: a sidecar older than the file was left behind by an earlier version of it
+bool ContentEncoding::findSidecar(
+    const string& path,
+    const string& extension,
+    const struct ::stat& fileStat,
+    struct ::stat& sidecarStat
+) {
+    const string sidecar = path + extension;
+    return (
+        stat(sidecar.c_str(), &sidecarStat) == 0 && S_ISREG(sidecarStat.st_mode) &&
+        sidecarStat.st_mtime >= fileStat.st_mtime && access(sidecar.c_str(), R_OK) == 0
+    );
+}
+
+ContentEncoding::Choice ContentEncoding::choose(
+    const StringView& acceptEncoding,
+    const string& path,
+    const struct ::stat& fileStat
+) {
+    Choice res;
+    res.sidecarStat = fileStat;
+    if (acceptEncoding.empty()) {
+        return (res);
+    }
+    const string header = acceptEncoding.str();
+    const size_t size = static_cast<size_t>(fileStat.st_size);
+    const bool isWorthEncoding =
+        size >= MIN_COMPRESSED_BYTES && size <= MAX_COMPRESSED_BYTES &&
+        MimeType::isCompressible(MimeType::getMimeType(file_system::getFileExtension(path)));
+    int best = 0;
+    for (size_t i = 0; i < CANDIDATE_COUNT; i++) {
+        const Candidate& candidate = CANDIDATES[i];
+        const int candidateQuality = quality(header, candidate.coding);
+        if (candidateQuality <= best) {
+            continue;
+        }
+        struct ::stat sidecarStat;
+        if (candidate.sidecarExtension != NULL &&
+            findSidecar(path, candidate.sidecarExtension, fileStat, sidecarStat)) {
+            res.coding = candidate.coding;
+            res.sidecar = path + candidate.sidecarExtension;
+            res.sidecarStat = sidecarStat;
+            best = candidateQuality;
+        } else if (candidate.isEncodedHere && isWorthEncoding) {
+            res.coding = candidate.coding;
+            res.sidecar.clear();
+            best = candidateQuality;
+        }
+    }
+    _log.stream(LOG_TRACE) << "Coding for " << path << ": "
+                           << (res.coding.empty() ? "identity" : res.coding) << "\n";
+    return (res);
+}
+
+string ContentEncoding::entityTag(const string& identityTag, const string& coding) {
+    const size_t closingQuote = identityTag.rfind('"');
+    if (coding.empty() || closingQuote == string::npos || closingQuote == 0) {
+        return (identityTag);
+    }
+    return (identityTag.substr(0, closingQuote) + "-" + coding + identityTag.substr(closingQuote));
+}
+}  // namespace webserver
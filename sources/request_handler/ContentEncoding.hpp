@@ -0,0 +1,58 @@
+#ifndef CONTENTENCODING_HPP
+#define CONTENTENCODING_HPP
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <string>
+
+#include "logger/Logger.hpp"
+#include "utils/StringView.hpp"
+
+namespace webserver {
+/* NOTE:
+A non-instantiable utility class providing only static functions.
+Picks the coding a static file goes out in from the client's Accept-Encoding.
+A precompressed sidecar next to the file, foo.css.br or foo.css.gz, is taken as is when present;
+otherwise text-like files of a worthwhile size are compressed with gzip or deflate here.
+br only ever comes from a sidecar, there is no encoder for it.
+*/
+class ContentEncoding {
+public:
+    struct Choice {
+        std::string coding;   // NOTE: empty for identity
+        std::string sidecar;  // NOTE: empty when the file is to be compressed here
+        struct ::stat sidecarStat;
+    };
+
+    static const size_t MIN_COMPRESSED_BYTES = 1024;  // NOTE: below it headers outweigh savings
+    static const size_t MAX_COMPRESSED_BYTES = 1048576;  // NOTE: output is kept for the cache
+
+    static Choice choose(
+        const StringView& acceptEncoding,
+        const std::string& path,
+        const struct ::stat& fileStat
+    );
+    // NOTE: the entity tag of the file, made different for every coding
+    static std::string entityTag(const std::string& identityTag, const std::string& coding);
+
+private:
+    static Logger _log;
+
+    ContentEncoding();
+    ContentEncoding(const ContentEncoding& other);
+    ContentEncoding& operator=(const ContentEncoding& other);
+    ~ContentEncoding();
+
+    // NOTE: in thousandths, 0 when the coding is not acceptable
+    static int quality(const std::string& acceptEncoding, const std::string& coding);
+    static int parseQuality(const std::string& params);
+    static bool findSidecar(
+        const std::string& path,
+        const std::string& extension,
+        const struct ::stat& fileStat,
+        struct ::stat& sidecarStat
+    );
+};
+}  // namespace webserver
+#endif
@@ -0,0 +1,55 @@
+#include "DirectoryListing.hpp"
+
+#include <cstddef>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "response/StreamBody.hpp"
+
+using std::ostringstream;
+using std::set;
+using std::string;
+
+namespace webserver {
+DirectoryListing::DirectoryListing(const string& originalTarget, const set<string>& names)
+    : _originalTarget(originalTarget)
+    , _names(names)
+    , _next(_names.begin())
+    , _isStarted(false) {
+}
+
+DirectoryListing::~DirectoryListing() {
+}
+
+string DirectoryListing::item(const string& name) const {
+    ostringstream oss;
+    oss << "\n<li><a href=\"" << _originalTarget
+        << (_originalTarget.at(_originalTarget.size() - 1) == '/' ? "" : "/") << name << "\">"
+        << name << "</a></li>";
+    return (oss.str());
+}
+
+void DirectoryListing::produce(StreamBody& body) {
+    ostringstream oss;
+    if (!_isStarted) {
+        oss << "<html><head><title>" << _originalTarget << "</title></head><body>";
+        oss << "Contents of folder " << _originalTarget << ":\n<hr/>\n<ul>";
+        oss << item(".");
+        oss << item("..");
+        _isStarted = true;
+    }
+    for (size_t written = 0; written < ENTRIES_PER_PIECE && _next != _names.end(); written++) {
+        oss << item(*_next);
+        ++_next;
+    }
+    if (_next == _names.end()) {
+        oss << "\n</ul></body></html>";
+    }
+    const string piece = oss.str();
+    body.write(piece.data(), piece.size());
+    if (_next == _names.end()) {
+        body.close();
+    }
+}
+}  // namespace webserver
@@ -0,0 +1,38 @@
+#ifndef DIRECTORYLISTING_HPP
+#define DIRECTORYLISTING_HPP
+
+#include <cstddef>
+#include <set>
+#include <string>
+
+#include "response/StreamBody.hpp"
+
+namespace webserver {
+/* NOTE: the autoindex page of a directory, written as the connection asks for it.
+* the names are read and sorted up front, the markup for them is made
+* a few hundred entries at a time, each batch a chunk of its own,
+* so the page starts going out before the last entry is rendered.
+*/
+class DirectoryListing : public StreamBody::Producer {
+public:
+    DirectoryListing(const std::string& originalTarget, const std::set<std::string>& names);
+    virtual ~DirectoryListing();
+
+    virtual void produce(StreamBody& body);
+
+private:
+    static const size_t ENTRIES_PER_PIECE = 256;
+
+    std::string _originalTarget;
+    std::set<std::string> _names;
+    std::set<std::string>::const_iterator _next;
+    bool _isStarted;
+
+    std::string item(const std::string& name) const;
+
+    DirectoryListing();
+    DirectoryListing(const DirectoryListing& other);
+    DirectoryListing& operator=(const DirectoryListing& other);
+};
+}  // namespace webserver
+#endif
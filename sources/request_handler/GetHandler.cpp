@@ -1,32 +1,64 @@
 #include "GetHandler.hpp"
 
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <cstddef>
+#include <ctime>
 #include <set>
-#include <sstream>
+#include <stdexcept>
 #include <string>
 
 #include "configuration/RouteConfig.hpp"
 #include "file_system/FileSystem.hpp"
 #include "file_system/MimeType.hpp"
+#include "file_system/StaticFileCache.hpp"
 #include "http_status/HttpStatus.hpp"
 #include "logger/Logger.hpp"
+#include "request/Request.hpp"
+#include "request_handler/ByteRanges.hpp"
+#include "request_handler/CompressedFile.hpp"
+#include "request_handler/ContentEncoding.hpp"
+#include "request_handler/DirectoryListing.hpp"
 #include "response/Response.hpp"
+#include "response/StreamBody.hpp"
+#include "utils/StringView.hpp"
+#include "utils/utils.hpp"
 
-using std::ostringstream;
 using std::set;
 using std::string;
 
 namespace webserver {
 Logger GetHandler::_log;
 
-string listingItem(string prefix, string name) {
-    ostringstream oss;
-    oss << "\n<li><a href=\"" << prefix << (prefix.at(prefix.size() - 1) == '/' ? "" : "/") << name
-        << "\">" << name << "</a></li>";
-    return (oss.str());
+namespace {
+// NOTE: weak comparison, as If-None-Match asks for: W/"x" matches "x"
+bool matchesAnyTag(const string& tags, const string& etag) {
+    const string WEAK_PREFIX = "W/";
+    const string opaque = (etag.compare(0, WEAK_PREFIX.size(), WEAK_PREFIX) == 0
+                               ? etag.substr(WEAK_PREFIX.size())
+                               : etag);
+    size_t pos = 0;
+    while (pos <= tags.size()) {
+        size_t comma = tags.find(',', pos);
+        comma = (comma == string::npos ? tags.size() : comma);
+        string tag = utils::trim(tags.substr(pos, comma - pos));
+        pos = comma + 1;
+        if (tag == "*") {
+            return (true);
+        }
+        if (tag.compare(0, WEAK_PREFIX.size(), WEAK_PREFIX) == 0) {
+            tag = tag.substr(WEAK_PREFIX.size());
+        }
+        if (!tag.empty() && tag == opaque) {
+            return (true);
+        }
+    }
+    return (false);
 }
+}  // namespace
 
 Response GetHandler::listDirectory(
     string originalTarget,
@@ -48,29 +80,196 @@ Response GetHandler::listDirectory(
         files.insert(name);
     }
     closedir(dir);
-    ostringstream oss;
-    oss << "<html><head><title>" << originalTarget << "</title></head><body>";
-    oss << "Contents of folder " << originalTarget << ":\n<hr/>\n<ul>";
-    oss << listingItem(originalTarget, ".");
-    oss << listingItem(originalTarget, "..");
-    for (set<string>::const_iterator itr = files.begin(); itr != files.end(); itr++) {
-        oss << listingItem(originalTarget, *itr);
-    }
-    oss << "\n</ul></body></html>";
-    return (Response(
+    Response response(
         HttpStatus::OK,
         configuration.getStatusCatalogue().getReasonPhrase(HttpStatus::OK),
-        oss.str(),
+        "",
         MimeType::getMimeType("html")
+    );
+    return (response.setStreamBody(StreamBody(new DirectoryListing(originalTarget, files))));
+}
+
+Response GetHandler::serveFile(
+    const string& resolvedTarget,
+    const RouteConfig& routeConfig,
+    StaticFileCache* fileCache
+) {
+    struct stat fileStat;
+    Response response = file_system::serveFile(
+        resolvedTarget,
+        HttpStatus::OK,
+        routeConfig.getStatusCatalogue().getReasonPhrase(HttpStatus::OK),
+        fileStat
+    );
+    setValidators(response, fileStat, "");
+    if (fileCache != NULL) {
+        fileCache->store(resolvedTarget, fileStat, response);
+    }
+    return (response);
+}
+
+// NOTE: the sidecar's bytes under the type of the file it stands for; not cached, it is on disk
+Response GetHandler::serveSidecar(
+    const string& resolvedTarget,
+    const ContentEncoding::Choice& choice,
+    const RouteConfig& routeConfig
+) {
+    struct stat sidecarStat;
+    Response response = file_system::serveFile(
+        choice.sidecar,
+        HttpStatus::OK,
+        routeConfig.getStatusCatalogue().getReasonPhrase(HttpStatus::OK),
+        sidecarStat
+    );
+    response
+        .setHeader(
+            "Content-Type",
+            MimeType::getMimeType(file_system::getFileExtension(resolvedTarget))
+        )
+        .setHeader("Content-Encoding", choice.coding);
+    setValidators(response, sidecarStat, choice.coding);
+    return (response);
+}
+
+/* NOTE: compressed here while it is sent, see CompressedFile, and cached once complete.
+* the compressed length is known only at the end, so the body goes chunked
+* and ranges of it are served only from the cache
+*/
+Response GetHandler::serveEncoded(
+    const string& resolvedTarget,
+    const string& coding,
+    const RouteConfig& routeConfig,
+    StaticFileCache* fileCache
+) {
+    const int fileDescriptor = open(resolvedTarget.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat fileStat;
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Failed to open file");
+    }
+    if (fstat(fileDescriptor, &fileStat) == -1) {
+        close(fileDescriptor);
+        throw std::runtime_error("Failed to open file");
+    }
+    Response head(
+        HttpStatus::OK,
+        routeConfig.getStatusCatalogue().getReasonPhrase(HttpStatus::OK),
+        "",
+        MimeType::getMimeType(file_system::getFileExtension(resolvedTarget))
+    );
+    head.setHeader("Content-Encoding", coding);
+    setValidators(head, fileStat, coding);
+    Response response = head;
+    response.removeHeader("Accept-Ranges");
+    response.setStreamBody(StreamBody(
+        new CompressedFile(fileDescriptor, resolvedTarget, coding, fileStat, head, fileCache)
     ));
+    return (response);
+}
+
+void GetHandler::setValidators(
+    Response& response,
+    const struct stat& fileStat,
+    const string& coding
+) {
+    response.setHeader("Accept-Ranges", "bytes")
+        .setHeader("ETag", ContentEncoding::entityTag(file_system::entityTag(fileStat), coding))
+        .setHeader("Last-Modified", utils::toHttpDate(fileStat.st_mtime));
+}
+
+bool GetHandler::negotiatesCoding(const Request& request, const RouteConfig& routeConfig) {
+    return (
+        routeConfig.isCompressionEnabled() && !request.getHeaderView("Accept-Encoding").empty()
+    );
+}
+
+// NOTE: with compression on, what a file looks like depends on Accept-Encoding, caches must know
+Response GetHandler::varyByCoding(const RouteConfig& routeConfig, Response response) {
+    if (routeConfig.isCompressionEnabled()) {
+        response.setHeader("Vary", "Accept-Encoding");
+    }
+    return (response);
+}
+
+Response GetHandler::serveRanges(
+    const Request& request,
+    const Response& full,
+    const RouteConfig& routeConfig
+) {
+    return (ByteRanges::apply(
+        full,
+        request.getHeaderView("Range"),
+        request.getHeaderView("If-Range"),
+        routeConfig.getStatusCatalogue()
+    ));
+}
+
+Response GetHandler::serveCached(
+    const Request& request,
+    const Response& cached,
+    const RouteConfig& routeConfig
+) {
+    const string etag = cached.getHeader("ETag");
+    const string lastModified = cached.getHeader("Last-Modified");
+    if (isNotModified(request, etag, lastModified)) {
+        return (notModified(etag, lastModified, routeConfig));
+    }
+    return (serveRanges(request, cached, routeConfig));
+}
+
+// NOTE: If-None-Match, when present, is the only one looked at, as RFC 9110 orders them
+bool GetHandler::isNotModified(
+    const Request& request,
+    const string& etag,
+    const string& lastModified
+) {
+    const StringView ifNoneMatch = request.getHeaderView("If-None-Match");
+    if (!ifNoneMatch.empty()) {
+        return (matchesAnyTag(ifNoneMatch.str(), etag));
+    }
+    const StringView ifModifiedSince = request.getHeaderView("If-Modified-Since");
+    std::time_t since;
+    std::time_t modified;
+    return (
+        !ifModifiedSince.empty() && utils::parseHttpDate(ifModifiedSince.str(), since) &&
+        utils::parseHttpDate(lastModified, modified) && modified <= since
+    );
+}
+
+// NOTE: the validators the client should keep, and no body nor anything describing one
+Response GetHandler::notModified(
+    const string& etag,
+    const string& lastModified,
+    const RouteConfig& routeConfig
+) {
+    Response response(
+        HttpStatus::NOT_MODIFIED,
+        routeConfig.getStatusCatalogue().getReasonPhrase(HttpStatus::NOT_MODIFIED),
+        "",
+        ""
+    );
+    response.removeHeader("Content-Type")
+        .removeHeader("Content-Length")
+        .setHeader("ETag", etag)
+        .setHeader("Last-Modified", lastModified);
+    return (response);
 }
 
 Response GetHandler::handleRequest(
-    string originalTarget,
+    const Request& request,
     string resolvedTarget,
-    bool isCgiRequest,
-    const RouteConfig& routeConfig
+    const RouteConfig& routeConfig,
+    StaticFileCache* fileCache
 ) {
+    const string originalTarget = request.getPath();
+    const bool isCgiRequest = request.isCgiRequest();
+    Response cached;
+    /* NOTE: only files that passed all the checks below on an earlier request are in the cache.
+    * a file that may go out compressed needs its coding picked first
+    */
+    if (fileCache != NULL && !isCgiRequest && !negotiatesCoding(request, routeConfig) &&
+        fileCache->lookup(resolvedTarget, cached)) {
+        return (varyByCoding(routeConfig, serveCached(request, cached, routeConfig)));
+    }
     if (file_system::isDirectory(resolvedTarget.c_str())) {
         _log.stream(LOG_TRACE) << "Target is a directory.\n";
         string existingIndexFile;
@@ -79,7 +278,7 @@ Response GetHandler::handleRequest(
                                 (resolvedTarget.at(resolvedTarget.size() - 1) == '/' ? "" : "/") +
                                 routeConfig.getFolderConfig().getIndexPageFilename();
         }
-        if (file_system::fileExists(existingIndexFile.c_str())) {
+        if (file_system::isReadableFile(existingIndexFile.c_str())) {
             _log.stream(LOG_TRACE) << "index file available\n";
             resolvedTarget = existingIndexFile;
         } else {  // NOTE: index file doesn't exist, autolisting or 403
@@ -107,16 +306,58 @@ Response GetHandler::handleRequest(
     if (isCgiRequest) {
         return (Response(-1, "", "", ""));
     }
+    const Response response = serveStatic(request, resolvedTarget, routeConfig, fileCache);
+    return (varyByCoding(routeConfig, response));
+}
 
-    if (file_system::fileExists(resolvedTarget.c_str())) {
-        return (file_system::serveFile(
+Response GetHandler::serveStatic(
+    const Request& request,
+    const string& resolvedTarget,
+    const RouteConfig& routeConfig,
+    StaticFileCache* fileCache
+) {
+    const bool negotiates = negotiatesCoding(request, routeConfig);
+    Response cached;
+    if (!negotiates && fileCache != NULL && fileCache->lookup(resolvedTarget, cached)) {
+        return (serveCached(request, cached, routeConfig));  // NOTE: a directory index
+    }
+    struct stat fileStat;
+    if (stat(resolvedTarget.c_str(), &fileStat) == -1 || !S_ISREG(fileStat.st_mode) ||
+        access(resolvedTarget.c_str(), R_OK) == -1) {
+        return (routeConfig.getStatusCatalogue().serveStatusPage(HttpStatus::NOT_FOUND));
+    }
+    ContentEncoding::Choice choice;
+    if (negotiates) {
+        choice = ContentEncoding::choose(
+            request.getHeaderView("Accept-Encoding"),
             resolvedTarget,
-            HttpStatus::OK,
-            routeConfig.getStatusCatalogue().getReasonPhrase(HttpStatus::OK)
-        ));
+            fileStat
+        );
+        if (choice.sidecar.empty() && fileCache != NULL &&
+            fileCache->lookup(resolvedTarget, choice.coding, cached)) {
+            return (serveCached(request, cached, routeConfig));
+        }
     }
-
-    return (routeConfig.getStatusCatalogue().serveStatusPage(HttpStatus::NOT_FOUND));
+    // NOTE: a revalidation costs this stat(), the file is not opened
+    const struct stat& validatorStat = (choice.sidecar.empty() ? fileStat : choice.sidecarStat);
+    const string etag =
+        ContentEncoding::entityTag(file_system::entityTag(validatorStat), choice.coding);
+    const string lastModified = utils::toHttpDate(validatorStat.st_mtime);
+    if (isNotModified(request, etag, lastModified)) {
+        return (notModified(etag, lastModified, routeConfig));
+    }
+    Response full;
+    if (choice.coding.empty()) {
+        full = serveFile(resolvedTarget, routeConfig, fileCache);
+    } else if (!choice.sidecar.empty()) {
+        full = serveSidecar(resolvedTarget, choice, routeConfig);
+    } else {
+        full = serveEncoded(resolvedTarget, choice.coding, routeConfig, fileCache);
+    }
+    if (full.getStreamBody().isSet()) {
+        return (full);  // NOTE: no length to take ranges of yet, Range is ignored
+    }
+    return (serveRanges(request, full, routeConfig));
 }
 
 }  // namespace webserver
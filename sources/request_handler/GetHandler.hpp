@@ -1,11 +1,16 @@
 #ifndef GETHANDLER_HPP
 #define GETHANDLER_HPP
 
+#include <sys/stat.h>
+
 #include <string>
 
 #include "configuration/RouteConfig.hpp"
+#include "file_system/StaticFileCache.hpp"
 #include "http_methods/HttpMethodType.hpp"
 #include "logger/Logger.hpp"
+#include "request/Request.hpp"
+#include "request_handler/ContentEncoding.hpp"
 #include "request_handler/RequestHandler.hpp"
 #include "response/Response.hpp"
 
@@ -32,13 +37,66 @@ private:
         std::string resolvedTarget,
         const RouteConfig& configuration
     );
+    static Response serveFile(
+        const std::string& resolvedTarget,
+        const RouteConfig& routeConfig,
+        StaticFileCache* fileCache
+    );
+    static Response serveSidecar(
+        const std::string& resolvedTarget,
+        const ContentEncoding::Choice& choice,
+        const RouteConfig& routeConfig
+    );
+    static Response serveEncoded(
+        const std::string& resolvedTarget,
+        const std::string& coding,
+        const RouteConfig& routeConfig,
+        StaticFileCache* fileCache
+    );
+    // NOTE: everything after the target is known to be a regular file, or a directory index
+    static Response serveStatic(
+        const Request& request,
+        const std::string& resolvedTarget,
+        const RouteConfig& routeConfig,
+        StaticFileCache* fileCache
+    );
+    static void setValidators(
+        Response& response,
+        const struct ::stat& fileStat,
+        const std::string& coding
+    );
+    static bool negotiatesCoding(const Request& request, const RouteConfig& routeConfig);
+    static Response varyByCoding(const RouteConfig& routeConfig, Response response);
+    // NOTE: the whole file, or the part of it the Range header asks for
+    static Response serveRanges(
+        const Request& request,
+        const Response& full,
+        const RouteConfig& routeConfig
+    );
+    // NOTE: as serveRanges(), or 304 when the client's copy is still current
+    static Response serveCached(
+        const Request& request,
+        const Response& cached,
+        const RouteConfig& routeConfig
+    );
+    static bool isNotModified(
+        const Request& request,
+        const std::string& etag,
+        const std::string& lastModified
+    );
+    static Response notModified(
+        const std::string& etag,
+        const std::string& lastModified,
+        const RouteConfig& routeConfig
+    );
 
 public:
+    // NOTE: fileCache may be NULL, then every file is read from disk
     static Response handleRequest(
-        std::string originalTarget,
+        const Request& request,
         std::string resolvedTarget,
-        bool isCgiRequest,
-        const RouteConfig& routeConfig
+        const RouteConfig& routeConfig,
+        StaticFileCache* fileCache
     );
 };
 }  // namespace webserver
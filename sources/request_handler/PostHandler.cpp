@@ -1,13 +1,13 @@
 #include "PostHandler.hpp"
 
-#include <fstream>
-#include <iostream>
 #include <string>
 
 #include "configuration/RouteConfig.hpp"
 #include "file_system/FileSystem.hpp"
 #include "http_status/HttpStatus.hpp"
 #include "logger/Logger.hpp"
+#include "request/BodySink.hpp"
+#include "request/Request.hpp"
 #include "response/Response.hpp"
 
 using std::string;
@@ -15,9 +15,10 @@ using std::string;
 namespace webserver {
 Logger PostHandler::_log;
 
-Response PostHandler::handleRequest(string target, string body, const RouteConfig& configuration) {
+HttpStatus::CODE
+PostHandler::resolveUploadPath(string target, const RouteConfig& configuration, string& path) {
     if (!configuration.getUploadConfigSection().isUploadEnabled()) {
-        return (configuration.getStatusCatalogue().serveStatusPage(HttpStatus::METHOD_NOT_ALLOWED));
+        return (HttpStatus::METHOD_NOT_ALLOWED);
     }
     target = target.substr(
         configuration.getPath().length(),
@@ -25,24 +26,42 @@ Response PostHandler::handleRequest(string target, string body, const RouteConfi
     );
     if (target.empty()) {
         // NOTE: cannot create without filename
-        return (configuration.getStatusCatalogue().serveStatusPage(HttpStatus::BAD_REQUEST));
+        return (HttpStatus::BAD_REQUEST);
     }
     const string targetFilename = target.substr(target.find_last_of('/', string::npos));
     const string targetFolder = configuration.getUploadConfigSection().getUploadRootFolder() +
                                 target.substr(0, target.find_last_of('/'));
     if (!file_system::fileExists(targetFolder.c_str())) {
         // NOTE: we don't have to create subfolders
-        return (configuration.getStatusCatalogue().serveStatusPage(HttpStatus::BAD_REQUEST));
+        return (HttpStatus::BAD_REQUEST);
     }
-    target = targetFolder + targetFilename;
+    path = targetFolder + targetFilename;
     // NOTE: no, it's not the original argument value, it had route removed
-    _log.stream(LOG_DEBUG) << "Preresolved path: " << target << "\n";
-    if (file_system::isDirectory(target.c_str())) {
-        return (configuration.getStatusCatalogue().serveStatusPage(HttpStatus::BAD_REQUEST));
+    _log.stream(LOG_DEBUG) << "Preresolved path: " << path << "\n";
+    if (file_system::isDirectory(path.c_str())) {
+        return (HttpStatus::BAD_REQUEST);
     }
-    std::ofstream file(target.c_str(), std::ios::binary);
-    file.write(body.data(), static_cast<std::streamsize>(body.size()));
-    file.close();
+    return (HttpStatus::OK);
+}
+
+Response PostHandler::handleRequest(Request& request, const RouteConfig& configuration) {
+    if (request.isBodyStored()) {
+        return (configuration.getStatusCatalogue().serveStatusPage(HttpStatus::CREATED));
+    }
+    string path;
+    const HttpStatus::CODE status = resolveUploadPath(request.getPath(), configuration, path);
+    if (status != HttpStatus::OK) {
+        return (configuration.getStatusCatalogue().serveStatusPage(status));
+    }
+    FileSink file(path);
+    if (!file.isOpen()) {
+        _log.stream(LOG_ERROR) << "Cannot create " << path << "\n";
+        return (configuration.getStatusCatalogue().serveStatusPage(HttpStatus::INTERNAL_SERVER_ERROR
+        ));
+    }
+    const string& body = request.getBody();
+    file.write(body.data(), body.size());
+    file.finish();
     return (configuration.getStatusCatalogue().serveStatusPage(HttpStatus::CREATED));
 }
 
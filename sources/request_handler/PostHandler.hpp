@@ -5,7 +5,9 @@
 
 #include "configuration/RouteConfig.hpp"
 #include "http_methods/HttpMethodType.hpp"
+#include "http_status/HttpStatus.hpp"
 #include "logger/Logger.hpp"
+#include "request/Request.hpp"
 #include "request_handler/RequestHandler.hpp"
 #include "response/Response.hpp"
 
@@ -19,8 +21,10 @@ private:
     ~PostHandler();
 
 public:
-    static Response
-    handleRequest(std::string target, std::string body, const RouteConfig& configuration);
+    // NOTE: the file an upload to target goes to; any status but OK tells why there is none
+    static HttpStatus::CODE
+    resolveUploadPath(std::string target, const RouteConfig& configuration, std::string& path);
+    static Response handleRequest(Request& request, const RouteConfig& configuration);
 };
 }  // namespace webserver
 #endif
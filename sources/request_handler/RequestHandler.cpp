@@ -4,6 +4,7 @@
 
 #include "configuration/RouteConfig.hpp"
 #include "file_system/MimeType.hpp"
+#include "file_system/StaticFileCache.hpp"
 #include "http_methods/HttpMethodType.hpp"
 #include "http_status/HttpException.hpp"
 #include "http_status/HttpStatus.hpp"
@@ -19,15 +20,18 @@ using std::string;
 namespace webserver {
 Logger RequestHandler::_log;
 
-string RequestHandler::serializeAndPrint(const Response& response) {
-    const std::string resp = response.serialize();
+Response RequestHandler::print(const Response& response) {
     if (MimeType::isPrintable(response.getHeader("Content-Type"))) {
-        _log.stream(LOG_TRACE) << "Response:\n" << resp << "\n";
+        _log.stream(LOG_TRACE) << "Response:\n" << response.serialize() << "\n";
     }
-    return (resp);
+    return (response);
 }
 
-string RequestHandler::handleRequest(Request& request, const RouteConfig& configuration) {
+Response RequestHandler::handleRequest(
+    Request& request,
+    const RouteConfig& configuration,
+    StaticFileCache* fileCache
+) {
     if (request.getType() == SHUTDOWN) {
         const Response resp = Response(
             HttpStatus::HTTP_SERVICE_UNAVAILABLE,
@@ -36,11 +40,11 @@ string RequestHandler::handleRequest(Request& request, const RouteConfig& config
             "Server is shutting down",
             MimeType::getMimeType("txt")
         );
-        return (serializeAndPrint(resp));
+        return (print(resp));
     }
     if (configuration.isRedirection()) {
         // NOTE: yes, redirects are checked before allowed methods
-        return (serializeAndPrint(
+        return (print(
             Response(
                 HttpStatus::MOVED_PERMANENTLY,
                 configuration.getStatusCatalogue().getReasonPhrase(HttpStatus::MOVED_PERMANENTLY),
@@ -51,36 +55,30 @@ string RequestHandler::handleRequest(Request& request, const RouteConfig& config
         ));
     }
     if (!configuration.isMethodAllowed(request.getType())) {
-        return (serializeAndPrint(
+        return (print(
             configuration.getStatusCatalogue().serveStatusPage(HttpStatus::METHOD_NOT_ALLOWED)
         ));
     }
-    string body;
     request.setMaxClientBodySizeBytes(configuration.getFolderConfig().getMaxClientBodySizeBytes());
     try {
-        body = request.getBody();
+        request.getBody();  // NOTE: a raw body is decoded and checked here
     } catch (const HttpException& e) {
         // NOTE: BadRequest, PayloadTooLarge
-        return (serializeAndPrint(configuration.getStatusCatalogue().serveStatusPage(e.getCode())));
+        return (print(configuration.getStatusCatalogue().serveStatusPage(e.getCode())));
     }
     const string resolvedTarget =
         configuration.getFolderConfig().getResolvedPath(request.getPath());
-    Response response(-1, "", "", "");
+    Response response(REROUTE_TO_CGI, "", "", "");
     switch (request.getType()) {
         case GET: {
             _log.stream(LOG_TRACE) << "Preresolved path: " << resolvedTarget << "\n";
-            response = GetHandler::handleRequest(
-                request.getPath(),
-                resolvedTarget,
-                request.isCgiRequest(),
-                configuration
-            );
+            response = GetHandler::handleRequest(request, resolvedTarget, configuration, fileCache);
             break;
         }
         case POST: {
             // NOTE: path will be reresolved later inside
             if (!request.isCgiRequest()) {
-                response = PostHandler::handleRequest(request.getPath(), body, configuration);
+                response = PostHandler::handleRequest(request, configuration);
             }
             break;
         }
@@ -97,10 +95,10 @@ string RequestHandler::handleRequest(Request& request, const RouteConfig& config
             break;
         }
     }
-    if (response.getStatus() == -1) {
-        return ("CGI");
+    if (response.getStatus() == REROUTE_TO_CGI) {
+        return (response);
     }
-    return (serializeAndPrint(response));
+    return (print(response));
 }
 
 }  // namespace webserver
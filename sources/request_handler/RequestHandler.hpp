@@ -5,6 +5,7 @@
 
 #include "configuration/AppConfig.hpp"
 #include "configuration/RouteConfig.hpp"
+#include "file_system/StaticFileCache.hpp"
 #include "logger/Logger.hpp"
 #include "request/Request.hpp"
 #include "response/Response.hpp"
@@ -23,11 +24,18 @@ private:
     RequestHandler();
     RequestHandler(const RequestHandler& other);
     RequestHandler& operator=(const RequestHandler& other);
-    static std::string serializeAndPrint(const Response& response);
+    static Response print(const Response& response);
 
 public:
+    // NOTE: status of the placeholder response returned when the request has to go to CGI
+    static const int REROUTE_TO_CGI = -1;
+
     ~RequestHandler();
-    static std::string handleRequest(Request& request, const RouteConfig& configuration);
+    static Response handleRequest(
+        Request& request,
+        const RouteConfig& configuration,
+        StaticFileCache* fileCache
+    );
 };
 
 }  // namespace webserver
@@ -0,0 +1,289 @@
+#include "DeflateEncoder.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using std::string;
+
+namespace {
+const unsigned int END_OF_BLOCK = 256;
+const unsigned long BYTE_MASK = 0xff;
+const unsigned long WORD_MASK = 0xffffffffUL;
+const int BITS_PER_BYTE = 8;
+
+// NOTE: RFC 1951 3.2.5, lengths 3..258 and distances 1..32768 as a code and extra bits
+const size_t LENGTH_CODES = 29;
+const unsigned int LENGTH_BASE[LENGTH_CODES] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,
+                                                15, 17, 19, 23, 27, 31, 35, 43,  51,  59,
+                                                67, 83, 99, 115, 131, 163, 195, 227, 258};
+const int LENGTH_EXTRA[LENGTH_CODES] =
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const size_t DISTANCE_CODES = 30;
+const unsigned int DISTANCE_BASE[DISTANCE_CODES] = {
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+const int DISTANCE_EXTRA[DISTANCE_CODES] = {0, 0, 0, 0, 1, 1, 2,  2,  3,  3,  4,  4,  5,  5,  6,
+                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+size_t byteAt(const string& buffer, size_t pos) {
+    return (static_cast<unsigned char>(buffer[pos]));
+}
+}  // namespace
+
+namespace webserver {
+const size_t DeflateEncoder::NO_POSITION = static_cast<size_t>(-1);
+
+DeflateEncoder::DeflateEncoder(Format format)
+    : _format(format)
+    , _started(false)
+    , _base(0)
+    , _pos(0)
+    , _head(HASH_SIZE, NO_POSITION)
+    , _prev(WINDOW_SIZE, NO_POSITION)
+    , _bits(0)
+    , _bitCount(0)
+    , _checksum(format == GZIP ? 0 : 1)
+    , _inputSize(0)
+    , _out(NULL) {
+}
+
+DeflateEncoder::~DeflateEncoder() {
+}
+
+const unsigned long* DeflateEncoder::crcTable() {
+    const unsigned long POLYNOMIAL = 0xedb88320UL;
+    const size_t TABLE_SIZE = 256;
+    static unsigned long table[TABLE_SIZE];
+    static bool ready = false;
+    if (!ready) {
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            unsigned long crc = i;
+            for (int bit = 0; bit < BITS_PER_BYTE; bit++) {
+                crc = ((crc & 1) != 0 ? POLYNOMIAL ^ (crc >> 1) : crc >> 1);
+            }
+            table[i] = crc;
+        }
+        ready = true;
+    }
+    return (table);
+}
+
+// NOTE: Huffman codes go most significant bit first into a stream filled from the lowest bit
+unsigned long DeflateEncoder::reverseBits(unsigned long code, int length) {
+    unsigned long res = 0;
+    for (int i = 0; i < length; i++) {
+        res = (res << 1) | ((code >> i) & 1);
+    }
+    return (res);
+}
+
+void DeflateEncoder::updateChecksum(const char* data, size_t size) {
+    const unsigned long ADLER_MODULUS = 65521;
+    const int ADLER_SHIFT = 16;
+    const unsigned long ADLER_HALF_MASK = 0xffff;
+    if (_format == GZIP) {
+        const unsigned long* table = crcTable();
+        unsigned long crc = _checksum ^ WORD_MASK;
+        for (size_t i = 0; i < size; i++) {
+            const unsigned long byte = static_cast<unsigned char>(data[i]);
+            crc = table[(crc ^ byte) & BYTE_MASK] ^ (crc >> BITS_PER_BYTE);
+        }
+        _checksum = crc ^ WORD_MASK;
+        return;
+    }
+    unsigned long low = _checksum & ADLER_HALF_MASK;
+    unsigned long high = (_checksum >> ADLER_SHIFT) & ADLER_HALF_MASK;
+    for (size_t i = 0; i < size; i++) {
+        low = (low + static_cast<unsigned char>(data[i])) % ADLER_MODULUS;
+        high = (high + low) % ADLER_MODULUS;
+    }
+    _checksum = (high << ADLER_SHIFT) | low;
+}
+
+void DeflateEncoder::putBits(unsigned long value, int count) {
+    _bits |= value << _bitCount;
+    _bitCount += count;
+    while (_bitCount >= BITS_PER_BYTE) {
+        _out->push_back(static_cast<char>(_bits & BYTE_MASK));
+        _bits >>= BITS_PER_BYTE;
+        _bitCount -= BITS_PER_BYTE;
+    }
+}
+
+// NOTE: the fixed literal/length code of RFC 1951 3.2.6
+void DeflateEncoder::putSymbol(unsigned int symbol) {
+    const unsigned int FIRST_NINE_BIT = 144;
+    const unsigned int FIRST_SEVEN_BIT = 256;
+    const unsigned int FIRST_LONG_EIGHT_BIT = 280;
+    if (symbol < FIRST_NINE_BIT) {
+        putBits(reverseBits(0x30 + symbol, 8), 8);
+    } else if (symbol < FIRST_SEVEN_BIT) {
+        putBits(reverseBits(0x190 + symbol - FIRST_NINE_BIT, 9), 9);
+    } else if (symbol < FIRST_LONG_EIGHT_BIT) {
+        putBits(reverseBits(symbol - FIRST_SEVEN_BIT, 7), 7);
+    } else {
+        putBits(reverseBits(0xc0 + symbol - FIRST_LONG_EIGHT_BIT, 8), 8);
+    }
+}
+
+void DeflateEncoder::putMatch(size_t length, size_t distance) {
+    const int DISTANCE_CODE_BITS = 5;
+    size_t code = LENGTH_CODES - 1;
+    while (LENGTH_BASE[code] > length) {
+        code--;
+    }
+    putSymbol(static_cast<unsigned int>(END_OF_BLOCK + 1 + code));
+    putBits(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+    code = DISTANCE_CODES - 1;
+    while (DISTANCE_BASE[code] > distance) {
+        code--;
+    }
+    putBits(reverseBits(code, DISTANCE_CODE_BITS), DISTANCE_CODE_BITS);
+    putBits(distance - DISTANCE_BASE[code], DISTANCE_EXTRA[code]);
+}
+
+void DeflateEncoder::putBigEndian(unsigned long value) {
+    for (int shift = 3 * BITS_PER_BYTE; shift >= 0; shift -= BITS_PER_BYTE) {
+        _out->push_back(static_cast<char>((value >> shift) & BYTE_MASK));
+    }
+}
+
+void DeflateEncoder::putLittleEndian(unsigned long value) {
+    for (int shift = 0; shift < 4 * BITS_PER_BYTE; shift += BITS_PER_BYTE) {
+        _out->push_back(static_cast<char>((value >> shift) & BYTE_MASK));
+    }
+}
+
+void DeflateEncoder::putHeader() {
+    if (_format == GZIP) {
+        // NOTE: magic, deflate, no flags, no mtime, no extra flags, OS unix
+        const char header[] = {'\x1f', '\x8b', '\x08', 0, 0, 0, 0, 0, 0, '\x03'};
+        _out->append(header, sizeof(header));
+    } else {
+        // NOTE: deflate with a 32 KiB window, fastest-level hint, check bits so it divides by 31
+        const char header[] = {'\x78', '\x01'};
+        _out->append(header, sizeof(header));
+    }
+}
+
+void DeflateEncoder::putTrailer() {
+    if (_format == GZIP) {
+        putLittleEndian(_checksum);
+        putLittleEndian(_inputSize & WORD_MASK);
+    } else {
+        putBigEndian(_checksum);
+    }
+}
+
+size_t DeflateEncoder::hashAt(size_t pos) const {
+    const int SHIFT = 5;
+    const size_t value = (byteAt(_buffer, pos) << (2 * SHIFT)) ^
+                         (byteAt(_buffer, pos + 1) << SHIFT) ^ byteAt(_buffer, pos + 2);
+    return (value & (HASH_SIZE - 1));
+}
+
+void DeflateEncoder::insert(size_t pos) {
+    if (pos + MIN_MATCH > _buffer.size()) {
+        return;
+    }
+    const size_t hash = hashAt(pos);
+    const size_t absolute = _base + pos;
+    _prev[absolute & (WINDOW_SIZE - 1)] = _head[hash];
+    _head[hash] = absolute;
+}
+
+// NOTE: 0 when nothing of at least MIN_MATCH bytes is in the window
+size_t DeflateEncoder::longestMatch(size_t pos, size_t& distance) const {
+    const size_t absolute = _base + pos;
+    const size_t limit = (_buffer.size() - pos < MAX_MATCH ? _buffer.size() - pos : MAX_MATCH);
+    size_t best = 0;
+    size_t candidate = _head[hashAt(pos)];
+    for (size_t chain = 0; chain < MAX_CHAIN && candidate != NO_POSITION; chain++) {
+        if (candidate < _base || candidate >= absolute || absolute - candidate > WINDOW_SIZE) {
+            break;
+        }
+        const size_t from = candidate - _base;
+        if (_buffer[from + best] == _buffer[pos + best]) {
+            size_t length = 0;
+            while (length < limit && _buffer[from + length] == _buffer[pos + length]) {
+                length++;
+            }
+            if (length > best) {
+                best = length;
+                distance = pos - from;
+                if (best == limit) {
+                    break;
+                }
+            }
+        }
+        const size_t next = _prev[candidate & (WINDOW_SIZE - 1)];
+        if (next == NO_POSITION || next >= candidate) {
+            break;
+        }
+        candidate = next;
+    }
+    return (best >= MIN_MATCH ? best : 0);
+}
+
+// NOTE: without flush, stops where a match could still grow with input yet to come
+void DeflateEncoder::encode(bool flush) {
+    while (_pos < _buffer.size() && (flush || _pos + MAX_MATCH <= _buffer.size())) {
+        size_t distance = 0;
+        const size_t length =
+            (_pos + MIN_MATCH <= _buffer.size() ? longestMatch(_pos, distance) : 0);
+        if (length == 0) {
+            putSymbol(static_cast<unsigned char>(_buffer[_pos]));
+            insert(_pos);
+            _pos++;
+            continue;
+        }
+        putMatch(length, distance);
+        for (size_t i = 0; i < length; i++) {
+            insert(_pos + i);
+        }
+        _pos += length;
+    }
+    if (_pos > 2 * WINDOW_SIZE) {
+        const size_t drop = _pos - WINDOW_SIZE;
+        _buffer.erase(0, drop);
+        _base += drop;
+        _pos -= drop;
+    }
+}
+
+// NOTE: one fixed-code block per call, ten bits of framing each
+void DeflateEncoder::write(const char* data, size_t size, string& out) {
+    _out = &out;
+    if (!_started) {
+        putHeader();
+        _started = true;
+    }
+    updateChecksum(data, size);
+    _inputSize += size;
+    _buffer.append(data, size);
+    putBits(0, 1);  // NOTE: not the last block
+    putBits(1, 2);  // NOTE: fixed Huffman codes
+    encode(false);
+    putSymbol(END_OF_BLOCK);
+    _out = NULL;
+}
+
+void DeflateEncoder::finish(string& out) {
+    _out = &out;
+    if (!_started) {
+        putHeader();
+        _started = true;
+    }
+    putBits(1, 1);  // NOTE: the last block
+    putBits(1, 2);
+    encode(true);
+    putSymbol(END_OF_BLOCK);
+    if (_bitCount > 0) {
+        putBits(0, BITS_PER_BYTE - _bitCount);
+    }
+    putTrailer();
+    _out = NULL;
+}
+}  // namespace webserver
@@ -0,0 +1,68 @@
+#ifndef DEFLATEENCODER_HPP
+#define DEFLATEENCODER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace webserver {
+/* NOTE: DEFLATE (RFC 1951) wrapped as gzip (RFC 1952) or zlib (RFC 1950),
+* the two codings HTTP calls gzip and deflate; no compression library is on the allowed list.
+* LZ77 over a 32 KiB window with hash chains, then the fixed Huffman code of the format:
+* a bit behind what zlib gets on text, for no code tables to build or send.
+* input is taken as it comes, each write() appends the bytes that are done to out,
+* so a file can go through it block by block without ever being held whole.
+*/
+class DeflateEncoder {
+public:
+    enum Format { GZIP, ZLIB };
+
+    explicit DeflateEncoder(Format format);
+    ~DeflateEncoder();
+
+    void write(const char* data, size_t size, std::string& out);
+    void finish(std::string& out);  // NOTE: no write() after it
+
+private:
+    static const size_t WINDOW_SIZE = 32768;
+    static const size_t MIN_MATCH = 3;
+    static const size_t MAX_MATCH = 258;
+    static const size_t HASH_SIZE = 32768;
+    static const size_t MAX_CHAIN = 64;  // NOTE: candidates looked at per position
+    static const size_t NO_POSITION;
+
+    Format _format;
+    bool _started;
+    std::string _buffer;  // NOTE: the window behind _pos and the input ahead of it
+    size_t _base;         // NOTE: position in the whole input of _buffer[0]
+    size_t _pos;          // NOTE: next byte of _buffer to encode
+    std::vector<size_t> _head;  // NOTE: hash: latest position in the whole input
+    std::vector<size_t> _prev;  // NOTE: position % WINDOW_SIZE: the one before it with its hash
+    unsigned long _bits;
+    int _bitCount;
+    unsigned long _checksum;  // NOTE: CRC-32 for gzip, Adler-32 for zlib
+    unsigned long _inputSize;
+    std::string* _out;
+
+    static const unsigned long* crcTable();
+    static unsigned long reverseBits(unsigned long code, int length);
+
+    size_t hashAt(size_t pos) const;
+    void insert(size_t pos);
+    size_t longestMatch(size_t pos, size_t& distance) const;
+    void encode(bool flush);
+    void updateChecksum(const char* data, size_t size);
+    void putBits(unsigned long value, int count);
+    void putSymbol(unsigned int symbol);
+    void putMatch(size_t length, size_t distance);
+    void putHeader();
+    void putTrailer();
+    void putBigEndian(unsigned long value);
+    void putLittleEndian(unsigned long value);
+
+    DeflateEncoder();
+    DeflateEncoder(const DeflateEncoder& other);
+    DeflateEncoder& operator=(const DeflateEncoder& other);
+};
+}  // namespace webserver
+#endif
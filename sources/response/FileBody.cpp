@@ -0,0 +1,138 @@
+#include "FileBody.hpp"
+
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+
+namespace webserver {
+FileBody::FileBody()
+    : _fd(-1)
+    , _current(0)
+    , _leadSent(0)
+    , _length(0)
+    , _owners(NULL) {
+}
+
+FileBody::FileBody(int fd, off_t offset, size_t length)
+    : _fd(fd)
+    , _current(0)
+    , _leadSent(0)
+    , _length(0)
+    , _owners(new int(1)) {
+    append("", offset, length);
+}
+
+FileBody::FileBody(const FileBody& other)
+    : _fd(other._fd)
+    , _parts(other._parts)
+    , _current(other._current)
+    , _leadSent(other._leadSent)
+    , _length(other._length)
+    , _owners(other._owners) {
+    if (_owners != NULL) {
+        (*_owners)++;
+    }
+}
+
+FileBody& FileBody::operator=(const FileBody& other) {
+    if (this == &other) {
+        return (*this);
+    }
+    release();
+    _fd = other._fd;
+    _parts = other._parts;
+    _current = other._current;
+    _leadSent = other._leadSent;
+    _length = other._length;
+    _owners = other._owners;
+    if (_owners != NULL) {
+        (*_owners)++;
+    }
+    return (*this);
+}
+
+FileBody::~FileBody() {
+    release();
+}
+
+void FileBody::release() {
+    if (_owners == NULL) {
+        return;
+    }
+    (*_owners)--;
+    if (*_owners == 0) {
+        close(_fd);
+        delete _owners;
+    }
+    _fd = -1;
+    _parts.clear();
+    _current = 0;
+    _leadSent = 0;
+    _length = 0;
+    _owners = NULL;
+}
+
+bool FileBody::isSet() const {
+    return (_owners != NULL);
+}
+
+size_t FileBody::getLength() const {
+    return (_length);
+}
+
+FileBody FileBody::slice(const std::string& lead, off_t offset, size_t length) const {
+    FileBody res(*this);
+    res._parts.clear();
+    res._current = 0;
+    res._leadSent = 0;
+    res._length = 0;
+    res.append(lead, offset, length);
+    return (res);
+}
+
+FileBody& FileBody::append(const std::string& lead, off_t offset, size_t length) {
+    Part part;
+    part.lead = lead;
+    part.offset = offset;
+    part.length = length;
+    _parts.push_back(part);
+    _length += lead.size() + length;
+    return (*this);
+}
+
+ssize_t FileBody::sendTo(int socketFd, size_t maxBytes) {
+    while (_current < _parts.size()) {
+        Part& part = _parts[_current];
+        if (_leadSent < part.lead.size()) {
+            const size_t left = part.lead.size() - _leadSent;
+            const ssize_t sent = send(
+                socketFd,
+                part.lead.data() + _leadSent,
+                (left < maxBytes ? left : maxBytes),
+                MSG_NOSIGNAL
+            );
+            if (sent > 0) {
+                _leadSent += sent;
+                _length -= sent;
+            }
+            return (sent);
+        }
+        if (part.length > 0) {
+            const size_t count = (part.length < maxBytes ? part.length : maxBytes);
+            const ssize_t sent = sendfile(socketFd, _fd, &part.offset, count);
+            if (sent > 0) {
+                part.length -= sent;  // NOTE: sendfile() has moved part.offset itself
+                _length -= sent;
+            }
+            return (sent);
+        }
+        _current++;
+        _leadSent = 0;
+    }
+    return (0);
+}
+}  // namespace webserver
@@ -0,0 +1,54 @@
+#ifndef FILEBODY_HPP
+#define FILEBODY_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace webserver {
+/* NOTE: file-backed response body: an open descriptor and the byte ranges still to be sent.
+* the bytes go from the page cache to the socket with sendfile() and never pass through us.
+* Response is copied by value on its way to the Connection,
+* so copies share the descriptor through a counter and the last one closes it.
+* each copy keeps its own ranges: sendfile() is given the offset explicitly,
+* the shared file position is never moved.
+* a range may have a few bytes of our own to go before it, the delimiters of multipart/byteranges.
+*/
+class FileBody {
+private:
+    struct Part {
+        std::string lead;  // NOTE: sent before the range, usually empty
+        off_t offset;
+        size_t length;
+    };
+
+    int _fd;
+    std::vector<Part> _parts;
+    size_t _current;   // NOTE: parts before it are sent
+    size_t _leadSent;  // NOTE: of the current part's lead
+    size_t _length;    // NOTE: left to send, leads included
+    int* _owners;
+
+    void release();
+
+public:
+    FileBody();
+    FileBody(int fd, off_t offset, size_t length);  // NOTE: takes ownership of fd
+    FileBody(const FileBody& other);
+    FileBody& operator=(const FileBody& other);
+    ~FileBody();
+
+    bool isSet() const;
+    size_t getLength() const;
+    // NOTE: another body on the same descriptor: lead, then length bytes from offset
+    FileBody slice(const std::string& lead, off_t offset, size_t length) const;
+    FileBody& append(const std::string& lead, off_t offset, size_t length);
+    /* NOTE: sends at most maxBytes of what is left and advances past them.
+    * returns what send() or sendfile() returned: -1 with errno EAGAIN means the socket is full.
+    */
+    ssize_t sendTo(int socketFd, size_t maxBytes);
+};
+}  // namespace webserver
+#endif
@@ -7,6 +7,7 @@
 
 #include "http_status/HttpStatus.hpp"
 #include "logger/Logger.hpp"
+#include "response/FileBody.hpp"
 #include "utils/utils.hpp"
 
 using std::string;
@@ -39,7 +40,9 @@ Response::Response(const Response& other)
     : _statusCode(other._statusCode)
     , _reasonPhrase(other._reasonPhrase)
     , _headers(other._headers)
-    , _body(other._body) {
+    , _body(other._body)
+    , _fileBody(other._fileBody)
+    , _streamBody(other._streamBody) {
 }
 
 Response& Response::operator=(const Response& other) {
@@ -47,6 +50,8 @@ Response& Response::operator=(const Response& other) {
         _statusCode = other._statusCode;
         _reasonPhrase = other._reasonPhrase;
         _body = other._body;
+        _fileBody = other._fileBody;
+        _streamBody = other._streamBody;
         _headers = other._headers;
     }
     return (*this);
@@ -76,18 +81,60 @@ Response& Response::setStatus(int status) {
     return (*this);
 }
 
+Response& Response::setReasonPhrase(const std::string& reasonPhrase) {
+    _reasonPhrase = reasonPhrase;
+    return (*this);
+}
+
+const FileBody& Response::getFileBody() const {
+    return (_fileBody);
+}
+
+const StreamBody& Response::getStreamBody() const {
+    return (_streamBody);
+}
+
 Response& Response::setBody(std::string fileContent) {
     _body = fileContent;
+    _fileBody = FileBody();
+    _streamBody = StreamBody();
     _headers["Content-Length"] = utils::toString(_body.size());
     return (*this);
 }
 
+Response& Response::setFileBody(const FileBody& fileBody) {
+    _body.clear();
+    _fileBody = fileBody;
+    _streamBody = StreamBody();
+    _headers["Content-Length"] = utils::toString(_fileBody.getLength());
+    return (*this);
+}
+
+Response& Response::setStreamBody(const StreamBody& streamBody) {
+    _body.clear();
+    _fileBody = FileBody();
+    _streamBody = streamBody;
+    _streamBody.setChunked(true);
+    _headers.erase("Content-Length");
+    _headers["Transfer-Encoding"] = "chunked";
+    return (*this);
+}
+
 Response& Response::setHeader(const std::string& key, const std::string& value) {
     _headers[key] = value;
     return (*this);
 }
 
+Response& Response::removeHeader(const std::string& key) {
+    _headers.erase(key);
+    return (*this);
+}
+
 string Response::serialize(void) const {
+    return (serializeHead() + _body);
+}
+
+string Response::serializeHead(void) const {
     _log.stream(LOG_TRACE) << "Serializing HTTP response\n";
 
     std::ostringstream resp;
@@ -105,9 +152,6 @@ string Response::serialize(void) const {
     // NOTE: END OF HEADERS
     resp << "\r\n";
 
-    // NOTE: BODY
-    resp << _body;
-
     _log.stream(LOG_TRACE) << "HTTP response serialized\n";
 
     return (resp.str());
@@ -5,8 +5,10 @@
 #include <string>
 
 #include "logger/Logger.hpp"
+#include "response/FileBody.hpp"
+#include "response/StreamBody.hpp"
 
-#define HTTP_PROTOCOL "HTTP/1.0"
+#define HTTP_PROTOCOL "HTTP/1.1"
 #define SERVER_NAME "OurWebServer/1.0"
 
 namespace webserver {
@@ -18,6 +20,8 @@ private:
     std::string _reasonPhrase;
     std::map<std::string, std::string> _headers;
     std::string _body;
+    FileBody _fileBody;  // NOTE: replaces _body for large static files
+    StreamBody _streamBody;  // NOTE: replaces _body when its length is not known up front
 
 public:
     Response();
@@ -32,14 +36,22 @@ public:
     ~Response();
 
     std::string serialize() const;
+    std::string serializeHead() const;  // NOTE: status line and headers only
 
     int getStatus() const;
     const std::string& getBody() const;
+    const FileBody& getFileBody() const;
+    const StreamBody& getStreamBody() const;
     std::string getHeader(const std::string& key) const;
 
     Response& setStatus(int status);
+    Response& setReasonPhrase(const std::string& reasonPhrase);
     Response& setBody(std::string fileContent);
+    Response& setFileBody(const FileBody& fileBody);
+    // NOTE: sent as Transfer-Encoding: chunked, the connection drops that for an HTTP/1.0 client
+    Response& setStreamBody(const StreamBody& streamBody);
     Response& setHeader(const std::string& key, const std::string& value);
+    Response& removeHeader(const std::string& key);
 };
 }  // namespace webserver
 #endif
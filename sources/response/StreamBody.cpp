@@ -0,0 +1,180 @@
+#include "StreamBody.hpp"
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+namespace webserver {
+StreamBody::Producer::~Producer() {
+}
+
+StreamBody::StreamBody()
+    : _producer(NULL)
+    , _owners(NULL)
+    , _isChunked(false)
+    , _isClosed(false)
+    , _isAbandoned(false)
+    , _pendingSent(0)
+    , _bodyBytes(0) {
+}
+
+StreamBody::StreamBody(Producer* producer)
+    : _producer(producer)
+    , _owners(new int(1))
+    , _isChunked(false)
+    , _isClosed(false)
+    , _isAbandoned(false)
+    , _pendingSent(0)
+    , _bodyBytes(0) {
+}
+
+StreamBody::StreamBody(const StreamBody& other)
+    : _producer(other._producer)
+    , _owners(other._owners)
+    , _isChunked(other._isChunked)
+    , _isClosed(other._isClosed)
+    , _isAbandoned(other._isAbandoned)
+    , _pending(other._pending)
+    , _pendingSent(other._pendingSent)
+    , _bodyBytes(other._bodyBytes) {
+    if (_owners != NULL) {
+        (*_owners)++;
+    }
+}
+
+StreamBody& StreamBody::operator=(const StreamBody& other) {
+    if (this == &other) {
+        return (*this);
+    }
+    release();
+    _producer = other._producer;
+    _owners = other._owners;
+    _isChunked = other._isChunked;
+    _isClosed = other._isClosed;
+    _isAbandoned = other._isAbandoned;
+    _pending = other._pending;
+    _pendingSent = other._pendingSent;
+    _bodyBytes = other._bodyBytes;
+    if (_owners != NULL) {
+        (*_owners)++;
+    }
+    return (*this);
+}
+
+StreamBody::~StreamBody() {
+    release();
+}
+
+void StreamBody::release() {
+    if (_owners == NULL) {
+        return;
+    }
+    (*_owners)--;
+    if (*_owners == 0) {
+        delete _producer;
+        delete _owners;
+    }
+    _producer = NULL;
+    _owners = NULL;
+    _isChunked = false;
+    _isClosed = false;
+    _isAbandoned = false;
+    _pending.clear();
+    _pendingSent = 0;
+    _bodyBytes = 0;
+}
+
+bool StreamBody::isSet() const {
+    return (_owners != NULL);
+}
+
+bool StreamBody::isChunked() const {
+    return (_isChunked);
+}
+
+StreamBody& StreamBody::setChunked(bool isChunked) {
+    _isChunked = isChunked;
+    return (*this);
+}
+
+void StreamBody::write(const char* data, size_t size) {
+    if (size == 0 || _isClosed) {
+        return;
+    }
+    // NOTE: what was sent already goes, the buffer holds only the backlog
+    _pending.erase(0, _pendingSent);
+    _pendingSent = 0;
+    if (_isChunked) {
+        std::ostringstream chunkSize;
+        chunkSize << std::hex << size << "\r\n";
+        _pending += chunkSize.str();
+        _pending.append(data, size);
+        _pending += "\r\n";
+    } else {
+        _pending.append(data, size);
+    }
+    _bodyBytes += size;
+}
+
+void StreamBody::close() {
+    if (_isClosed) {
+        return;
+    }
+    if (_isChunked) {
+        _pending.erase(0, _pendingSent);
+        _pendingSent = 0;
+        _pending += "0\r\n\r\n";
+    }
+    _isClosed = true;
+}
+
+void StreamBody::abandon() {
+    _isClosed = true;
+    _isAbandoned = true;
+}
+
+bool StreamBody::isAbandoned() const {
+    return (_isAbandoned);
+}
+
+size_t StreamBody::getBodyBytes() const {
+    return (_bodyBytes);
+}
+
+size_t StreamBody::getPendingBytes() const {
+    return (_pending.size() - _pendingSent);
+}
+
+bool StreamBody::isSent() const {
+    return (_owners == NULL || (_isClosed && getPendingBytes() == 0));
+}
+
+bool StreamBody::isStarved() const {
+    return (_owners != NULL && !_isClosed && _producer == NULL && getPendingBytes() == 0);
+}
+
+ssize_t StreamBody::sendTo(int socketFd, size_t maxBytes) {
+    if (getPendingBytes() == 0 && !_isClosed && _producer != NULL) {
+        _producer->produce(*this);
+    }
+    size_t count = getPendingBytes();
+    if (count == 0) {
+        return (0);
+    }
+    if (count > maxBytes) {
+        count = maxBytes;
+    }
+    const ssize_t sent = send(socketFd, _pending.data() + _pendingSent, count, MSG_NOSIGNAL);
+    if (sent > 0) {
+        _pendingSent += static_cast<size_t>(sent);
+    }
+    if (_pendingSent == _pending.size()) {
+        _pending.clear();
+        _pendingSent = 0;
+    }
+    return (sent);
+}
+}  // namespace webserver
@@ -0,0 +1,67 @@
+#ifndef STREAMBODY_HPP
+#define STREAMBODY_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+
+namespace webserver {
+/* NOTE: response body of a length nobody knows when the head goes out.
+* pieces are framed as they are written, as chunks of Transfer-Encoding: chunked
+* or as they are when the connection is to be closed after the body,
+* and wait here only until the socket takes them: the first byte does not wait for the last.
+* the pieces come either from outside, as CGI output does, or from a Producer
+* asked for the next one whenever everything before it is sent.
+* copies share the producer through a counter, the last one deletes it;
+* only one of them should be sent, the framed bytes are each copy's own.
+*/
+class StreamBody {
+public:
+    class Producer {
+    public:
+        virtual ~Producer();
+        // NOTE: writes the next piece into body, or closes it after the last one
+        virtual void produce(StreamBody& body) = 0;
+    };
+
+    StreamBody();
+    // NOTE: takes ownership of producer; NULL when the body is written to from outside
+    explicit StreamBody(Producer* producer);
+    StreamBody(const StreamBody& other);
+    StreamBody& operator=(const StreamBody& other);
+    ~StreamBody();
+
+    bool isSet() const;
+    bool isChunked() const;
+    StreamBody& setChunked(bool isChunked);  // NOTE: before the first write()
+
+    void write(const char* data, size_t size);
+    void close();    // NOTE: the body is complete
+    void abandon();  // NOTE: no more body and no end of it either, the client sees it cut short
+    bool isAbandoned() const;
+
+    size_t getBodyBytes() const;     // NOTE: written so far, without the framing
+    size_t getPendingBytes() const;  // NOTE: framed and not sent yet
+    bool isSent() const;             // NOTE: closed and sent to the end; true for an unset body
+    bool isStarved() const;          // NOTE: all written is sent, more has to come from outside
+    /* NOTE: sends at most maxBytes of what is framed, asking the producer for more first
+    * when nothing is. returns what send() returned: -1 with errno EAGAIN means the socket is full,
+    * 0 that there is nothing to send now.
+    */
+    ssize_t sendTo(int socketFd, size_t maxBytes);
+
+private:
+    Producer* _producer;
+    int* _owners;
+    bool _isChunked;
+    bool _isClosed;
+    bool _isAbandoned;
+    std::string _pending;
+    size_t _pendingSent;
+    size_t _bodyBytes;
+
+    void release();
+};
+}  // namespace webserver
+#endif
@@ -0,0 +1,129 @@
+#include "StringView.hpp"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+using std::string;
+
+namespace {
+char lowerAscii(char chr) {
+    return (chr >= 'A' && chr <= 'Z' ? static_cast<char>(chr - 'A' + 'a') : chr);
+}
+}  // namespace
+
+namespace webserver {
+const size_t StringView::npos = static_cast<size_t>(-1);
+
+StringView::StringView()
+    : _data("")
+    , _size(0) {
+}
+
+StringView::StringView(const char* str)
+    : _data(str)
+    , _size(std::char_traits<char>::length(str)) {
+}
+
+StringView::StringView(const string& str)
+    : _data(str.data())
+    , _size(str.size()) {
+}
+
+StringView::StringView(const char* data, size_t size)
+    : _data(data)
+    , _size(size) {
+}
+
+StringView::StringView(const StringView& other)
+    : _data(other._data)
+    , _size(other._size) {
+}
+
+StringView& StringView::operator=(const StringView& other) {
+    _data = other._data;
+    _size = other._size;
+    return (*this);
+}
+
+StringView::~StringView() {
+}
+
+const char* StringView::data() const {
+    return (_data);
+}
+
+size_t StringView::size() const {
+    return (_size);
+}
+
+bool StringView::empty() const {
+    return (_size == 0);
+}
+
+char StringView::operator[](size_t pos) const {
+    return (_data[pos]);
+}
+
+size_t StringView::find(char chr, size_t from) const {
+    for (size_t i = from; i < _size; ++i) {
+        if (_data[i] == chr) {
+            return (i);
+        }
+    }
+    return (npos);
+}
+
+StringView StringView::substr(size_t pos, size_t count) const {
+    if (pos > _size) {
+        pos = _size;
+    }
+    if (count > _size - pos) {
+        count = _size - pos;
+    }
+    return (StringView(_data + pos, count));
+}
+
+string StringView::str() const {
+    return (string(_data, _size));
+}
+
+bool StringView::equals(const StringView& other) const {
+    return (
+        _size == other._size && std::char_traits<char>::compare(_data, other._data, _size) == 0
+    );
+}
+
+bool StringView::equalsIgnoreCase(const StringView& other) const {
+    if (_size != other._size) {
+        return (false);
+    }
+    for (size_t i = 0; i < _size; ++i) {
+        if (lowerAscii(_data[i]) != lowerAscii(other._data[i])) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+int StringView::compare(const StringView& other) const {
+    const size_t common = (_size < other._size ? _size : other._size);
+    const int res = std::char_traits<char>::compare(_data, other._data, common);
+    if (res != 0 || _size == other._size) {
+        return (res);
+    }
+    return (_size < other._size ? -1 : 1);
+}
+
+bool operator==(const StringView& lhs, const StringView& rhs) {
+    return (lhs.equals(rhs));
+}
+
+bool operator!=(const StringView& lhs, const StringView& rhs) {
+    return (!lhs.equals(rhs));
+}
+
+std::ostream& operator<<(std::ostream& oss, const StringView& view) {
+    return (oss.write(view.data(), static_cast<std::streamsize>(view.size())));
+}
+}  // namespace webserver
@@ -0,0 +1,48 @@
+#ifndef STRINGVIEW_HPP
+#define STRINGVIEW_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace webserver {
+/* NOTE: a pointer and a length into characters owned by someone else, never copied.
+* built implicitly from a std::string or a literal, so it must not outlive them:
+* request fields point into the request arena and die with it.
+*/
+class StringView {
+public:
+    static const size_t npos;
+
+    StringView();
+    StringView(const char* str);  // NOTE: implicit on purpose
+    StringView(const std::string& str);  // NOTE: implicit on purpose
+    StringView(const char* data, size_t size);
+    StringView(const StringView& other);
+    StringView& operator=(const StringView& other);
+    ~StringView();
+
+    const char* data() const;
+    size_t size() const;
+    bool empty() const;
+    char operator[](size_t pos) const;
+
+    size_t find(char chr, size_t from) const;
+    StringView substr(size_t pos, size_t count) const;  // NOTE: count past the end is cut
+    std::string str() const;
+
+    bool equals(const StringView& other) const;
+    bool equalsIgnoreCase(const StringView& other) const;  // NOTE: ASCII only
+    int compare(const StringView& other) const;
+
+private:
+    const char* _data;
+    size_t _size;
+};
+
+bool operator==(const StringView& lhs, const StringView& rhs);
+bool operator!=(const StringView& lhs, const StringView& rhs);
+std::ostream& operator<<(std::ostream& oss, const StringView& view);
+}  // namespace webserver
+
+#endif
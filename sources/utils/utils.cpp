@@ -15,6 +15,36 @@
 using std::ostringstream;
 using std::string;
 
+namespace {
+const char* const MONTHS[] =
+    {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+bool parseDigits(const string& text, size_t pos, size_t count, long& value) {
+    const long BASE = 10;
+    value = 0;
+    for (size_t i = pos; i < pos + count; i++) {
+        if (i >= text.size() || text[i] < '0' || text[i] > '9') {
+            return (false);
+        }
+        value = value * BASE + (text[i] - '0');
+    }
+    return (true);
+}
+
+// NOTE: days since 1970-01-01 in the proleptic Gregorian calendar; timegm() is not on the list
+long daysFromCivil(long year, long month, long day) {
+    const long DAYS_PER_ERA = 146097;
+    const long YEARS_PER_ERA = 400;
+    const long EPOCH_SHIFT = 719468;  // NOTE: 0000-03-01 to 1970-01-01
+    year -= (month <= 2 ? 1 : 0);
+    const long era = (year >= 0 ? year : year - (YEARS_PER_ERA - 1)) / YEARS_PER_ERA;
+    const long yearOfEra = year - era * YEARS_PER_ERA;
+    const long dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return (era * DAYS_PER_ERA + dayOfEra - EPOCH_SHIFT);
+}
+}  // namespace
+
 namespace utils {
 string separator(void) {
     ostringstream oss;
@@ -35,12 +65,67 @@ string toString(std::size_t value) {
 }
 
 string getTimestamp() {
-    const std::time_t now = std::time(0);
-    const std::tm gmt = *std::gmtime(&now);
+    return (toHttpDate(std::time(0)));
+}
+
+string toHttpDate(std::time_t when) {
+    const std::tm gmt = *std::gmtime(&when);
     const int BUFSIZE = 64;
     char buf[BUFSIZE];
     std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
     return (string(buf));
 }
 
+bool parseHttpDate(const string& text, std::time_t& when) {
+    const size_t LENGTH = 29;  // NOTE: Sun, 06 Nov 1994 08:49:37 GMT
+    const long SECONDS_PER_DAY = 86400;
+    const long SECONDS_PER_HOUR = 3600;
+    const long SECONDS_PER_MINUTE = 60;
+    const long MONTH_COUNT = 12;
+    if (text.size() != LENGTH || text.compare(3, 2, ", ") != 0 || text[7] != ' ' ||
+        text[11] != ' ' || text[16] != ' ' || text[19] != ':' || text[22] != ':' ||
+        text.compare(25, 4, " GMT") != 0) {
+        return (false);
+    }
+    long month = 0;
+    while (month < MONTH_COUNT && text.compare(8, 3, MONTHS[month]) != 0) {
+        month++;
+    }
+    long day;
+    long year;
+    long hour;
+    long minute;
+    long second;
+    if (month == MONTH_COUNT || !parseDigits(text, 5, 2, day) || !parseDigits(text, 12, 4, year) ||
+        !parseDigits(text, 17, 2, hour) || !parseDigits(text, 20, 2, minute) ||
+        !parseDigits(text, 23, 2, second) || day < 1 || day > 31 || hour > 23 || minute > 59 ||
+        second > 60) {
+        return (false);
+    }
+    when = static_cast<std::time_t>(
+        daysFromCivil(year, month + 1, day) * SECONDS_PER_DAY + hour * SECONDS_PER_HOUR +
+        minute * SECONDS_PER_MINUTE + second
+    );
+    return (true);
+}
+
+string toLower(const string& str) {
+    // NOTE: ASCII only, enough for header names and tokens; tolower() is not on the allowed list
+    string res(str);
+    for (size_t i = 0; i < res.size(); i++) {
+        if (res[i] >= 'A' && res[i] <= 'Z') {
+            res[i] = static_cast<char>(res[i] - 'A' + 'a');
+        }
+    }
+    return (res);
+}
+
+string trim(const string& str) {
+    const size_t start = str.find_first_not_of(" \t");
+    if (start == string::npos) {
+        return ("");
+    }
+    return (str.substr(start, str.find_last_not_of(" \t") - start + 1));
+}
+
 }  // namespace utils
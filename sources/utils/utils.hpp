@@ -1,6 +1,7 @@
 #ifndef UTILS_HPP
 #define UTILS_HPP
 
+#include <ctime>
 #include <string>
 
 namespace utils {
@@ -10,6 +11,11 @@ std::string toString(int value);
 std::string toString(std::size_t value);
 
 std::string getTimestamp();
+std::string toHttpDate(std::time_t when);  // NOTE: IMF-fixdate, as in Date and Last-Modified
+// NOTE: IMF-fixdate only; the obsolete RFC 850 and asctime() forms are rejected
+bool parseHttpDate(const std::string& text, std::time_t& when);
+std::string toLower(const std::string& str);
+std::string trim(const std::string& str);  // NOTE: spaces and tabs, as around header values
 
 const int KIB = 1024;
 const int MIB = 1024 * 1024;
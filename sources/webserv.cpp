@@ -2,10 +2,16 @@
 #include <string>
 
 #include "WebServer.hpp"
+#include "cgi_handler/CgiWorker.hpp"
 #include "configuration/parser/ConfigParsingException.hpp"
 #include "logger/Logger.hpp"
 
 int main(int argc, char* argv[]) {
+    // NOTE: started by the server itself for a CGI worker pool
+    if (argc == 3 && std::string(argv[1]) == webserver::CgiWorker::FLAG) {
+        webserver::CgiWorker worker(argv[2]);
+        return (worker.run());
+    }
     webserver::Logger log;
     if (argc != 2) {
         log.stream(LOG_FATAL) << "Failed to launch: no config file provided.\n"
@@ -25,10 +31,9 @@ int main(int argc, char* argv[]) {
     }
     try {
         webserver::WebServer& server = webserver::WebServer::getInstance(argv[1]);
-        server.start();
+        return (server.start());
     } catch (const std::exception& e) {
         log.stream(LOG_FATAL) << "Fatal runtime error: " << e.what() << "\n";
         return (1);
     }
-    return (0);
 }
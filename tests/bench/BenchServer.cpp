@@ -0,0 +1,203 @@
+#include "BenchServer.hpp"
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using std::ostringstream;
+using std::runtime_error;
+using std::string;
+
+namespace {
+int removeEntry(const char* path, const struct stat* info, int flag, struct FTW* ftw) {
+    (void)info;
+    (void)flag;
+    (void)ftw;
+    return (std::remove(path));
+}
+
+// NOTE: a port nobody listens on right now; the kernel picks it, the server binds it a moment later
+int findFreePort() {
+    const int probe = socket(AF_INET, SOCK_STREAM, 0);
+    if (probe == -1) {
+        throw runtime_error("socket() failed");
+    }
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = 0;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(probe, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1 ||
+        getsockname(probe, reinterpret_cast<struct sockaddr*>(&addr), &len) == -1) {
+        close(probe);
+        throw runtime_error("no free port for the benchmark");
+    }
+    close(probe);
+    return (ntohs(addr.sin_port));
+}
+}  // namespace
+
+namespace bench {
+BenchServer::BenchServer(const string& executable, const string& eventBackend)
+    : _executable(executable)
+    , _eventBackend(eventBackend)
+    , _port(findFreePort())
+    , _pid(-1) {
+    char pattern[] = "/tmp/webserv_bench.XXXXXX";
+    if (mkdtemp(pattern) == NULL) {
+        throw runtime_error("mkdtemp() failed");
+    }
+    _workspace = pattern;
+}
+
+// NOTE: a server that died on its own leaves its directory behind, log included
+BenchServer::~BenchServer() {
+    if (!isRunning()) {
+        std::fprintf(stderr, "webserv is gone, its files are kept in %s\n", _workspace.c_str());
+        return;
+    }
+    stop();
+    nftw(_workspace.c_str(), removeEntry, MAX_OPEN_DIRECTORIES, FTW_DEPTH | FTW_PHYS);
+}
+
+void BenchServer::makeDirectory(const string& path) const {
+    if (mkdir(path.c_str(), 0755) == -1) {
+        throw runtime_error("mkdir() failed for " + path);
+    }
+}
+
+void BenchServer::writeFile(const string& path, const string& content) const {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    if (!file) {
+        throw runtime_error("cannot write " + path);
+    }
+}
+
+void BenchServer::writeFixtures() const {
+    makeDirectory(_workspace + "/www");
+    makeDirectory(_workspace + "/www/upload");
+    makeDirectory(_workspace + "/www/cgi");
+    writeFile(_workspace + "/www/1k.bin", string(SMALL_FILE_BYTES, 'a'));
+    writeFile(_workspace + "/www/64k.bin", string(MEDIUM_FILE_BYTES, 'b'));
+    writeFile(_workspace + "/www/1m.bin", string(LARGE_FILE_BYTES, 'c'));
+    writeFile(
+        _workspace + "/www/cgi/hello.sh",
+        "printf 'Content-Type: text/plain\\r\\n\\r\\nhello from %s\\n' \"$REQUEST_METHOD\"\n"
+    );
+}
+
+void BenchServer::writeConfig() const {
+    const string www = _workspace + "/www";
+    ostringstream conf;
+    conf << "event_backend " << _eventBackend << ";\n"
+         << "\n"
+         << "server {\n"
+         << "    listen 127.0.0.1:" << _port << ";\n"
+         << "    client_max_body_size 10M;\n"
+         << "    keepalive_requests 1000000;\n"
+         << "\n"
+         << "    location / {\n"
+         << "        methods GET;\n"
+         << "        root " << www << ";\n"
+         << "    }\n"
+         << "\n"
+         << "    location /upload {\n"
+         << "        methods POST;\n"
+         << "        root " << www << "/upload;\n"
+         << "        upload on " << www << "/upload;\n"
+         << "    }\n"
+         << "\n"
+         << "    location /cgi {\n"
+         << "        methods GET;\n"
+         << "        root " << www << "/cgi;\n"
+         << "    }\n"
+         << "\n"
+         << "    cgi .sh /bin/sh;\n"
+         << "}\n";
+    writeFile(_workspace + "/bench.conf", conf.str());
+}
+
+bool BenchServer::acceptsConnections() const {
+    const int probe = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const bool connected =
+        (connect(probe, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+    close(probe);
+    return (connected);
+}
+
+void BenchServer::start() {
+    const int POLL_STEP_US = 10000;
+    writeFixtures();
+    writeConfig();
+    const string config = _workspace + "/bench.conf";
+    const string log = _workspace + "/webserv.log";
+    _pid = fork();
+    if (_pid == -1) {
+        throw runtime_error("fork() failed");
+    }
+    if (_pid == 0) {
+        const int logFd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        dup2(logFd, STDOUT_FILENO);
+        dup2(logFd, STDERR_FILENO);
+        close(logFd);
+        char* argv[] = {
+            const_cast<char*>(_executable.c_str()),
+            const_cast<char*>(config.c_str()),
+            NULL
+        };
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    for (int waited = 0; waited < STARTUP_TIMEOUT_MS * 1000; waited += POLL_STEP_US) {
+        if (!isRunning()) {
+            throw runtime_error("webserv exited on startup, see " + log);
+        }
+        if (acceptsConnections()) {
+            return;
+        }
+        usleep(POLL_STEP_US);
+    }
+    throw runtime_error("webserv did not start listening, see " + log);
+}
+
+bool BenchServer::isRunning() {
+    if (_pid <= 0) {
+        return (false);
+    }
+    if (waitpid(_pid, NULL, WNOHANG) == _pid) {
+        _pid = -1;
+        return (false);
+    }
+    return (true);
+}
+
+int BenchServer::getPort() const {
+    return (_port);
+}
+
+void BenchServer::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    kill(_pid, SIGTERM);
+    waitpid(_pid, NULL, 0);
+    _pid = -1;
+}
+}  // namespace bench
@@ -0,0 +1,50 @@
+#ifndef BENCHSERVER_HPP
+#define BENCHSERVER_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+
+namespace bench {
+/* NOTE: a webserv started on a generated config in a scratch directory under /tmp:
+* static files of several sizes under /, an upload target under /upload,
+* a shell CGI under /cgi. the process and the directory go away with the object.
+*/
+class BenchServer {
+public:
+    static const size_t SMALL_FILE_BYTES = 1024;
+    static const size_t MEDIUM_FILE_BYTES = 65536;
+    static const size_t LARGE_FILE_BYTES = 1048576;
+
+    BenchServer(const std::string& executable, const std::string& eventBackend);
+    ~BenchServer();
+
+    void start();
+    bool isRunning();
+    int getPort() const;
+
+private:
+    static const int STARTUP_TIMEOUT_MS = 5000;
+    static const int MAX_OPEN_DIRECTORIES = 16;
+
+    std::string _executable;
+    std::string _eventBackend;
+    std::string _workspace;
+    int _port;
+    pid_t _pid;
+
+    void writeFixtures() const;
+    void writeConfig() const;
+    void writeFile(const std::string& path, const std::string& content) const;
+    void makeDirectory(const std::string& path) const;
+    bool acceptsConnections() const;
+    void stop();
+
+    BenchServer();
+    BenchServer(const BenchServer& other);
+    BenchServer& operator=(const BenchServer& other);
+};
+}  // namespace bench
+
+#endif
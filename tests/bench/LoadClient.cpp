@@ -0,0 +1,292 @@
+#include "LoadClient.hpp"
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace {
+string lowercase(const string& str) {
+    string res(str);
+    for (size_t i = 0; i < res.size(); ++i) {
+        res[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(res[i])));
+    }
+    return (res);
+}
+
+string trim(const string& str) {
+    const size_t start = str.find_first_not_of(" \t");
+    if (start == string::npos) {
+        return ("");
+    }
+    return (str.substr(start, str.find_last_not_of(" \t") - start + 1));
+}
+
+// NOTE: end of the chunked body starting at pos, 0 while incomplete
+size_t chunkedBodyEnd(const string& buffer, size_t pos) {
+    for (;;) {
+        const size_t lineEnd = buffer.find("\r\n", pos);
+        if (lineEnd == string::npos) {
+            return (0);
+        }
+        const size_t chunkSize = std::strtoul(buffer.c_str() + pos, NULL, 16);
+        pos = lineEnd + 2;
+        if (chunkSize == 0) {
+            if (buffer.compare(pos, 2, "\r\n") == 0) {
+                return (pos + 2);
+            }
+            const size_t trailersEnd = buffer.find("\r\n\r\n", pos);
+            return (trailersEnd == string::npos ? 0 : trailersEnd + 4);
+        }
+        if (buffer.size() < pos + chunkSize + 2) {
+            return (0);
+        }
+        pos += chunkSize + 2;
+    }
+}
+}  // namespace
+
+namespace bench {
+long nowUs() {
+    const long US_PER_S = 1000000;
+    const long NS_PER_US = 1000;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * US_PER_S + now.tv_nsec / NS_PER_US);
+}
+
+size_t responseLength(const string& buffer, bool peerClosed, int& status, bool& closes) {
+    const size_t headEnd = buffer.find("\r\n\r\n");
+    if (headEnd == string::npos) {
+        return (0);
+    }
+    const size_t bodyStart = headEnd + 4;
+    const size_t statusPos = buffer.find(' ');
+    status = (statusPos < headEnd ? std::atoi(buffer.c_str() + statusPos + 1) : 0);
+    closes = false;
+    bool chunked = false;
+    bool hasLength = false;
+    size_t contentLength = 0;
+    size_t lineStart = buffer.find("\r\n") + 2;
+    while (lineStart < headEnd) {
+        const size_t lineEnd = buffer.find("\r\n", lineStart);
+        const size_t colon = buffer.find(':', lineStart);
+        if (colon < lineEnd) {
+            const string name = lowercase(buffer.substr(lineStart, colon - lineStart));
+            const string value = lowercase(trim(buffer.substr(colon + 1, lineEnd - colon - 1)));
+            if (name == "content-length") {
+                hasLength = true;
+                contentLength = std::strtoul(value.c_str(), NULL, 10);
+            } else if (name == "transfer-encoding") {
+                chunked = (value.find("chunked") != string::npos);
+            } else if (name == "connection") {
+                closes = (value == "close");
+            }
+        }
+        lineStart = lineEnd + 2;
+    }
+    if (status / 100 == 1 || status == 204 || status == 304) {
+        return (bodyStart);
+    }
+    if (chunked) {
+        return (chunkedBodyEnd(buffer, bodyStart));
+    }
+    if (hasLength) {
+        return (buffer.size() >= bodyStart + contentLength ? bodyStart + contentLength : 0);
+    }
+    closes = true;  // NOTE: no framing, the body runs until the server closes
+    return (peerClosed ? buffer.size() : 0);
+}
+
+LoadClient::LoadClient(
+    int port,
+    const string& request,
+    size_t concurrency,
+    size_t totalRequests
+)
+    : _port(port)
+    , _request(request)
+    , _concurrency(concurrency)
+    , _totalRequests(totalRequests)
+    , _issued(0) {
+    _result.completed = 0;
+    _result.errors = 0;
+    _result.seconds = 0;
+}
+
+LoadClient::~LoadClient() {
+    for (size_t i = 0; i < _slots.size(); ++i) {
+        closeSlot(_slots[i]);
+    }
+}
+
+bool LoadClient::connectSlot(Slot& slot) {
+    slot.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (slot.fd == -1) {
+        return (false);
+    }
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(slot.fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+        closeSlot(slot);
+        return (false);
+    }
+    int opt = 1;
+    setsockopt(slot.fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    fcntl(slot.fd, F_SETFL, fcntl(slot.fd, F_GETFL, 0) | O_NONBLOCK);
+    return (true);
+}
+
+void LoadClient::closeSlot(Slot& slot) {
+    if (slot.fd != -1) {
+        close(slot.fd);
+        slot.fd = -1;
+    }
+    slot.received.clear();
+}
+
+// NOTE: the next request on this slot, if any are left; a slot that cannot connect burns one
+void LoadClient::startRequest(Slot& slot) {
+    slot.busy = false;
+    while (_issued < _totalRequests) {
+        _issued++;
+        if (slot.fd != -1 || connectSlot(slot)) {
+            slot.sent = 0;
+            slot.busy = true;
+            slot.startUs = nowUs();
+            sendPending(slot);
+            return;
+        }
+        _result.errors++;
+    }
+}
+
+// NOTE: as much as the socket takes now; a broken one shows up as a hangup in poll()
+void LoadClient::sendPending(Slot& slot) {
+    while (slot.sent < _request.size()) {
+        const ssize_t sent =
+            send(slot.fd, _request.data() + slot.sent, _request.size() - slot.sent, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return;
+        }
+        slot.sent += static_cast<size_t>(sent);
+    }
+}
+
+// NOTE: false when the connection broke before the response was complete
+bool LoadClient::receive(Slot& slot, bool hangup) {
+    char buffer[READ_CHUNK];
+    bool peerClosed = false;
+    for (;;) {
+        const ssize_t got = recv(slot.fd, buffer, sizeof(buffer), 0);
+        if (got > 0) {
+            slot.received.append(buffer, static_cast<size_t>(got));
+            continue;
+        }
+        peerClosed = (got == 0);
+        break;
+    }
+    int status = 0;
+    bool closes = false;
+    const size_t length = responseLength(slot.received, peerClosed, status, closes);
+    if (length == 0) {
+        return (!peerClosed && !hangup);
+    }
+    slot.received.erase(0, length);
+    finishRequest(slot, status);
+    if (closes || peerClosed) {
+        closeSlot(slot);
+    }
+    startRequest(slot);
+    return (true);
+}
+
+void LoadClient::finishRequest(Slot& slot, int status) {
+    _result.latenciesUs.push_back(nowUs() - slot.startUs);
+    _result.statuses[status]++;
+    _result.completed++;
+    slot.busy = false;
+}
+
+void LoadClient::failRequest(Slot& slot) {
+    _result.errors++;
+    closeSlot(slot);
+    startRequest(slot);
+}
+
+LoadClient::Result LoadClient::run() {
+    Slot idle;
+    idle.fd = -1;
+    idle.sent = 0;
+    idle.startUs = 0;
+    idle.busy = false;
+    _slots.assign(_concurrency, idle);
+    _result.latenciesUs.reserve(_totalRequests);
+
+    const long startUs = nowUs();
+    for (size_t i = 0; i < _slots.size(); ++i) {
+        startRequest(_slots[i]);
+    }
+    long lastProgressUs = startUs;
+    vector<struct pollfd> fds;
+    vector<size_t> owners;
+    for (;;) {
+        fds.clear();
+        owners.clear();
+        for (size_t i = 0; i < _slots.size(); ++i) {
+            if (!_slots[i].busy) {
+                continue;
+            }
+            struct pollfd pfd;
+            pfd.fd = _slots[i].fd;
+            pfd.events = (_slots[i].sent < _request.size() ? POLLOUT : POLLIN);
+            pfd.revents = 0;
+            fds.push_back(pfd);
+            owners.push_back(i);
+        }
+        if (fds.empty()) {
+            break;
+        }
+        const int ready = poll(&fds[0], fds.size(), STALL_TIMEOUT_MS);
+        if (ready == 0) {
+            // NOTE: the server stopped answering, whatever is in flight is lost
+            for (size_t i = 0; i < owners.size(); ++i) {
+                _result.errors++;
+                closeSlot(_slots[owners[i]]);
+                _slots[owners[i]].busy = false;
+            }
+            break;
+        }
+        for (size_t i = 0; i < fds.size(); ++i) {
+            Slot& slot = _slots[owners[i]];
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            lastProgressUs = nowUs();
+            const bool hangup = (fds[i].revents & (POLLERR | POLLHUP)) != 0;
+            if (slot.sent < _request.size() && !hangup) {
+                sendPending(slot);
+            } else if (slot.sent < _request.size() || !receive(slot, hangup)) {
+                failRequest(slot);
+            }
+        }
+    }
+    _result.seconds = static_cast<double>(lastProgressUs - startUs) / 1e6;
+    std::sort(_result.latenciesUs.begin(), _result.latenciesUs.end());
+    return (_result);
+}
+}  // namespace bench
@@ -0,0 +1,70 @@
+#ifndef LOADCLIENT_HPP
+#define LOADCLIENT_HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bench {
+/* NOTE: a fixed number of keep-alive connections, each sending the same request
+* again as soon as the previous response is complete, all driven by one poll() loop.
+* latency is from the first byte sent to the last byte of the response received.
+* a connection the server closes is reopened, the request in flight counts as an error.
+*/
+class LoadClient {
+public:
+    struct Result {
+        size_t completed;
+        size_t errors;
+        double seconds;
+        std::vector<long> latenciesUs;  // NOTE: sorted
+        std::map<int, size_t> statuses;
+    };
+
+    LoadClient(int port, const std::string& request, size_t concurrency, size_t totalRequests);
+    ~LoadClient();
+
+    Result run();
+
+private:
+    static const int STALL_TIMEOUT_MS = 10000;
+    static const size_t READ_CHUNK = 65536;
+
+    struct Slot {
+        int fd;
+        std::string received;
+        size_t sent;
+        long startUs;
+        bool busy;
+    };
+
+    int _port;
+    std::string _request;
+    size_t _concurrency;
+    size_t _totalRequests;
+    size_t _issued;
+    std::vector<Slot> _slots;
+    Result _result;
+
+    bool connectSlot(Slot& slot);
+    void closeSlot(Slot& slot);
+    void startRequest(Slot& slot);
+    void sendPending(Slot& slot);
+    bool receive(Slot& slot, bool hangup);
+    void finishRequest(Slot& slot, int status);
+    void failRequest(Slot& slot);
+
+    LoadClient();
+    LoadClient(const LoadClient& other);
+    LoadClient& operator=(const LoadClient& other);
+};
+
+long nowUs();
+/* NOTE: bytes taken by the first full response in the buffer, 0 while incomplete.
+* status and whether the server closes after it are filled in once it is complete
+*/
+size_t responseLength(const std::string& buffer, bool peerClosed, int& status, bool& closes);
+}  // namespace bench
+
+#endif
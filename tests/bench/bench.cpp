@@ -0,0 +1,205 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BenchServer.hpp"
+#include "LoadClient.hpp"
+
+using bench::BenchServer;
+using bench::LoadClient;
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+namespace {
+struct Scenario {
+    string name;
+    string request;
+    size_t concurrency;
+    size_t requests;
+};
+
+struct Options {
+    string executable;
+    string eventBackend;
+    string commit;
+    string output;
+    double scale;
+};
+
+const size_t CHUNK_BYTES = 4096;
+const size_t UPLOAD_BYTES = 65536;
+
+string get(const string& target) {
+    return ("GET " + target + " HTTP/1.1\r\nHost: bench\r\n\r\n");
+}
+
+string upload(const string& target) {
+    ostringstream req;
+    req << "POST " << target << " HTTP/1.1\r\nHost: bench\r\nContent-Length: " << UPLOAD_BYTES
+        << "\r\n\r\n"
+        << string(UPLOAD_BYTES, 'u');
+    return (req.str());
+}
+
+string chunkedUpload(const string& target) {
+    ostringstream req;
+    req << "POST " << target << " HTTP/1.1\r\nHost: bench\r\nTransfer-Encoding: chunked\r\n\r\n";
+    for (size_t sent = 0; sent < UPLOAD_BYTES; sent += CHUNK_BYTES) {
+        req << std::hex << CHUNK_BYTES << "\r\n" << string(CHUNK_BYTES, 'c') << "\r\n";
+    }
+    req << "0\r\n\r\n";
+    return (req.str());
+}
+
+Scenario scenario(const string& name, const string& request, size_t concurrency, size_t requests) {
+    Scenario res;
+    res.name = name;
+    res.request = request;
+    res.concurrency = concurrency;
+    res.requests = requests;
+    return (res);
+}
+
+// NOTE: about a second each at scale 1 against an -O0 build, --scale for steadier numbers
+vector<Scenario> scenarios(double scale) {
+    vector<Scenario> res;
+    res.push_back(scenario("static_1k", get("/1k.bin"), 64, 20000));
+    res.push_back(scenario("static_64k", get("/64k.bin"), 64, 5000));
+    res.push_back(scenario("static_1m", get("/1m.bin"), 16, 500));
+    res.push_back(scenario("not_found", get("/missing.bin"), 64, 20000));
+    res.push_back(scenario("upload_64k", upload("/upload/bench.bin"), 16, 2000));
+    res.push_back(scenario("chunked_upload_64k", chunkedUpload("/upload/chunked.bin"), 16, 2000));
+    res.push_back(scenario("cgi", get("/cgi/hello.sh"), 8, 400));
+    for (size_t i = 0; i < res.size(); ++i) {
+        const size_t scaled = static_cast<size_t>(static_cast<double>(res[i].requests) * scale);
+        res[i].requests = (scaled < res[i].concurrency ? res[i].concurrency : scaled);
+    }
+    return (res);
+}
+
+// NOTE: nearest rank, latencies come sorted
+long percentile(const vector<long>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return (0);
+    }
+    size_t rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size()) + 0.999999);
+    rank = (rank == 0 ? 1 : rank);
+    return (sorted[(rank > sorted.size() ? sorted.size() : rank) - 1]);
+}
+
+string toJson(const Scenario& scn, const LoadClient::Result& res, bool serverAlive) {
+    const double P50 = 0.5;
+    const double P99 = 0.99;
+    const double P999 = 0.999;
+    ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "    {\"name\": \"" << scn.name << "\", \"concurrency\": " << scn.concurrency
+         << ", \"requests\": " << scn.requests << ", \"completed\": " << res.completed
+         << ", \"errors\": " << res.errors << ", \"seconds\": " << res.seconds << ", \"rps\": "
+         << (res.seconds > 0 ? static_cast<double>(res.completed) / res.seconds : 0.0)
+         << ", \"latency_us\": {\"p50\": " << percentile(res.latenciesUs, P50)
+         << ", \"p99\": " << percentile(res.latenciesUs, P99)
+         << ", \"p999\": " << percentile(res.latenciesUs, P999)
+         << ", \"max\": " << (res.latenciesUs.empty() ? 0 : res.latenciesUs.back())
+         << "}, \"statuses\": {";
+    for (std::map<int, size_t>::const_iterator it = res.statuses.begin();
+         it != res.statuses.end();
+         ++it) {
+        json << (it == res.statuses.begin() ? "" : ", ") << "\"" << it->first
+             << "\": " << it->second;
+    }
+    json << "}, \"server_alive\": " << (serverAlive ? "true" : "false") << "}";
+    return (json.str());
+}
+
+bool parseOptions(int argc, char* argv[], Options& opts) {
+    if (argc < 2 || argc % 2 != 0) {
+        return (false);
+    }
+    opts.executable = argv[1];
+    opts.eventBackend = "poll";
+    opts.output = "bench.json";
+    opts.scale = 1.0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const string flag = argv[i];
+        if (flag == "--scale") {
+            opts.scale = std::strtod(argv[i + 1], NULL);
+        } else if (flag == "--backend") {
+            opts.eventBackend = argv[i + 1];
+        } else if (flag == "--commit") {
+            opts.commit = argv[i + 1];
+        } else if (flag == "--output") {
+            opts.output = argv[i + 1];
+        } else {
+            return (false);
+        }
+    }
+    return (opts.scale > 0);
+}
+}  // namespace
+
+/* NOTE: starts the given webserv, runs every scenario against it one after another
+* and writes one JSON document to the output file; progress goes to stderr.
+* exits with 1 when a scenario had errors or the server died, so a script can stop there.
+*/
+int main(int argc, char* argv[]) {
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        std::fprintf(
+            stderr,
+            "Usage: %s <webserv> [--scale N] [--backend poll|epoll] [--commit ID]"
+            " [--output FILE]\n",
+            argv[0]
+        );
+        return (2);
+    }
+    try {
+        BenchServer server(opts.executable, opts.eventBackend);
+        server.start();
+        const vector<Scenario> all = scenarios(opts.scale);
+        bool clean = true;
+        std::ofstream json(opts.output.c_str());
+        json << "{\n  \"commit\": \"" << opts.commit << "\",\n  \"backend\": \""
+             << opts.eventBackend << "\",\n  \"scale\": " << opts.scale
+             << ",\n  \"scenarios\": [\n";
+        for (size_t i = 0; i < all.size(); ++i) {
+            std::fprintf(
+                stderr,
+                "bench: %s (%lu requests, %lu connections)\n",
+                all[i].name.c_str(),
+                static_cast<unsigned long>(all[i].requests),
+                static_cast<unsigned long>(all[i].concurrency)
+            );
+            LoadClient client(
+                server.getPort(),
+                all[i].request,
+                all[i].concurrency,
+                all[i].requests
+            );
+            const LoadClient::Result res = client.run();
+            const bool alive = server.isRunning();
+            json << (i == 0 ? "" : ",\n") << toJson(all[i], res, alive);
+            clean = clean && alive && res.errors == 0;
+            if (!alive) {
+                break;
+            }
+        }
+        json << "\n  ]\n}\n";
+        if (!json) {
+            throw std::runtime_error("cannot write " + opts.output);
+        }
+        return (clean ? 0 : 1);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "bench: %s\n", e.what());
+        return (1);
+    }
+}
@@ -6,13 +6,17 @@
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "WebServer.hpp"
+#include "configuration/Endpoint.hpp"
 #include "configuration/RouteConfig.hpp"
 #include "configuration/parser/ConfigParser.hpp"
+#include "event_backend/EventBackend.hpp"
 #include "http_status/HttpStatus.hpp"
+#include "listener/VirtualHosts.hpp"
 #include "logger/LoggerConfig.hpp"
 #include "utils/utils.hpp"
 
@@ -120,6 +124,7 @@ public:
 
         webserver::AppConfig expected;
         webserver::Endpoint ep("127.1.0.1", 8080);
+        ep.setDefaultServer(true);
 
         string serverName = "localhost";
         ep.addServerName(serverName);
@@ -149,6 +154,7 @@ public:
 
         webserver::AppConfig expected;
         webserver::Endpoint ep("0.0.0.0", 8081);
+        ep.setDefaultServer(true);
 
         string serverName = "nested.local";
         ep.addServerName(serverName);
@@ -211,6 +217,7 @@ public:
 
         // First server
         webserver::Endpoint ep1("0.0.0.0", 8080);
+        ep1.setDefaultServer(true);
         webserver::RouteConfig route1;
         string serverName1 = "example.com";
         ep1.addServerName(serverName1);
@@ -227,6 +234,7 @@ public:
 
         // Second server
         webserver::Endpoint ep2("0.0.0.0", 9090);
+        ep2.setDefaultServer(true);
         webserver::RouteConfig route2;
         string serverName2 = "api.localhost";
         ep2.addServerName(serverName2);
@@ -253,6 +261,7 @@ public:
 
         webserver::AppConfig expected;
         webserver::Endpoint ep("0.0.0.0", 8000);
+        ep.setDefaultServer(true);
 
         string serverName = "cgi.local";
         ep.addServerName(serverName);
@@ -282,11 +291,53 @@ public:
         TS_ASSERT_EQUALS(expected, actual);
     }
 
+    void testConfig3_FastCgiHandler() {
+        const string fname = "tests/config_files/fastcgi_example.conf";
+
+        webserver::ConfigParser parser;
+        webserver::AppConfig actual = parser.parse(fname);
+
+        webserver::AppConfig expected;
+        webserver::Endpoint ep("0.0.0.0", 8000);
+        ep.setDefaultServer(true);
+
+        string serverName = "cgi.local";
+        ep.addServerName(serverName);
+        webserver::RouteConfig route;
+        route.setPath("/");
+        route.setFolderConfig(webserver::FolderConfig(
+            "/",
+            "tests/e2e/9_cgi/requirements/webserv/volume/www/cgi",
+            false,
+            "index.py",
+            webserver::FolderConfig::defaultMaxClientBodySizeBytes()
+        ));
+
+        route.addAllowedMethod(webserver::GET);
+        route.addAllowedMethod(webserver::POST);
+
+        ep.addRoute(route);
+
+        webserver::CgiHandlerConfig pooled(30, "/usr/bin/python3");
+        pooled.setWorkerPool(2, 8);
+        ep.addCgiHandler(pooled, ".py");
+        webserver::CgiHandlerConfig fastCgi(30, "");
+        fastCgi.setFastCgiSocketPath("/run/php/php-fpm.sock");
+        ep.addCgiHandler(fastCgi, ".php");
+
+        expected.addEndpoint(ep);
+
+        TS_ASSERT_EQUALS(expected, actual);
+        const webserver::Endpoint* parsed = *actual.getEndpoints().begin();
+        TS_ASSERT(parsed->getCgiHandlers().find(".php")->second->isFastCgi());
+    }
+
     void testConfig4_Advanced() {
         const string fname = "tests/config_files/advanced.conf";
 
         webserver::AppConfig expected;
         webserver::Endpoint ep("0.0.0.0", 8000);
+        ep.setDefaultServer(true);
         string serverName = "secure.example.com";
 
         webserver::HttpStatus status;
@@ -308,6 +359,9 @@ public:
 
         ep.addServerName(serverName);
         ep.setMaxClientBodySizeBytes(1 * utils::MIB);
+        ep.setKeepAliveTimeoutSeconds(5);
+        ep.setKeepAliveMaxRequests(50);
+        ep.setFileCacheSizeBytes(2 * utils::MIB);
 
         // Location /
         webserver::RouteConfig route1;
@@ -319,6 +373,7 @@ public:
             "index.html",
             1 * utils::MIB
         ));
+        route1.setCompression(true);
         ep.addRoute(route1);
 
         // Location /upload
@@ -346,6 +401,9 @@ public:
         ep.addRoute(route3);
 
         expected.addEndpoint(ep);
+        expected.setEventBackend(webserver::EventBackend::EPOLL);
+        expected.setWorkerProcesses(2);
+        expected.setAcceptBatch(32);
 
         webserver::ConfigParser parser;
         webserver::AppConfig actual = parser.parse(fname);
@@ -354,6 +412,80 @@ public:
         TS_ASSERT_EQUALS(expected, actual);
     }
 
+    void testSelectRouteBySegments() {
+        webserver::Endpoint ep("0.0.0.0", 8000);
+        const char* paths[] = {"/", "/img", "/img/icons", "/api/v1", "/images/"};
+        for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i) {
+            webserver::RouteConfig route;
+            route.setPath(paths[i]);
+            ep.addRoute(route);
+        }
+        TS_ASSERT_EQUALS(ep.selectRoute("/img").getPath(), "/img");
+        TS_ASSERT_EQUALS(ep.selectRoute("/img/a.png").getPath(), "/img");
+        TS_ASSERT_EQUALS(ep.selectRoute("/img/icons/a.png").getPath(), "/img/icons");
+        TS_ASSERT_EQUALS(ep.selectRoute("/img/iconsets").getPath(), "/img");
+        TS_ASSERT_EQUALS(ep.selectRoute("/images").getPath(), "/");  // NOTE: not a segment of /img
+        TS_ASSERT_EQUALS(ep.selectRoute("/images/").getPath(), "/images/");
+        TS_ASSERT_EQUALS(ep.selectRoute("/api/v1/users").getPath(), "/api/v1");
+        TS_ASSERT_EQUALS(ep.selectRoute("/api/v2").getPath(), "/");
+        TS_ASSERT_EQUALS(ep.selectRoute("/").getPath(), "/");
+
+        // NOTE: a copy matches against its own routes
+        const webserver::Endpoint copy(ep);
+        TS_ASSERT_EQUALS(&copy.selectRoute("/img/x"), &copy.getRoute("/img"));
+
+        webserver::Endpoint rootless("0.0.0.0", 8001);
+        webserver::RouteConfig route;
+        route.setPath("/img");
+        rootless.addRoute(route);
+        TS_ASSERT_THROWS(rootless.selectRoute("/other"), const std::out_of_range&);
+    }
+
+    void testVirtualHostsShareAddress() {
+        webserver::ConfigParser parser;
+        const webserver::AppConfig config = parser.parse("tests/config_files/virtual_hosts.conf");
+        const set<webserver::Endpoint*>& endpoints = config.getEndpoints();
+        TS_ASSERT_EQUALS(endpoints.size(), 4u);
+
+        vector<const webserver::Endpoint*> shared;
+        const webserver::Endpoint* exact = NULL;
+        const webserver::Endpoint* leading = NULL;
+        const webserver::Endpoint* trailing = NULL;
+        for (set<webserver::Endpoint*>::const_iterator it = endpoints.begin();
+             it != endpoints.end();
+             ++it) {
+            if ((*it)->getPort() != 8080) {
+                TS_ASSERT((*it)->isDefaultServer());  // NOTE: alone on its address
+                continue;
+            }
+            shared.push_back(*it);
+            const string& name = (*it)->getServerName();
+            if (name == "example.com") {
+                exact = *it;
+                TS_ASSERT_EQUALS((*it)->getServerNames().size(), 2u);
+            } else if (name == "*.example.com") {
+                leading = *it;
+            } else {
+                trailing = *it;
+            }
+            // NOTE: the explicit default_server takes over from the first server declared
+            TS_ASSERT_EQUALS((*it)->isDefaultServer(), *it == leading);
+        }
+        TS_ASSERT_EQUALS(shared.size(), 3u);
+
+        const webserver::VirtualHosts hosts(shared);
+        TS_ASSERT_EQUALS(hosts.getDefault().configuration, leading);
+        TS_ASSERT_EQUALS(hosts.select("example.com").configuration, exact);
+        TS_ASSERT_EQUALS(hosts.select("WWW.Example.com:8080").configuration, exact);
+        TS_ASSERT_EQUALS(hosts.select("example.com.").configuration, exact);
+        TS_ASSERT_EQUALS(hosts.select("api.example.com").configuration, leading);
+        TS_ASSERT_EQUALS(hosts.select("mail.example.com").configuration, leading);
+        TS_ASSERT_EQUALS(hosts.select("mail.example.org").configuration, trailing);
+        TS_ASSERT_EQUALS(hosts.select("other.org").configuration, leading);
+        TS_ASSERT_EQUALS(hosts.select("").configuration, leading);
+        TS_ASSERT_DIFFERS(hosts.select("mail.org").fileCache, hosts.select("x.org").fileCache);
+    }
+
     void tearDown() {
         for (set<string>::iterator it = _filenames.begin(); it != _filenames.end(); it++) {
             if (remove(it->c_str()) != 0) {
@@ -0,0 +1,287 @@
+#ifndef FASTCGITESTS_HPP
+#define FASTCGITESTS_HPP
+
+#include <cxxtest/TestSuite.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cgi_handler/CgiWorker.hpp"
+#include "cgi_handler/FastCgiPool.hpp"
+#include "cgi_handler/FastCgiRecord.hpp"
+#include "event_backend/EventBackend.hpp"
+#include "logger/LoggerConfig.hpp"
+
+using std::map;
+using std::ostringstream;
+using std::string;
+using std::vector;
+using webserver::CgiWorker;
+using webserver::EventBackend;
+using webserver::FastCgiPool;
+using webserver::FastCgiRecord;
+
+// NOTE: what CgiWorkerPool does, minus the exec of webserv: a worker forked off the test itself
+class ForkedWorkerPool : public FastCgiPool {
+public:
+    ForkedWorkerPool(EventBackend& events, size_t minWorkers, size_t maxWorkers)
+        : FastCgiPool("/bin/sh", events, minWorkers, maxWorkers) {
+    }
+
+private:
+    virtual int connectBackend() {
+        int channel[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, channel);
+        if (fork() == 0) {
+            dup2(channel[1], STDIN_FILENO);
+            close(channel[0]);
+            close(channel[1]);
+            CgiWorker worker("/bin/sh");
+            _exit(worker.run());
+        }
+        close(channel[1]);
+        fcntl(channel[0], F_SETFL, O_NONBLOCK);
+        return (channel[0]);
+    }
+};
+
+class FastCgiTests : public CxxTest::TestSuite {
+private:
+    static string socketPath() {
+        ostringstream path;
+        path << "/tmp/webserv_fastcgi_test_" << getpid() << ".sock";
+        return (path.str());
+    }
+
+    // NOTE: stand-in responder: answers `count` requests on one kept-open connection, then exits
+    static void serveRequests(int listenFd, int count) {
+        const int conn = accept(listenFd, NULL, NULL);
+        string buffer;
+        size_t pos = 0;
+        size_t bodyBytes = 0;
+        int served = 0;
+        while (served < count) {
+            FastCgiRecord record;
+            if (!FastCgiRecord::decode(buffer, pos, record)) {
+                char chunk[4096];
+                const ssize_t bytesRead = read(conn, chunk, sizeof(chunk));
+                if (bytesRead <= 0) {
+                    break;
+                }
+                buffer.append(chunk, bytesRead);
+                continue;
+            }
+            if (record.getType() != FastCgiRecord::STDIN) {
+                continue;
+            }
+            if (!record.getContent().empty()) {
+                bodyBytes += record.getContent().size();
+                continue;
+            }
+            served++;
+            ostringstream out;
+            out << "Content-Type: text/plain\r\n\r\nserved " << served << " body " << bodyBytes;
+            const string reply =
+                FastCgiRecord::encodeStream(FastCgiRecord::STDERR, record.getRequestId(), "log") +
+                FastCgiRecord::encodeStream(FastCgiRecord::STDOUT, record.getRequestId(), out.str()) +
+                FastCgiRecord::encodeEndRequest(record.getRequestId(), 0);
+            if (write(conn, reply.data(), reply.size()) == -1) {
+                break;
+            }
+            bodyBytes = 0;
+        }
+        close(conn);
+    }
+
+    static pid_t startResponder(const string& path, int count) {
+        unlink(path.c_str());
+        const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        path.copy(address.sun_path, path.size());
+        bind(listenFd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+        listen(listenFd, 4);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            serveRequests(listenFd, count);
+            _exit(0);
+        }
+        close(listenFd);
+        return (pid);
+    }
+
+    static FastCgiPool::Output runUntilDone(EventBackend& events, FastCgiPool& pool) {
+        FastCgiPool::Output res;
+        res.state = FastCgiPool::PARTIAL;
+        for (int round = 0; round < 100 && res.state == FastCgiPool::PARTIAL; round++) {
+            vector<EventBackend::Event> ready;
+            events.wait(ready, 100);
+            for (size_t i = 0; i < ready.size(); i++) {
+                vector<FastCgiPool::Output> outputs;
+                pool.handleEvent(ready[i].fd, ready[i].events, outputs);
+                for (size_t j = 0; j < outputs.size(); j++) {
+                    res.clientFd = outputs[j].clientFd;
+                    res.data += outputs[j].data;
+                    res.state = outputs[j].state;
+                }
+            }
+        }
+        return (res);
+    }
+
+public:
+    void setUp() {
+        webserver::LoggerConfig::setGlobalLevel(LOG_SILENT);
+    }
+
+    void testStreamRoundTrip() {
+        const string data(70000, 'x');
+        const string encoded = FastCgiRecord::encodeStream(FastCgiRecord::STDIN, 258, data);
+        size_t pos = 0;
+        FastCgiRecord record;
+        string decoded;
+        int records = 0;
+        while (FastCgiRecord::decode(encoded, pos, record)) {
+            TS_ASSERT_EQUALS(record.getType(), FastCgiRecord::STDIN);
+            TS_ASSERT_EQUALS(record.getRequestId(), 258);
+            decoded += record.getContent();
+            records++;
+        }
+        TS_ASSERT_EQUALS(pos, encoded.size());
+        TS_ASSERT_EQUALS(encoded.size() % 8, 0u);
+        TS_ASSERT_EQUALS(records, 3);  // NOTE: 64 KiB, the rest, the empty end of stream
+        TS_ASSERT_EQUALS(decoded, data);
+    }
+
+    void testPartialRecordWaits() {
+        const string encoded = FastCgiRecord::encodeStream(FastCgiRecord::STDOUT, 1, "hello");
+        size_t pos = 0;
+        FastCgiRecord record;
+        TS_ASSERT(!FastCgiRecord::decode(encoded.substr(0, 10), pos, record));
+        TS_ASSERT_EQUALS(pos, 0u);
+        TS_ASSERT(FastCgiRecord::decode(encoded, pos, record));
+        TS_ASSERT_EQUALS(record.getContent(), "hello");
+    }
+
+    void testParamLengths() {
+        map<string, string> params;
+        params["SHORT"] = "value";
+        params["LONG"] = string(200, 'v');
+        const string encoded = FastCgiRecord::encodeParams(7, params);
+        size_t pos = 0;
+        FastCgiRecord record;
+        TS_ASSERT(FastCgiRecord::decode(encoded, pos, record));
+        const string& pairs = record.getContent();
+        // NOTE: LONG sorts first: 1-byte name length, 4-byte value length with the high bit set
+        TS_ASSERT_EQUALS(pairs[0], 4);
+        TS_ASSERT_EQUALS(static_cast<unsigned char>(pairs[1]), 0x80);
+        TS_ASSERT_EQUALS(static_cast<unsigned char>(pairs[4]), 200);
+        TS_ASSERT_EQUALS(pairs.substr(5, 4), "LONG");
+        TS_ASSERT_EQUALS(pairs.size(), 1 + 4 + 4 + 200 + 1 + 1 + 5 + 5);
+        map<string, string> decoded;
+        TS_ASSERT(FastCgiRecord::decodeParams(pairs, decoded));
+        TS_ASSERT_EQUALS(decoded, params);
+        TS_ASSERT(!FastCgiRecord::decodeParams(pairs.substr(0, 20), decoded));
+        TS_ASSERT(FastCgiRecord::decode(encoded, pos, record));
+        TS_ASSERT(record.getContent().empty());
+    }
+
+    void testEndRequestStatus() {
+        const string encoded = FastCgiRecord::encodeEndRequest(3, 258);
+        size_t pos = 0;
+        FastCgiRecord record;
+        TS_ASSERT(FastCgiRecord::decode(encoded, pos, record));
+        TS_ASSERT_EQUALS(record.getType(), FastCgiRecord::END_REQUEST);
+        TS_ASSERT_EQUALS(record.getAppStatus(), 258);
+    }
+
+    void testPoolReusesConnection() {
+        const string path = socketPath();
+        const pid_t responder = startResponder(path, 2);
+        EventBackend* events = EventBackend::create(EventBackend::POLL);
+        {
+            FastCgiPool pool(path, *events);
+            const map<string, string> params;
+            TS_ASSERT(pool.startRequest(42, params, "abc"));
+            FastCgiPool::Output first = runUntilDone(*events, pool);
+            TS_ASSERT_EQUALS(first.state, FastCgiPool::COMPLETE);
+            TS_ASSERT_EQUALS(first.clientFd, 42);
+            TS_ASSERT_EQUALS(first.data, "Content-Type: text/plain\r\n\r\nserved 1 body 3");
+
+            // NOTE: the responder accepts once, a second answer proves the connection was kept
+            TS_ASSERT(pool.startRequest(43, params, ""));
+            FastCgiPool::Output second = runUntilDone(*events, pool);
+            TS_ASSERT_EQUALS(second.state, FastCgiPool::COMPLETE);
+            TS_ASSERT_EQUALS(second.clientFd, 43);
+            TS_ASSERT_EQUALS(second.data, "Content-Type: text/plain\r\n\r\nserved 2 body 0");
+        }
+        delete events;
+        waitpid(responder, NULL, 0);
+        unlink(path.c_str());
+    }
+
+    void testWorkerPoolReusesWorker() {
+        ostringstream scriptPath;
+        scriptPath << "/tmp/webserv_cgi_worker_test_" << getpid() << ".sh";
+        {
+            std::ofstream script(scriptPath.str().c_str());
+            script << "printf 'Content-Type: text/plain\\r\\n\\r\\n'\n"
+                   << "printf '%s %s ' \"$REQUEST_METHOD\" \"$PPID\"\n"
+                   << "cat\n";
+        }
+        map<string, string> params;
+        params["SCRIPT_FILENAME"] = scriptPath.str();
+        params["REQUEST_METHOD"] = "POST";
+        EventBackend* events = EventBackend::create(EventBackend::POLL);
+        {
+            ForkedWorkerPool pool(*events, 1, 1);
+            pool.maintain(time(NULL));  // NOTE: the minimum starts before any request
+            TS_ASSERT(pool.startRequest(42, params, string(100000, 'b')));
+            FastCgiPool::Output first = runUntilDone(*events, pool);
+            TS_ASSERT_EQUALS(first.state, FastCgiPool::COMPLETE);
+            const string head = "Content-Type: text/plain\r\n\r\nPOST ";
+            TS_ASSERT_EQUALS(first.data.substr(0, head.size()), head);
+            const size_t workerEnd = first.data.find(' ', head.size());
+            TS_ASSERT_EQUALS(first.data.size() - workerEnd - 1, 100000u);
+            const string worker = first.data.substr(head.size(), workerEnd - head.size());
+
+            // NOTE: the same worker forks the second script: same parent pid
+            TS_ASSERT(pool.startRequest(43, params, "again"));
+            FastCgiPool::Output second = runUntilDone(*events, pool);
+            TS_ASSERT_EQUALS(second.state, FastCgiPool::COMPLETE);
+            TS_ASSERT_EQUALS(second.clientFd, 43);
+            TS_ASSERT_EQUALS(second.data, head + worker + " again");
+        }
+        delete events;
+        while (waitpid(-1, NULL, 0) > 0) {
+        }
+        unlink(scriptPath.str().c_str());
+    }
+
+    void testPoolUnreachableResponder() {
+        const string path = socketPath();
+        unlink(path.c_str());
+        EventBackend* events = EventBackend::create(EventBackend::POLL);
+        {
+            FastCgiPool pool(path, *events);
+            TS_ASSERT(!pool.startRequest(42, map<string, string>(), ""));
+        }
+        delete events;
+    }
+};
+
+#endif
@@ -2,10 +2,15 @@
 #define GETREQUESTHANDLERTESTS_HPP
 
 #include <cxxtest/TestSuite.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
 
 #include <cstdio>
+#include <cstdlib>
+#include <ctime>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -18,7 +23,13 @@
 #include "http_methods/HttpMethodType.hpp"
 #include "http_status/HttpStatus.hpp"
 #include "logger/LoggerConfig.hpp"
+#include "file_system/FileSystem.hpp"
+#include "file_system/StaticFileCache.hpp"
+#include "request/Request.hpp"
 #include "request_handler/GetHandler.hpp"
+#include "response/FileBody.hpp"
+#include "response/StreamBody.hpp"
+#include "utils/utils.hpp"
 
 using std::map;
 using std::ofstream;
@@ -58,6 +69,124 @@ private:
         }
     }
 
+    static webserver::Request get(const string& path) {
+        webserver::Request request;
+        request.setPath(path);
+        return (request);
+    }
+
+    static webserver::Request getRange(const string& path, const string& range) {
+        webserver::Request request = get(path);
+        request.addHeader("Range", range);
+        return (request);
+    }
+
+    static webserver::RouteConfig rootConfig() {
+        return (webserver::RouteConfig().setPath("/").setFolderConfig(webserver::FolderConfig(
+            "/",
+            _rootFolder,
+            false,
+            "",
+            webserver::FolderConfig::defaultMaxClientBodySizeBytes()
+        )));
+    }
+
+    static webserver::Response fetchRange(const string& path, const string& range) {
+        return (
+            webserver::GetHandler::handleRequest(getRange(path, range), path, rootConfig(), NULL)
+        );
+    }
+
+    static webserver::Response fetchIf(
+        const string& path,
+        const string& header,
+        const string& value,
+        webserver::StaticFileCache* cache
+    ) {
+        webserver::Request request = get(path);
+        request.addHeader(header, value);
+        return (webserver::GetHandler::handleRequest(request, path, rootConfig(), cache));
+    }
+
+    static webserver::Response fetchEncoded(
+        const string& path,
+        const string& acceptEncoding,
+        const webserver::RouteConfig& config,
+        webserver::StaticFileCache* cache
+    ) {
+        webserver::Request request = get(path);
+        request.addHeader("Accept-Encoding", acceptEncoding);
+        return (webserver::GetHandler::handleRequest(request, path, config, cache));
+    }
+
+    // NOTE: through the gzip tool, so the encoder is checked against someone else's decoder
+    static string gunzip(const string& body) {
+        const string packed = _rootFolder + "/body.gz";
+        const string unpacked = _rootFolder + "/body";
+        ofstream f(packed.c_str(), std::ios::binary);
+        f << body;
+        f.close();
+        const string cmd = "gzip -dc '" + packed + "' > '" + unpacked + "'";
+        if (system(cmd.c_str()) != 0) {
+            return ("");
+        }
+        return (file_system::readFile(unpacked.c_str()));
+    }
+
+    // NOTE: what the body puts on the wire, file parts included
+    static string drain(webserver::FileBody body) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == -1) {
+            return ("");
+        }
+        string res;
+        char buf[4096];
+        while (body.getLength() > 0 && body.sendTo(pair[0], sizeof(buf)) > 0) {
+            const ssize_t got = read(pair[1], buf, sizeof(buf));
+            res.append(buf, got > 0 ? got : 0);
+        }
+        close(pair[0]);
+        close(pair[1]);
+        return (res);
+    }
+
+    // NOTE: the same for a stream body, producer included
+    static string drain(webserver::StreamBody body) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == -1) {
+            return ("");
+        }
+        string res;
+        char buf[4096];
+        while (!body.isSent() && body.sendTo(pair[0], sizeof(buf)) > 0) {
+            const ssize_t got = read(pair[1], buf, sizeof(buf));
+            res.append(buf, got > 0 ? got : 0);
+        }
+        close(pair[0]);
+        close(pair[1]);
+        return (res);
+    }
+
+    // NOTE: the payload of a chunked body; chunks counts the ones that carried some
+    static string unchunk(const string& chunked, size_t& chunks) {
+        string res;
+        size_t pos = 0;
+        chunks = 0;
+        for (;;) {
+            const size_t lineEnd = chunked.find("\r\n", pos);
+            if (lineEnd == string::npos) {
+                return ("malformed");
+            }
+            const size_t size = std::strtoul(chunked.c_str() + pos, NULL, 16);
+            if (size == 0) {
+                return (chunked.substr(lineEnd) == "\r\n\r\n" ? res : "malformed");
+            }
+            res += chunked.substr(lineEnd + 2, size);
+            pos = lineEnd + 2 + size + 2;
+            chunks++;
+        }
+    }
+
 public:
     void setUp() {
         webserver::LoggerConfig::setGlobalLevel(LOG_SILENT);
@@ -87,41 +216,537 @@ public:
                 .setStatusCatalogue(status);
 
         string tgt = _rootFolder + "/folder/foo.txt";
-        webserver::Response actual = webserver::GetHandler::handleRequest(tgt, tgt, false, config);
+        webserver::Response actual =
+            webserver::GetHandler::handleRequest(get(tgt), tgt, config, NULL);
         TS_ASSERT_EQUALS(200, actual.getStatus());
         TS_ASSERT_EQUALS("7", actual.getHeader("Content-Length"));
         TS_ASSERT_EQUALS("footext", actual.getBody());
         TS_ASSERT_EQUALS("text/plain", actual.getHeader("Content-Type"));
 
         tgt = _rootFolder + "/folder/bar.xml";
-        actual = webserver::GetHandler::handleRequest(tgt, tgt, false, config);
+        actual = webserver::GetHandler::handleRequest(get(tgt), tgt, config, NULL);
         TS_ASSERT_EQUALS(200, actual.getStatus());
         TS_ASSERT_EQUALS("7", actual.getHeader("Content-Length"));
         TS_ASSERT_EQUALS("bartext", actual.getBody());
         TS_ASSERT_EQUALS("application/xml", actual.getHeader("Content-Type"));
 
         tgt = _rootFolder + "/another/key.jpg";
-        actual = webserver::GetHandler::handleRequest(tgt, tgt, false, config);
+        actual = webserver::GetHandler::handleRequest(get(tgt), tgt, config, NULL);
         TS_ASSERT_EQUALS(200, actual.getStatus());
         TS_ASSERT_EQUALS("13", actual.getHeader("Content-Length"));
         TS_ASSERT_EQUALS("communication", actual.getBody());
         TS_ASSERT_EQUALS("image/jpeg", actual.getHeader("Content-Type"));
 
         tgt = _rootFolder + "/another/empty.mp3";
-        actual = webserver::GetHandler::handleRequest(tgt, tgt, false, config);
+        actual = webserver::GetHandler::handleRequest(get(tgt), tgt, config, NULL);
         TS_ASSERT_EQUALS(200, actual.getStatus());
         TS_ASSERT_EQUALS("0", actual.getHeader("Content-Length"));
         TS_ASSERT_EQUALS("", actual.getBody());
         TS_ASSERT_EQUALS("audio/mpeg", actual.getHeader("Content-Type"));
 
         tgt = _rootFolder + "/another/doesnotexist.txt";
-        actual = webserver::GetHandler::handleRequest(tgt, tgt, false, config);
+        actual = webserver::GetHandler::handleRequest(get(tgt), tgt, config, NULL);
         TS_ASSERT_EQUALS(404, actual.getStatus());
         TS_ASSERT_EQUALS("7", actual.getHeader("Content-Length"));
         TS_ASSERT_EQUALS("footext", actual.getBody());
         TS_ASSERT_EQUALS("text/plain", actual.getHeader("Content-Type"));
     }
 
+    void testThatLargeFilesAreServedFromTheDescriptor() {
+        const string big(100000, 'x');
+        _files["/big/video.mp4"] = big;
+        createTestFiles();
+        webserver::RouteConfig config = webserver::RouteConfig().setPath("/").setFolderConfig(
+            webserver::FolderConfig(
+                "/",
+                _rootFolder,
+                false,
+                "index.html",
+                webserver::FolderConfig::defaultMaxClientBodySizeBytes()
+            )
+        );
+
+        string tgt = _rootFolder + "/big/video.mp4";
+        webserver::Response actual =
+            webserver::GetHandler::handleRequest(get(tgt), tgt, config, NULL);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        TS_ASSERT_EQUALS("100000", actual.getHeader("Content-Length"));
+        TS_ASSERT_EQUALS("", actual.getBody());
+        TS_ASSERT(actual.getFileBody().isSet());
+        TS_ASSERT_EQUALS(big.size(), actual.getFileBody().getLength());
+        TS_ASSERT_EQUALS(string::npos, actual.serialize().find("xxx"));
+    }
+
+    void testThatRangesOfSmallFilesAreServedAsPartialContent() {
+        _files["/ranges/digits.txt"] = "0123456789";
+        createTestFiles();
+        const webserver::RouteConfig config = rootConfig();
+        const string tgt = _rootFolder + "/ranges/digits.txt";
+
+        webserver::Response actual =
+            webserver::GetHandler::handleRequest(get(tgt), tgt, config, NULL);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        TS_ASSERT_EQUALS("bytes", actual.getHeader("Accept-Ranges"));
+
+        actual = fetchRange(tgt, "bytes=2-4");
+        TS_ASSERT_EQUALS(206, actual.getStatus());
+        TS_ASSERT_EQUALS("234", actual.getBody());
+        TS_ASSERT_EQUALS("3", actual.getHeader("Content-Length"));
+        TS_ASSERT_EQUALS("bytes 2-4/10", actual.getHeader("Content-Range"));
+        TS_ASSERT_EQUALS("text/plain", actual.getHeader("Content-Type"));
+
+        actual = fetchRange(tgt, "bytes=-3");
+        TS_ASSERT_EQUALS("789", actual.getBody());
+        actual = fetchRange(tgt, "bytes=7-");
+        TS_ASSERT_EQUALS("789", actual.getBody());
+        actual = fetchRange(tgt, "bytes=8-99");
+        TS_ASSERT_EQUALS("89", actual.getBody());
+        TS_ASSERT_EQUALS("bytes 8-9/10", actual.getHeader("Content-Range"));
+
+        actual = fetchRange(tgt, "bytes=0-1, 5-6");
+        TS_ASSERT_EQUALS(206, actual.getStatus());
+        const string type = actual.getHeader("Content-Type");
+        const string boundary = type.substr(type.find("boundary=") + 9);
+        TS_ASSERT_EQUALS(0, type.find("multipart/byteranges; boundary="));
+        TS_ASSERT_EQUALS(
+            "\r\n--" + boundary +
+                "\r\nContent-Type: text/plain\r\nContent-Range: bytes 0-1/10\r\n\r\n01"
+                "\r\n--" + boundary +
+                "\r\nContent-Type: text/plain\r\nContent-Range: bytes 5-6/10\r\n\r\n56"
+                "\r\n--" + boundary + "--\r\n",
+            actual.getBody()
+        );
+
+        actual = fetchRange(tgt, "bytes=10-");
+        TS_ASSERT_EQUALS(416, actual.getStatus());
+        TS_ASSERT_EQUALS("bytes */10", actual.getHeader("Content-Range"));
+
+        // NOTE: malformed, overlapping or in another unit: the whole file
+        actual = fetchRange(tgt, "bytes=4-2");
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        actual = fetchRange(tgt, "bytes=0-5,3-8");
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        actual = fetchRange(tgt, "lines=1-2");
+        TS_ASSERT_EQUALS("0123456789", actual.getBody());
+    }
+
+    void testThatIfRangeServesTheWholeFileWhenItChanged() {
+        _files["/ranges/old.txt"] = "0123456789";
+        createTestFiles();
+        const webserver::RouteConfig config = rootConfig();
+        const string tgt = _rootFolder + "/ranges/old.txt";
+        // NOTE: a date is a strong validator only once the file is older than a second
+        struct utimbuf times;
+        times.actime = 1000000000;
+        times.modtime = 1000000000;
+        utime(tgt.c_str(), &times);
+
+        webserver::Request request = getRange(tgt, "bytes=0-0");
+        request.addHeader("If-Range", "Sun, 09 Sep 2001 01:46:40 GMT");
+        webserver::Response actual =
+            webserver::GetHandler::handleRequest(request, tgt, config, NULL);
+        TS_ASSERT_EQUALS("Sun, 09 Sep 2001 01:46:40 GMT", actual.getHeader("Last-Modified"));
+        TS_ASSERT_EQUALS(206, actual.getStatus());
+        TS_ASSERT_EQUALS("0", actual.getBody());
+
+        request = getRange(tgt, "bytes=0-0");
+        request.addHeader("If-Range", "Sun, 09 Sep 2001 01:46:41 GMT");
+        actual = webserver::GetHandler::handleRequest(request, tgt, config, NULL);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+
+        request = getRange(tgt, "bytes=0-0");
+        request.addHeader("If-Range", "\"some-etag\"");
+        actual = webserver::GetHandler::handleRequest(request, tgt, config, NULL);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+    }
+
+    void testThatRangesOfLargeFilesAreSentFromTheDescriptor() {
+        string big(100000, 'x');
+        big.replace(0, 3, "abc");
+        big.replace(99997, 3, "xyz");
+        _files["/big/movie.mp4"] = big;
+        createTestFiles();
+        const string tgt = _rootFolder + "/big/movie.mp4";
+
+        webserver::Response actual = fetchRange(tgt, "bytes=-3");
+        TS_ASSERT_EQUALS(206, actual.getStatus());
+        TS_ASSERT_EQUALS("3", actual.getHeader("Content-Length"));
+        TS_ASSERT_EQUALS("bytes 99997-99999/100000", actual.getHeader("Content-Range"));
+        TS_ASSERT(actual.getFileBody().isSet());
+        TS_ASSERT_EQUALS("xyz", drain(actual.getFileBody()));
+
+        actual = fetchRange(tgt, "bytes=0-2,99997-99999");
+        const string type = actual.getHeader("Content-Type");
+        const string boundary = type.substr(type.find("boundary=") + 9);
+        const string expected =
+            "\r\n--" + boundary +
+            "\r\nContent-Type: video/mp4\r\nContent-Range: bytes 0-2/100000\r\n\r\nabc"
+            "\r\n--" + boundary +
+            "\r\nContent-Type: video/mp4\r\nContent-Range: bytes 99997-99999/100000\r\n\r\nxyz"
+            "\r\n--" + boundary + "--\r\n";
+        TS_ASSERT_EQUALS(utils::toString(expected.size()), actual.getHeader("Content-Length"));
+        TS_ASSERT_EQUALS(expected, drain(actual.getFileBody()));
+    }
+
+    void testThatUnchangedFilesAreAnsweredWithNotModified() {
+        _files["/conditional/style.css"] = "body {}";
+        createTestFiles();
+        const webserver::RouteConfig config = rootConfig();
+        webserver::StaticFileCache cache(1024);
+        const string tgt = _rootFolder + "/conditional/style.css";
+
+        webserver::Response actual =
+            webserver::GetHandler::handleRequest(get(tgt), tgt, config, &cache);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        const string etag = actual.getHeader("ETag");
+        const string lastModified = actual.getHeader("Last-Modified");
+        TS_ASSERT_EQUALS('"', etag[0]);
+        TS_ASSERT(!lastModified.empty());
+
+        actual = fetchIf(tgt, "If-None-Match", etag, NULL);
+        TS_ASSERT_EQUALS(304, actual.getStatus());
+        TS_ASSERT_EQUALS("", actual.getBody());
+        TS_ASSERT_EQUALS("", actual.getHeader("Content-Length"));
+        TS_ASSERT_EQUALS(etag, actual.getHeader("ETag"));
+        TS_ASSERT_EQUALS(lastModified, actual.getHeader("Last-Modified"));
+        TS_ASSERT_EQUALS(304, fetchIf(tgt, "If-None-Match", etag, &cache).getStatus());
+        TS_ASSERT_EQUALS(304, fetchIf(tgt, "If-None-Match", "\"x\", W/" + etag, NULL).getStatus());
+        TS_ASSERT_EQUALS(304, fetchIf(tgt, "If-None-Match", "*", NULL).getStatus());
+        TS_ASSERT_EQUALS(200, fetchIf(tgt, "If-None-Match", "\"x\"", NULL).getStatus());
+
+        TS_ASSERT_EQUALS(304, fetchIf(tgt, "If-Modified-Since", lastModified, NULL).getStatus());
+        TS_ASSERT_EQUALS(
+            304,
+            fetchIf(tgt, "If-Modified-Since", "Fri, 01 Jan 2100 00:00:00 GMT", NULL).getStatus()
+        );
+        TS_ASSERT_EQUALS(
+            200,
+            fetchIf(tgt, "If-Modified-Since", "Sun, 09 Sep 2001 01:46:40 GMT", NULL).getStatus()
+        );
+        TS_ASSERT_EQUALS(200, fetchIf(tgt, "If-Modified-Since", "yesterday", NULL).getStatus());
+
+        // NOTE: If-None-Match is looked at alone when both are there
+        webserver::Request request = get(tgt);
+        request.addHeader("If-None-Match", "\"x\"");
+        request.addHeader("If-Modified-Since", lastModified);
+        actual = webserver::GetHandler::handleRequest(request, tgt, config, NULL);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+
+        ofstream f(tgt.c_str());
+        f << "body { color: red }";
+        f.close();
+        actual = fetchIf(tgt, "If-None-Match", etag, &cache);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        TS_ASSERT_EQUALS("body { color: red }", actual.getBody());
+        TS_ASSERT_DIFFERS(etag, actual.getHeader("ETag"));
+    }
+
+    void testThatTextIsCompressedForClientsThatAcceptIt() {
+        string text;
+        for (int i = 0; i < 200; i++) {
+            text += "line " + utils::toString(i) + ": the quick brown fox jumps over the dog\n";
+        }
+        _files["/coded/notes.txt"] = text;
+        _files["/coded/short.txt"] = "too short to bother";
+        _files["/coded/photo.jpg"] = text;
+        createTestFiles();
+        webserver::RouteConfig config = rootConfig();
+        config.setCompression(true);
+        webserver::StaticFileCache cache(65536);
+        const string tgt = _rootFolder + "/coded/notes.txt";
+
+        webserver::Response actual = fetchEncoded(tgt, "deflate;q=0.5, gzip", config, &cache);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        TS_ASSERT_EQUALS("gzip", actual.getHeader("Content-Encoding"));
+        TS_ASSERT_EQUALS("Accept-Encoding", actual.getHeader("Vary"));
+        TS_ASSERT_EQUALS("text/plain", actual.getHeader("Content-Type"));
+        // NOTE: compressed while it is sent, the length is not known up front
+        TS_ASSERT_EQUALS("chunked", actual.getHeader("Transfer-Encoding"));
+        TS_ASSERT_EQUALS("", actual.getHeader("Content-Length"));
+        TS_ASSERT_EQUALS("", actual.getHeader("Accept-Ranges"));
+        TS_ASSERT_EQUALS(0, cache.getEntryCount());
+        size_t chunks = 0;
+        const string gzipped = unchunk(drain(actual.getStreamBody()), chunks);
+        TS_ASSERT_LESS_THAN(gzipped.size(), text.size());
+        TS_ASSERT_EQUALS(text, gunzip(gzipped));
+        const string etag = actual.getHeader("ETag");
+        TS_ASSERT_EQUALS("-gzip\"", etag.substr(etag.size() - 6));
+        TS_ASSERT_EQUALS(1, cache.getEntryCount());
+
+        // NOTE: the second time it comes from the cache, next to the plain file, whole
+        actual = fetchEncoded(tgt, "gzip", config, &cache);
+        TS_ASSERT_EQUALS(gzipped, actual.getBody());
+        TS_ASSERT_EQUALS(utils::toString(gzipped.size()), actual.getHeader("Content-Length"));
+        TS_ASSERT_EQUALS("bytes", actual.getHeader("Accept-Ranges"));
+        webserver::Request request = get(tgt);
+        request.addHeader("Accept-Encoding", "gzip");
+        request.addHeader("If-None-Match", etag);
+        actual = webserver::GetHandler::handleRequest(request, tgt, config, &cache);
+        TS_ASSERT_EQUALS(304, actual.getStatus());
+        TS_ASSERT_EQUALS("Accept-Encoding", actual.getHeader("Vary"));
+        actual = fetchEncoded(tgt, "identity", config, &cache);
+        TS_ASSERT_EQUALS(text, actual.getBody());
+        TS_ASSERT_EQUALS("", actual.getHeader("Content-Encoding"));
+        TS_ASSERT_DIFFERS(etag, actual.getHeader("ETag"));
+        TS_ASSERT_EQUALS(2, cache.getEntryCount());
+
+        actual = fetchEncoded(tgt, "deflate", config, NULL);
+        TS_ASSERT_EQUALS("deflate", actual.getHeader("Content-Encoding"));
+        const string deflated = unchunk(drain(actual.getStreamBody()), chunks);
+        TS_ASSERT_EQUALS('\x78', deflated[0]);  // NOTE: zlib header, 32 KiB window
+        TS_ASSERT_EQUALS(text, fetchEncoded(tgt, "gzip;q=0", config, NULL).getBody());
+        TS_ASSERT_EQUALS(
+            "deflate",
+            fetchEncoded(tgt, "gzip;q=0, *;q=0.1", config, NULL).getHeader("Content-Encoding")
+        );
+        TS_ASSERT_EQUALS(
+            "gzip",
+            fetchEncoded(tgt, "*", config, NULL).getHeader("Content-Encoding")
+        );
+        TS_ASSERT_EQUALS(text, fetchEncoded(tgt, "br", config, NULL).getBody());
+
+        const string small = _rootFolder + "/coded/short.txt";
+        const string photo = _rootFolder + "/coded/photo.jpg";
+        TS_ASSERT_EQUALS(
+            "",
+            fetchEncoded(small, "gzip", config, NULL).getHeader("Content-Encoding")
+        );
+        TS_ASSERT_EQUALS(
+            "",
+            fetchEncoded(photo, "gzip", config, NULL).getHeader("Content-Encoding")
+        );
+
+        actual = fetchEncoded(tgt, "gzip", rootConfig(), NULL);
+        TS_ASSERT_EQUALS(text, actual.getBody());
+        TS_ASSERT_EQUALS("", actual.getHeader("Vary"));
+    }
+
+    void testThatCompressionIsStreamedBlockByBlock() {
+        string text;
+        for (int i = 0; i < 8000; i++) {
+            text += utils::toString((i * 7919) % 100003) + " " + utils::toString(i * i) + "\n";
+        }
+        _files["/coded/numbers.txt"] = text;
+        createTestFiles();
+        webserver::RouteConfig config = rootConfig();
+        config.setCompression(true);
+        const string tgt = _rootFolder + "/coded/numbers.txt";
+
+        webserver::Response actual = fetchEncoded(tgt, "gzip", config, NULL);
+        TS_ASSERT_EQUALS("gzip", actual.getHeader("Content-Encoding"));
+        size_t chunks = 0;
+        const string gzipped = unchunk(drain(actual.getStreamBody()), chunks);
+        TS_ASSERT_LESS_THAN(1, chunks);
+        TS_ASSERT_EQUALS(text, gunzip(gzipped));
+
+        // NOTE: Range needs a length, the streamed body is sent whole
+        webserver::Request request = get(tgt);
+        request.addHeader("Accept-Encoding", "gzip");
+        request.addHeader("Range", "bytes=0-9");
+        actual = webserver::GetHandler::handleRequest(request, tgt, config, NULL);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        TS_ASSERT_EQUALS(text, gunzip(unchunk(drain(actual.getStreamBody()), chunks)));
+    }
+
+    void testThatPrecompressedSidecarsAreServed() {
+        _files["/coded/app.js"] = "var answer = 42;";
+        _files["/coded/app.js.gz"] = "pretend gzip";
+        _files["/coded/app.js.br"] = "pretend brotli";
+        createTestFiles();
+        webserver::RouteConfig config = rootConfig();
+        config.setCompression(true);
+        const string tgt = _rootFolder + "/coded/app.js";
+
+        webserver::Response actual = fetchEncoded(tgt, "gzip, deflate, br", config, NULL);
+        TS_ASSERT_EQUALS("br", actual.getHeader("Content-Encoding"));
+        TS_ASSERT_EQUALS("pretend brotli", actual.getBody());
+        TS_ASSERT_EQUALS("application/javascript", actual.getHeader("Content-Type"));
+        actual = fetchEncoded(tgt, "gzip", config, NULL);
+        TS_ASSERT_EQUALS("gzip", actual.getHeader("Content-Encoding"));
+        TS_ASSERT_EQUALS("pretend gzip", actual.getBody());
+        TS_ASSERT_EQUALS("Accept-Encoding", actual.getHeader("Vary"));
+        actual = fetchEncoded(tgt, "br;q=0.5, gzip", config, NULL);
+        TS_ASSERT_EQUALS("pretend gzip", actual.getBody());
+
+        // NOTE: a sidecar older than the file is not what the file is now
+        struct utimbuf times;
+        times.actime = std::time(NULL) - 60;
+        times.modtime = times.actime;
+        utime((tgt + ".gz").c_str(), &times);
+        utime((tgt + ".br").c_str(), &times);
+        actual = fetchEncoded(tgt, "gzip, br", config, NULL);
+        TS_ASSERT_EQUALS("", actual.getHeader("Content-Encoding"));
+        TS_ASSERT_EQUALS("var answer = 42;", actual.getBody());
+    }
+
+    void testThatDirectoryListingsAreStreamedInChunks() {
+        for (int i = 0; i < 300; i++) {
+            _files["/listed/f" + utils::toString(1000 + i)] = "";
+        }
+        createTestFiles();
+        webserver::RouteConfig config = rootConfig();
+        config.setFolderConfig(webserver::FolderConfig(
+            "/",
+            _rootFolder,
+            true,
+            "",
+            webserver::FolderConfig::defaultMaxClientBodySizeBytes()
+        ));
+        const string tgt = _rootFolder + "/listed";
+
+        webserver::Response actual =
+            webserver::GetHandler::handleRequest(get("/listed"), tgt, config, NULL);
+        TS_ASSERT_EQUALS(200, actual.getStatus());
+        TS_ASSERT_EQUALS("chunked", actual.getHeader("Transfer-Encoding"));
+        TS_ASSERT_EQUALS("", actual.getHeader("Content-Length"));
+        TS_ASSERT_EQUALS("text/html", actual.getHeader("Content-Type"));
+        TS_ASSERT(actual.getStreamBody().isSet());
+
+        size_t chunks = 0;
+        const string page = unchunk(drain(actual.getStreamBody()), chunks);
+        TS_ASSERT_EQUALS(2, chunks);
+        TS_ASSERT_EQUALS(0, page.find("<html><head><title>/listed</title></head><body>"));
+        TS_ASSERT(page.find("\n<li><a href=\"/listed/..\">..</a></li>") != string::npos);
+        TS_ASSERT(
+            page.find("<a href=\"/listed/f1000\">f1000</a>") <
+            page.find("<a href=\"/listed/f1299\">f1299</a>")
+        );
+        TS_ASSERT_EQUALS("\n</ul></body></html>", page.substr(page.size() - 20));
+    }
+
+    void testThatStreamBodiesFrameWhatIsWrittenToThem() {
+        webserver::StreamBody chunked(NULL);
+        chunked.setChunked(true);
+        TS_ASSERT(chunked.isStarved());
+        chunked.write("hello", 5);
+        chunked.write("", 0);
+        chunked.write(string(26, 'z').data(), 26);
+        TS_ASSERT(!chunked.isSent());
+        TS_ASSERT(!chunked.isStarved());
+        TS_ASSERT_EQUALS(5 + 26, chunked.getBodyBytes());
+        webserver::StreamBody copy = chunked;
+        copy.close();
+        TS_ASSERT_EQUALS("5\r\nhello\r\n1a\r\n" + string(26, 'z') + "\r\n0\r\n\r\n", drain(copy));
+        // NOTE: the copy is closed, this one still waits for more
+        TS_ASSERT_EQUALS("5\r\nhello\r\n1a\r\n" + string(26, 'z') + "\r\n", drain(chunked));
+
+        webserver::StreamBody plain(NULL);
+        plain.write("as is", 5);
+        plain.abandon();
+        TS_ASSERT(!plain.isStarved());
+        TS_ASSERT_EQUALS("as is", drain(plain));
+        TS_ASSERT(webserver::StreamBody().isSent());
+    }
+
+    void testThatHttpDatesAreParsed() {
+        std::time_t when = 0;
+        TS_ASSERT(utils::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", when));
+        TS_ASSERT_EQUALS(784111777, when);
+        TS_ASSERT_EQUALS("Sun, 06 Nov 1994 08:49:37 GMT", utils::toHttpDate(when));
+        TS_ASSERT(utils::parseHttpDate("Thu, 29 Feb 2024 23:59:59 GMT", when));
+        TS_ASSERT_EQUALS("Thu, 29 Feb 2024 23:59:59 GMT", utils::toHttpDate(when));
+        TS_ASSERT(!utils::parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", when));
+        TS_ASSERT(!utils::parseHttpDate("Sun Nov  6 08:49:37 1994", when));
+        TS_ASSERT(!utils::parseHttpDate("Sun, 06 Now 1994 08:49:37 GMT", when));
+    }
+
+    void testThatCachedFilesAreServedUntilTheyChange() {
+        _files["/cached/page.html"] = "first";
+        createTestFiles();
+        webserver::RouteConfig config = webserver::RouteConfig().setPath("/").setFolderConfig(
+            webserver::FolderConfig(
+                "/",
+                _rootFolder,
+                false,
+                "page.html",
+                webserver::FolderConfig::defaultMaxClientBodySizeBytes()
+            )
+        );
+        webserver::StaticFileCache cache(1024);
+
+        string tgt = _rootFolder + "/cached/page.html";
+        webserver::Response actual =
+            webserver::GetHandler::handleRequest(get(tgt), tgt, config, &cache);
+        TS_ASSERT_EQUALS("first", actual.getBody());
+        TS_ASSERT_EQUALS(1, cache.getEntryCount());
+        actual = webserver::GetHandler::handleRequest(get(tgt), tgt, config, &cache);
+        TS_ASSERT_EQUALS("first", actual.getBody());
+        TS_ASSERT_EQUALS("text/html", actual.getHeader("Content-Type"));
+
+        string folder = _rootFolder + "/cached";
+        actual = webserver::GetHandler::handleRequest(get(folder), folder, config, &cache);
+        TS_ASSERT_EQUALS("first", actual.getBody());
+        TS_ASSERT_EQUALS(1, cache.getEntryCount());
+
+        ofstream f(tgt.c_str());
+        f << "second version";
+        f.close();
+        actual = webserver::GetHandler::handleRequest(get(tgt), tgt, config, &cache);
+        TS_ASSERT_EQUALS("second version", actual.getBody());
+        TS_ASSERT_EQUALS("14", actual.getHeader("Content-Length"));
+
+        unlink(tgt.c_str());
+        actual = webserver::GetHandler::handleRequest(get(tgt), tgt, config, &cache);
+        TS_ASSERT_EQUALS(404, actual.getStatus());
+        TS_ASSERT_EQUALS(0, cache.getEntryCount());
+    }
+
+    void testThatTheCacheEvictsLeastRecentlyUsedFiles() {
+        _files["/lru/a.txt"] = string(40, 'a');
+        _files["/lru/b.txt"] = string(40, 'b');
+        _files["/lru/c.txt"] = string(40, 'c');
+        createTestFiles();
+        webserver::RouteConfig config = webserver::RouteConfig().setPath("/").setFolderConfig(
+            webserver::FolderConfig(
+                "/",
+                _rootFolder,
+                false,
+                "",
+                webserver::FolderConfig::defaultMaxClientBodySizeBytes()
+            )
+        );
+        const string pathA = _rootFolder + "/lru/a.txt";
+        const string pathB = _rootFolder + "/lru/b.txt";
+        const string pathC = _rootFolder + "/lru/c.txt";
+        // NOTE: room for two entries, a path and a body each
+        webserver::StaticFileCache cache(2 * (pathA.size() + 40));
+
+        webserver::GetHandler::handleRequest(get(pathA), pathA, config, &cache);
+        webserver::GetHandler::handleRequest(get(pathB), pathB, config, &cache);
+        webserver::GetHandler::handleRequest(get(pathA), pathA, config, &cache);
+        webserver::GetHandler::handleRequest(get(pathC), pathC, config, &cache);
+        TS_ASSERT_EQUALS(2, cache.getEntryCount());
+        TS_ASSERT_EQUALS(2 * (pathA.size() + 40), cache.getSizeBytes());
+
+        webserver::Response hit;
+        TS_ASSERT(cache.lookup(pathA, hit));
+        TS_ASSERT_EQUALS(string(40, 'a'), hit.getBody());
+        TS_ASSERT(!cache.lookup(pathB, hit));
+        TS_ASSERT(cache.lookup(pathC, hit));
+    }
+
+    void testThatRenderedStatusPagesAreServedUntilReloaded() {
+        _files["/pages/not_found.html"] = "first";
+        createTestFiles();
+        const string page = _rootFolder + "/pages/not_found.html";
+        webserver::HttpStatus status;
+        status.setPage(404, page);
+        status.renderPages();
+
+        ofstream f(page.c_str());
+        f << "second";
+        f.close();
+        webserver::Response actual = status.serveStatusPage(404);
+        TS_ASSERT_EQUALS(404, actual.getStatus());
+        TS_ASSERT_EQUALS("first", actual.getBody());
+        TS_ASSERT_EQUALS("5", actual.getHeader("Content-Length"));
+
+        webserver::HttpStatus::reloadRenderedPages();
+        actual = status.serveStatusPage(404);
+        TS_ASSERT_EQUALS("second", actual.getBody());
+        TS_ASSERT_EQUALS("Not Found", status.getReasonPhrase(404));
+    }
+
     // deletes test files
     void tearDown() {
         string cmd = "rm -rf '" + _rootFolder + "'";
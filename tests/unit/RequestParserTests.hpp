@@ -11,15 +11,28 @@
 
 #include "WebServer.hpp"
 #include "http_status/BadRequest.hpp"
+#include "http_status/HttpException.hpp"
+#include "http_status/HttpStatus.hpp"
 #include "http_status/IncompleteRequest.hpp"
 #include "http_status/PayloadTooLarge.hpp"
 #include "logger/LoggerConfig.hpp"
+#include "request/BodySink.hpp"
+#include "request/ChunkedDecoder.hpp"
+#include "request/RequestArena.hpp"
+#include "request/RequestParser.hpp"
+#include "utils/StringView.hpp"
 
 using std::cout;
 using std::endl;
 using std::ostringstream;
 using std::string;
+using webserver::ChunkedDecoder;
+using webserver::FileSink;
 using webserver::Request;
+using webserver::RequestArena;
+using webserver::RequestParser;
+using webserver::StringSink;
+using webserver::StringView;
 
 class RequestParserTests : public CxxTest::TestSuite {
 public:
@@ -220,5 +233,373 @@ public:
             "*/*\r\n\r\n";
         TS_ASSERT_THROWS(Request actual(raw), webserver::BadRequest);
     }
+
+    void testStreamingByteByByte() {
+        const string raw =
+            "POST /post?x=1 HTTP/1.1\r\nHost: 127.10.0.1:8888\r\n"
+            "Transfer-Encoding: chunked\r\n\r\n5;ext=1\r\nHello\r\n7\r\n World!\r\n0\r\n"
+            "Trailer: ignored\r\n\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        RequestParser::State state = RequestParser::REQUEST_LINE;
+        for (size_t i = 0; i < raw.size(); i++) {
+            TS_ASSERT_DIFFERS(state, RequestParser::COMPLETE);
+            parser.feed(raw.data() + i, 1);
+            state = parser.parse();
+            if (state == RequestParser::HEADERS_COMPLETE) {
+                state = parser.parse();
+            }
+        }
+        TS_ASSERT_EQUALS(state, RequestParser::COMPLETE);
+        TS_ASSERT(!parser.hasBufferedData());
+        TS_ASSERT_EQUALS(actual.getPath(), "/post");
+        TS_ASSERT_EQUALS(actual.getQuery(), "x=1");
+        TS_ASSERT_EQUALS(actual.getHeader("Transfer-Encoding"), "chunked");
+        TS_ASSERT_EQUALS(actual.getBody(), "Hello World!");
+    }
+
+    void testStreamingPausesAfterHeaders() {
+        const string raw = "POST /submit HTTP/1.1\r\nContent-Length: 12\r\n\r\nHello World!";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::HEADERS_COMPLETE);
+        TS_ASSERT(actual.isRequestTargetReceived());
+        TS_ASSERT_EQUALS(actual.getHeader("Content-Length"), "12");
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::COMPLETE);
+        TS_ASSERT_EQUALS(actual.getBody(), "Hello World!");
+    }
+
+    void testStreamingBodyArrivesInParts() {
+        const string head = "POST /submit HTTP/1.1\r\nContent-Length: 12\r\n\r\nHello";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(head.data(), head.size());
+        parser.parse();
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::BODY);
+        TS_ASSERT_EQUALS(actual.getBody(), "Hello");
+        parser.feed(" World!", 7);
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::COMPLETE);
+        TS_ASSERT_EQUALS(actual.getBody(), "Hello World!");
+    }
+
+    void testStreamingPipelinedRequests() {
+        const string raw =
+            "GET /first HTTP/1.1\r\nContent-Length: 5\r\n\r\nxxxxx"
+            "\r\nGET /second HTTP/1.1\r\n\r\nGET /thi";
+        Request first;
+        RequestParser parser(first);
+        parser.feed(raw.data(), raw.size());
+        parser.parse();
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::COMPLETE);
+        TS_ASSERT_EQUALS(first.getPath(), "/first");
+        TS_ASSERT_EQUALS(first.getBody(), "");  // NOTE: read, but only POST bodies are kept
+        TS_ASSERT(parser.hasBufferedData());
+
+        first = Request();
+        parser.reset();
+        parser.parse();
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::COMPLETE);
+        TS_ASSERT_EQUALS(first.getPath(), "/second");
+
+        first = Request();
+        parser.reset();
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::REQUEST_LINE);
+        TS_ASSERT(!first.isRequestTargetReceived());
+    }
+
+    void testFieldsOutliveReceiveBuffer() {
+        const string head = "GET /a/b?x=1 HTTP/1.1\r\nhost: Example.com\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(head.data(), head.size());
+        parser.parse();
+        parser.feed("Connection: close\r\n\r\n", 21);  // NOTE: the parsed lines are compacted away
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::HEADERS_COMPLETE);
+        TS_ASSERT_EQUALS(actual.getPathView(), StringView("/a/b"));
+        TS_ASSERT_EQUALS(actual.getQuery(), "x=1");
+        TS_ASSERT_EQUALS(actual.getHeaderView("Host"), StringView("Example.com"));
+        TS_ASSERT_EQUALS(actual.getHeader("CONNECTION"), "close");
+
+        const Request copy(actual);
+        actual.reset();
+        TS_ASSERT(!actual.isRequestTargetReceived());
+        TS_ASSERT(actual.getHeaderView("Host").empty());
+        TS_ASSERT_EQUALS(copy.getRequestTarget(), "/a/b?x=1");
+        TS_ASSERT_EQUALS(copy.getHeader("host"), "Example.com");
+    }
+
+    void testArenaSpillsAndResets() {
+        RequestArena arena;
+        const StringView small = arena.copy("GET / HTTP/1.1");
+        TS_ASSERT_EQUALS(small, StringView("GET / HTTP/1.1"));
+        TS_ASSERT_EQUALS(reinterpret_cast<size_t>(arena.allocate(3)) % sizeof(void*), 0u);
+        TS_ASSERT_EQUALS(reinterpret_cast<size_t>(arena.allocate(8)) % sizeof(void*), 0u);
+        TS_ASSERT_EQUALS(arena.getHeapBlockCount(), 0u);
+
+        const string cookie(RequestArena::INLINE_BYTES, 'c');
+        TS_ASSERT_EQUALS(arena.copy(cookie).str(), cookie);
+        TS_ASSERT_EQUALS(arena.getHeapBlockCount(), 1u);
+        TS_ASSERT_EQUALS(small, StringView("GET / HTTP/1.1"));  // NOTE: nothing moves
+        arena.reset();
+        TS_ASSERT_EQUALS(arena.getHeapBlockCount(), 0u);
+    }
+
+    void testManyHeaders() {
+        ostringstream raw;
+        raw << "GET / HTTP/1.1\r\n";
+        for (int i = 0; i < 100; i++) {
+            raw << "X-Header-" << i << ": " << string(100, 'v') << i << "\r\n";
+        }
+        raw << "\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.str().data(), raw.str().size());
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::HEADERS_COMPLETE);
+        TS_ASSERT_EQUALS(actual.getHeader("X-Header-0"), string(100, 'v') + "0");
+        TS_ASSERT_EQUALS(actual.getHeader("x-header-99"), string(100, 'v') + "99");
+    }
+
+    void testStreamingBodyTooLargeBeforeItArrives() {
+        const string raw = "POST /post HTTP/1.1\r\nContent-Length: 5\r\n\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        parser.parse();
+        actual.setMaxClientBodySizeBytes(4);
+        TS_ASSERT_THROWS(parser.parse(), webserver::PayloadTooLarge);
+    }
+
+    void testStreamingChunkedBodyTooLarge() {
+        const string raw =
+            "POST /post HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n3\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        parser.parse();
+        actual.setMaxClientBodySizeBytes(5);
+        TS_ASSERT_THROWS(parser.parse(), webserver::PayloadTooLarge);
+    }
+
+    void testStreamingChunkedBodyGoesToSink() {
+        const string head = "POST /post HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nHel";
+        const string tail = "lo\r\n7\r\n World!\r\n0\r\n\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        string received;
+        StringSink sink(received);
+        parser.feed(head.data(), head.size());
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::HEADERS_COMPLETE);
+        parser.setBodySink(&sink);
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::CHUNKED_BODY);
+        TS_ASSERT_EQUALS(received, "Hel");
+        TS_ASSERT(!parser.hasBufferedData());  // NOTE: nothing of the body waits in the parser
+        parser.feed(tail.data(), tail.size());
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::COMPLETE);
+        TS_ASSERT_EQUALS(received, "Hello World!");
+        TS_ASSERT_EQUALS(actual.getBody(), "");
+    }
+
+    void testChunkedDecoderChecksLimitBeforeChunkData() {
+        const string first = "3\r\nabc\r\n";
+        string received;
+        StringSink sink(received);
+        ChunkedDecoder decoder(5);
+        TS_ASSERT_EQUALS(decoder.decode(first.data(), first.size(), &sink), first.size());
+        TS_ASSERT_EQUALS(decoder.getBodyBytes(), 3);
+        TS_ASSERT_THROWS(decoder.decode("3\r\n", 3, &sink), webserver::PayloadTooLarge);
+        TS_ASSERT_EQUALS(received, "abc");
+    }
+
+    void testChunkedDecoderStopsAtEndOfBody() {
+        const string raw = "4;name=value\r\nabcd\r\n0\r\nX-Trailer: 1\r\n\r\nGET / HTTP/1.1";
+        string received;
+        StringSink sink(received);
+        ChunkedDecoder decoder(Request::defaultMaxClientBodySizeBytes());
+        TS_ASSERT_EQUALS(decoder.decode(raw.data(), raw.size(), &sink), raw.find("GET"));
+        TS_ASSERT(decoder.isComplete());
+        TS_ASSERT_EQUALS(received, "abcd");
+    }
+
+    static string firstLine(const string& path) {
+        std::ifstream file(path.c_str());
+        string content;
+        std::getline(file, content);
+        return (content);
+    }
+
+    void testFileSinkKeepsOnlyFinishedUploads() {
+        const string path = "/tmp/webserv_file_sink_test";
+        {
+            FileSink unfinished(path);
+            TS_ASSERT(unfinished.isOpen());
+            unfinished.write("partial", 7);
+            TS_ASSERT(!std::ifstream(path.c_str()).is_open());
+        }
+        TS_ASSERT(!std::ifstream(path.c_str()).is_open());
+        {
+            FileSink finished(path);
+            finished.write("whole", 5);
+            finished.finish();
+        }
+        TS_ASSERT_EQUALS(firstLine(path), "whole");
+        // NOTE: an existing file is replaced only by a finished upload
+        {
+            FileSink unfinished(path);
+            unfinished.write("partial", 7);
+        }
+        TS_ASSERT_EQUALS(firstLine(path), "whole");
+        {
+            FileSink finished(path);
+            finished.write("again", 5);
+            TS_ASSERT_EQUALS(firstLine(path), "whole");
+            finished.finish();
+        }
+        TS_ASSERT_EQUALS(firstLine(path), "again");
+        std::remove(path.c_str());
+    }
+
+    void testBodyLimitsApplyBeforeTheBodyArrives() {
+        const string raw = "POST /post HTTP/1.1\r\nContent-Length: 100\r\n\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::HEADERS_COMPLETE);
+        actual.setMaxClientBodySizeBytes(10);
+        TS_ASSERT_THROWS(parser.applyBodyLimits(), webserver::PayloadTooLarge);
+    }
+
+    void testStreamingBadChunkEnding() {
+        const string raw =
+            "POST /post HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcdef";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        parser.parse();
+        TS_ASSERT_THROWS(parser.parse(), webserver::BadRequest);
+    }
+
+    void testStreamingContentLengthWithTransferEncoding() {
+        const string raw =
+            "POST /post HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n"
+            "0\r\n\r\nGET /smuggled HTTP/1.1\r\n\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        parser.parse();
+        TS_ASSERT_THROWS(parser.parse(), webserver::BadRequest);
+    }
+
+    void testStreamingRepeatedContentLength() {
+        const string repeated =
+            "POST /post HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 5\r\n\r\n";
+        const string listed = "POST /post HTTP/1.1\r\nContent-Length: 5, 5\r\n\r\n";
+        Request first;
+        RequestParser firstParser(first);
+        firstParser.feed(repeated.data(), repeated.size());
+        firstParser.parse();
+        TS_ASSERT_THROWS(firstParser.parse(), webserver::BadRequest);
+        Request second;
+        RequestParser secondParser(second);
+        secondParser.feed(listed.data(), listed.size());
+        secondParser.parse();
+        TS_ASSERT_THROWS(secondParser.parse(), webserver::BadRequest);
+    }
+
+    void testStreamingTransferCodingIgnoresCase() {
+        const string raw =
+            "POST /post HTTP/1.1\r\nTransfer-Encoding: Chunked\r\n\r\n4\r\nabcd\r\n0\r\n\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        parser.parse();
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::COMPLETE);
+        TS_ASSERT_EQUALS(actual.getBody(), "abcd");
+        TS_ASSERT(!parser.hasBufferedData());
+
+        Request buffered(raw);
+        TS_ASSERT_EQUALS(buffered.getBody(), "abcd");
+    }
+
+    static webserver::HttpStatus::CODE refusal(const string& raw) {
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        try {
+            parser.parse();
+            parser.parse();
+        } catch (const webserver::HttpException& e) {
+            return (e.getCode());
+        }
+        return (webserver::HttpStatus::OK);
+    }
+
+    // NOTE: a body the parser cannot delimit must not be read as the next pipelined request
+    void testStreamingUnknownTransferCodingIsRefused() {
+        const string smuggled = "GET /admin.html HTTP/1.1\r\nHost: x\r\n\r\n";
+        TS_ASSERT_EQUALS(
+            refusal("GET /index.html HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n" + smuggled),
+            webserver::HttpStatus::BAD_REQUEST
+        );
+        TS_ASSERT_EQUALS(
+            refusal(
+                "GET / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: gzip\r\n\r\n" +
+                smuggled
+            ),
+            webserver::HttpStatus::BAD_REQUEST
+        );
+        TS_ASSERT_EQUALS(
+            refusal("GET / HTTP/1.1\r\nTransfer-Encoding: chunked, chunked\r\n\r\n0\r\n\r\n"),
+            webserver::HttpStatus::BAD_REQUEST
+        );
+        TS_ASSERT_EQUALS(
+            refusal("GET / HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n0\r\n\r\n"),
+            webserver::HttpStatus::NOT_IMPLEMENTED
+        );
+        Request buffered("POST /post HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\nabcd");
+        TS_ASSERT_THROWS(buffered.getBody(), webserver::BadRequest);
+    }
+
+    // NOTE: a chunked GET body is framed and dropped, what follows it is the next request
+    void testStreamingChunkedBodyOfGetIsSkipped() {
+        const string raw =
+            "GET / HTTP/1.1\r\nTransfer-Encoding: CHUNKED\r\n\r\n4\r\nabcd\r\n0\r\n\r\nGET /next";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        parser.parse();
+        TS_ASSERT_EQUALS(parser.parse(), RequestParser::COMPLETE);
+        TS_ASSERT(parser.hasBufferedData());
+    }
+
+    void testStreamingInvalidContentLength() {
+        const string raw = "POST /post HTTP/1.1\r\nContent-Length: -1\r\n\r\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        parser.parse();
+        TS_ASSERT_THROWS(parser.parse(), webserver::BadRequest);
+    }
+
+    void testStreamingBadLineEndings() {
+        const string raw = "GET / HTTP/1.1\nHost: 127.10.0.1:8888\n\n";
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        TS_ASSERT_THROWS(parser.parse(), webserver::BadRequest);
+    }
+
+    void testStreamingLineTooLong() {
+        const string raw = "GET /" + string(RequestParser::MAX_LINE_BYTES, 'a');
+        Request actual;
+        RequestParser parser(actual);
+        parser.feed(raw.data(), raw.size());
+        try {
+            parser.parse();
+            TS_FAIL("no exception thrown");
+        } catch (const webserver::HttpException& e) {
+            TS_ASSERT_EQUALS(e.getCode(), webserver::HttpStatus::URI_TOO_LONG);
+        }
+    }
 };
 #endif
@@ -113,6 +113,25 @@ public:
         badConfigs.push_back(
             BAD_CONFIGS_DIR + "/71_client_body_size_multiple_definitions_same_scope.conf"
         );
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/78_unknown_event_backend.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/79_event_backend_inside_server.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/80_keepalive_requests_zero.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/81_worker_processes_zero.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/82_duplicate_worker_processes.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/83_file_cache_size_negative.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/84_fastcgi_tcp_address.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/85_cgi_pool_min_above_max.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/86_cgi_pool_size_invalid.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/87_duplicate_default_server.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/88_invalid_server_name_wildcard.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/89_duplicate_unnamed_server.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/90_accept_batch_zero.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/91_duplicate_accept_batch.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/92_compression_invalid_value.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/93_duplicate_compression.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/94_duplicate_keepalive_timeout.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/95_duplicate_keepalive_requests.conf");
+        badConfigs.push_back(BAD_CONFIGS_DIR + "/96_duplicate_file_cache_size.conf");
 
         webserver::ConfigParser parser;
 